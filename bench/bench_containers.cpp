@@ -0,0 +1,201 @@
+# include <bench/benchmark.hpp>
+# include <core/bitset.hpp>
+# include <core/hash_map.hpp>
+# include <algorithm>
+# include <cstdint>
+# include <cstdlib>
+# include <random>
+# include <string>
+# include <unordered_map>
+# include <vector>
+
+namespace
+{
+    // instruction addresses of a script: increasing, 2 to 40 bytes apart
+    auto generate_addresses(std::size_t count) -> std::vector<std::uint32_t>
+    {
+        std::vector<std::uint32_t> addresses(count);
+        std::mt19937 random(1);
+        std::uint32_t address = 0;
+        for (auto & value : addresses)
+        {
+            value = address;
+            address += 2 + random() % 39;
+        }
+        return addresses;
+    }
+
+    // per key: insert, find of every key, find with half of them missing, erase of every other key
+    template <typename map>
+    void bench_map(idascm::benchmark_runner & runner, char const * name, std::vector<std::uint32_t> const & keys, std::vector<std::uint32_t> const & lookups)
+    {
+        auto const prefix = std::string(name) + '/';
+        runner.run((prefix + "insert").c_str(), keys.size(), [&keys]
+        {
+            map m;
+            for (std::size_t i = 0; i < keys.size(); ++ i)
+                m[keys[i]] = static_cast<std::uint32_t>(i);
+            idascm::benchmark_keep(m.size());
+        });
+        map m;
+        for (std::size_t i = 0; i < keys.size(); ++ i)
+            m[keys[i]] = static_cast<std::uint32_t>(i);
+        runner.run((prefix + "find_hit").c_str(), keys.size(), [&m, &keys]
+        {
+            std::size_t sum = 0;
+            for (auto const k : keys)
+                sum += m.find(k) != m.end();
+            idascm::benchmark_keep(sum);
+        });
+        runner.run((prefix + "find_mixed").c_str(), lookups.size(), [&m, &lookups]
+        {
+            std::size_t sum = 0;
+            for (auto const k : lookups)
+                sum += m.find(k) != m.end();
+            idascm::benchmark_keep(sum);
+        });
+        runner.run((prefix + "insert_erase").c_str(), keys.size(), [&keys]
+        {
+            map m;
+            for (std::size_t i = 0; i < keys.size(); ++ i)
+                m[keys[i]] = static_cast<std::uint32_t>(i);
+            for (std::size_t i = 0; i < keys.size(); i += 2)
+                m.erase(keys[i]);
+            idascm::benchmark_keep(m.size());
+        });
+    }
+
+    // std::unordered_map shaped front end, so both maps share bench_map
+    class flat_map
+    {
+        public:
+            auto operator [] (std::uint32_t k) -> std::uint32_t &
+            {
+                return m_map[k];
+            }
+
+            auto find(std::uint32_t k) const noexcept -> std::uint32_t const *
+            {
+                return m_map.find(k);
+            }
+
+            auto end(void) const noexcept -> std::uint32_t const *
+            {
+                return nullptr;
+            }
+
+            auto erase(std::uint32_t k) -> bool
+            {
+                return m_map.erase(k);
+            }
+
+            auto size(void) const noexcept -> std::size_t
+            {
+                return m_map.size();
+            }
+
+        private:
+            idascm::flat_hash_map<std::uint32_t, std::uint32_t> m_map;
+    };
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    benchmark_options options;
+    if (! benchmark_runner::parse_options(argc, argv, options))
+        return EXIT_FAILURE;
+    benchmark_runner runner(options);
+
+    std::size_t const count = 1000000;
+
+    // address to instruction index over a million instruction script, half of the lookups miss
+    auto const keys = generate_addresses(count);
+    std::vector<std::uint32_t> lookups(keys);
+    std::mt19937 random(2);
+    for (auto & k : lookups)
+        k += random() % 2;
+    std::shuffle(lookups.begin(), lookups.end(), random);
+
+    bench_map<std::unordered_map<std::uint32_t, std::uint32_t>>(runner, "unordered_map", keys, lookups);
+    bench_map<flat_map>(runner, "flat_hash_map", keys, lookups);
+
+    // address bitmap over the same script (code starts, xref targets), per bit or probe
+    std::size_t const size = keys.back() + 1;
+    std::vector<bool> bools(size);
+    dynamic_bitset bits(size);
+    for (auto const k : keys)
+    {
+        bools[k] = true;
+        bits.set(k);
+    }
+    std::vector<std::uint32_t> probes(count);
+    for (auto & probe : probes)
+        probe = static_cast<std::uint32_t>(random() % size);
+
+    runner.run("vector_bool/count", size, [&bools]
+    {
+        benchmark_keep(static_cast<std::uint64_t>(std::count(bools.begin(), bools.end(), true)));
+    });
+    runner.run("dynamic_bitset/count", size, [&bits]
+    {
+        benchmark_keep(bits.count());
+    });
+    runner.run("vector_bool/iterate", size, [&bools]
+    {
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < bools.size(); ++ i)
+            if (bools[i])
+                sum += i;
+        benchmark_keep(sum);
+    });
+    runner.run("dynamic_bitset/iterate", size, [&bits]
+    {
+        std::size_t sum = 0;
+        bits.for_each([&sum](std::size_t i) { sum += i; });
+        benchmark_keep(sum);
+    });
+    // prefix scans are slow, a few probes of them
+    std::size_t const scans = 100;
+    runner.run("vector_bool/rank_scan", scans, [&bools, &probes]
+    {
+        // vector<bool> has no rank, prefix counts stand in for it
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < scans; ++ i)
+            sum += std::count(bools.begin(), bools.begin() + probes[i], true);
+        benchmark_keep(sum);
+    });
+    runner.run("dynamic_bitset/rank_scan", scans, [&bits, &probes]
+    {
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < scans; ++ i)
+            sum += bits.rank(probes[i]);
+        benchmark_keep(sum);
+    });
+    bitset_rank_index index;
+    index.build(bits);
+    runner.run("bitset_rank_index/rank", probes.size(), [&index, &probes]
+    {
+        std::size_t sum = 0;
+        for (auto const probe : probes)
+            sum += index.rank(probe);
+        benchmark_keep(sum);
+    });
+    runner.run("vector_bool/test", probes.size(), [&bools, &probes]
+    {
+        std::size_t sum = 0;
+        for (auto const probe : probes)
+            sum += bools[probe];
+        benchmark_keep(sum);
+    });
+    runner.run("dynamic_bitset/test", probes.size(), [&bits, &probes]
+    {
+        std::size_t sum = 0;
+        for (auto const probe : probes)
+            sum += bits.test(probe);
+        benchmark_keep(sum);
+    });
+
+    return runner.finish();
+}
@@ -0,0 +1,339 @@
+# include <bench/benchmark.hpp>
+# include <engine/command.hpp>
+# include <engine/command_manager.hpp>
+# include <engine/command_set.hpp>
+# include <engine/gta3/decoder_gta3.hpp>
+# include <engine/gtalcs/decoder_gtalcs.hpp>
+# include <engine/gtavc/decoder_gtavc.hpp>
+# include <engine/instruction.hpp>
+# include <engine/renderer.hpp>
+# include <engine/script_generator.hpp>
+# include <core/json.hpp>
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <filesystem>
+# include <memory>
+# include <random>
+# include <string>
+# include <vector>
+
+namespace idascm
+{
+    namespace
+    {
+        // ISA document shaped like the shipped ones
+        auto generate_isa(char const * version, std::size_t command_count) -> std::string
+        {
+            static char const * const s_args[] =
+            {
+                "[ ]",
+                "[ \"any\" ]",
+                "[ \"integer\", \"real\" ]",
+                "[ \"any\", \"any\", \"any\" ]",
+                "[ \"address\", \"...\" ]",
+                "[ \"real\", \"real\", \"real\", \"global\", \"local\" ]",
+            };
+            std::string json;
+            json.reserve(command_count * 160);
+            json += "{\n    \"version\": \"";
+            json += version;
+            json += "\",\n    \"commands\": {\n";
+            char buffer[512];
+            for (std::size_t i = 0; i < command_count; ++ i)
+            {
+                std::snprintf(buffer, sizeof(buffer),
+                    "        \"0x%04zx\": {\n"
+                    "            \"name\": \"COMMAND_%04zX\",\n"
+                    "            \"args\": %s,\n"
+                    "            \"flags\": [ %s ],\n"
+                    "            \"comment\": \"generated command %zu\",\n"
+                    "        },\n",
+                    i, i, s_args[i % std::size(s_args)], (i % 7) ? "" : "\"condition\"", i);
+                json += buffer;
+            }
+            json += "    },\n}\n";
+            return json;
+        }
+
+        // commands 0x0000 - 0x00ff with 'opcode % 4' arguments, 0x004f is START_NEW_SCRIPT
+        void fill_isa(command_set & isa)
+        {
+            for (std::uint16_t opcode = 0; opcode < 0x100; ++ opcode)
+            {
+                command cmd = {};
+                cmd.name = string_table::instance().intern("COMMAND_" + std::to_string(opcode));
+                cmd.argument_count = opcode % 4;
+                for (std::uint8_t i = 0; i < cmd.argument_count; ++ i)
+                    cmd.argument_list[i] = argument_type::any;
+                if (0x004f == opcode)
+                {
+                    cmd.argument_count      = 2;
+                    cmd.argument_list[0]    = argument_type::address;
+                    cmd.argument_list[1]    = argument_type::variadic;
+                    cmd.flags               = command_flag_call;
+                }
+                isa.add_command(opcode, cmd);
+            }
+        }
+
+        class stream
+        {
+            public:
+                void u8(std::uint8_t value)
+                {
+                    bytes.push_back(value);
+                }
+
+                void u16(std::uint16_t value)
+                {
+                    u8(value & 0xff);
+                    u8(value >> 8);
+                }
+
+                void u32(std::uint32_t value)
+                {
+                    u16(value & 0xffff);
+                    u16(value >> 16);
+                }
+
+                void f32(float value)
+                {
+                    std::uint32_t bits;
+                    std::memcpy(&bits, &value, sizeof(bits));
+                    u32(bits);
+                }
+
+            public:
+                std::vector<std::uint8_t>   bytes;
+                std::size_t                 instructions = 0;
+        };
+
+        // VC operand: int32, global, local, int8, int16, float32
+        void write_operand_gtavc(stream & out, std::mt19937 & random)
+        {
+            switch (random() % 6)
+            {
+                case 0: out.u8(1); out.u32(random()); break;
+                case 1: out.u8(2); out.u16(random() % 0x4000 * 4); break;
+                case 2: out.u8(3); out.u16(random() % 32); break;
+                case 3: out.u8(4); out.u8(random() & 0xff); break;
+                case 4: out.u8(5); out.u16(random() & 0xffff); break;
+                case 5: out.u8(6); out.f32((random() % 20000) / 10.f - 1000.f); break;
+            }
+        }
+
+        // LCS packed float operand: float8, float16 or float24
+        void write_operand_packed(stream & out, std::mt19937 & random)
+        {
+            switch (random() % 3)
+            {
+                case 0: out.u8(3); out.u8(random() & 0xff); break;
+                case 1: out.u8(4); out.u16(random() & 0xffff); break;
+                case 2: out.u8(5); out.u8(random() & 0xff); out.u16(random() & 0xffff); break;
+            }
+        }
+
+        enum class stream_kind
+        {
+            gtalcs_packed,
+            variadic,
+        };
+
+        // about 'size' bytes of fixed argument commands with packed floats (or START_NEW_SCRIPT with 16 arguments)
+        auto generate_stream(stream_kind kind, std::size_t size) -> stream
+        {
+            std::mt19937 random(1234);
+            stream out;
+            out.bytes.reserve(size + 256);
+            while (out.bytes.size() < size)
+            {
+                if (stream_kind::variadic == kind)
+                {
+                    out.u16(0x004f);
+                    write_operand_gtavc(out, random);
+                    for (int i = 0; i < 16; ++ i)
+                        write_operand_gtavc(out, random);
+                    out.u8(0);
+                }
+                else
+                {
+                    std::uint16_t opcode = random() % 0x100;
+                    if (0x004f == opcode)
+                        opcode = 0x0003;
+                    out.u16(opcode);
+                    for (int i = 0; i < opcode % 4; ++ i)
+                        write_operand_packed(out, random);
+                }
+                ++ out.instructions;
+            }
+            return out;
+        }
+
+        // about 1 MB of the set's whole command mix in the game's encoding
+        auto generate_stream(command_set const & isa, game game) -> stream
+        {
+            script_generator_options options;
+            options.seed = 1234;
+            options.size = 1 << 20;
+            generated_script script;
+            if (! generate_script(isa, game, options, script))
+                std::abort();
+            stream out;
+            out.bytes        = std::move(script.code);
+            out.instructions = script.instruction_count;
+            return out;
+        }
+
+        void bench_decode(benchmark_runner & runner, char const * name, decoder & dec, command_set const & isa, stream code)
+        {
+            memory_api_buffer memory(code.bytes.data(), code.bytes.size());
+            dec.set_command_set(&isa);
+            dec.set_memory_api(&memory);
+            runner.run(name, code.instructions, [&]
+            {
+                instruction in;
+                std::uint32_t address = 0;
+                std::size_t count = 0;
+                while (address < code.bytes.size())
+                {
+                    auto const size = dec.decode_instruction(address, in);
+                    if (! size)
+                        std::abort();
+                    address += size;
+                    ++ count;
+                }
+                benchmark_keep(count);
+            });
+            // 'memory' goes away with this frame, the decoder outlives it
+            dec.set_memory_api(nullptr);
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    benchmark_options options;
+    if (! benchmark_runner::parse_options(argc, argv, options))
+        return EXIT_FAILURE;
+    benchmark_runner runner(options);
+
+    // ISA loading
+    auto const document = generate_isa("gtavc_pc", 0x1000);
+    runner.run("json/parse_isa", document.size(), [&]
+    {
+        auto const value = json_value::from_string(document.c_str(), document.size());
+        if (! value.is_valid())
+            std::abort();
+    });
+    auto const commands = json_value::from_string(document.c_str(), document.size()).to_object()["commands"].to_object();
+    runner.run("command_set/load", commands.size(), [&]
+    {
+        auto const isa = std::make_unique<command_set>(version::gtavc_pc);
+        if (! isa->load(commands))
+            std::abort();
+    });
+    runner.run("command_set/load_document", document.size(), [&]
+    {
+        auto const isa = std::make_unique<command_set>(version::gtavc_pc);
+        version parent = version::unknown;
+        if (! isa->load_document(document.c_str(), document.size(), parent))
+            std::abort();
+    });
+
+    // every version of the table from its own file, uuid maps rebuilt after each one
+    std::error_code error;
+    auto const root = std::filesystem::temp_directory_path(error) / "idascm-bench";
+    std::filesystem::create_directories(root, error);
+    std::vector<version> versions;
+    for (unsigned value = 1; value < 0x100; ++ value)
+    {
+        auto const ver = to_version(static_cast<std::uint8_t>(value));
+        auto const name = to_string(ver);
+        if (! name)
+            continue;
+        auto const json = generate_isa(name, 0x400);
+        auto const path = root / (std::string(name) + ".json");
+        if (auto const file = std::fopen(path.string().c_str(), "wb"))
+        {
+            std::fwrite(json.data(), 1, json.size(), file);
+            std::fclose(file);
+            versions.push_back(ver);
+        }
+    }
+    runner.run("command_manager/load_all", versions.size(), [&]
+    {
+        auto const manager = std::make_unique<command_manager>(root.string().c_str());
+        for (auto const ver : versions)
+            if (! manager->get_set(ver))
+                std::abort();
+    });
+
+    // lookups through a parent, a third of them misses
+    {
+        auto const parent = std::make_unique<command_set>(version::gtavc_ps2);
+        auto const child  = std::make_unique<command_set>(version::gtavc_pc);
+        fill_isa(*parent);
+        child->set_parent(parent.get());
+        std::vector<std::uint16_t> opcodes(1 << 16);
+        std::mt19937 random(42);
+        for (auto & opcode : opcodes)
+            opcode = random() % 0x180;
+        runner.run("command_set/get_command", opcodes.size(), [&]
+        {
+            std::uint64_t found = 0;
+            for (auto const opcode : opcodes)
+                found += nullptr != child->get_command(opcode);
+            benchmark_keep(found);
+        });
+    }
+
+    // decoding, about 1 MB per stream
+    {
+        command_set isa(version::unknown);
+        fill_isa(isa);
+        decoder_gta3    gta3;
+        decoder_gtavc   gtavc;
+        decoder_gtalcs  gtalcs;
+        bench_decode(runner, "decode/gta3",                 gta3,   isa, generate_stream(isa, game::gta3));
+        bench_decode(runner, "decode/gtavc",                gtavc,  isa, generate_stream(isa, game::gtavc));
+        bench_decode(runner, "decode/gtalcs",               gtalcs, isa, generate_stream(isa, game::gtalcs));
+        bench_decode(runner, "decode/gtavc_variadic",       gtavc,  isa, generate_stream(stream_kind::variadic, 1 << 20));
+        bench_decode(runner, "decode/gtalcs_packed_floats", gtalcs, isa, generate_stream(stream_kind::gtalcs_packed, 1 << 20));
+    }
+
+    // listing text of 1 MB of decoded VC code
+    {
+        command_set isa(version::unknown);
+        fill_isa(isa);
+        auto code = generate_stream(isa, game::gtavc);
+        memory_api_buffer memory(code.bytes.data(), code.bytes.size());
+        decoder_gtavc dec;
+        dec.set_command_set(&isa);
+        dec.set_memory_api(&memory);
+        std::vector<instruction> instructions(code.instructions);
+        std::uint32_t address = 0;
+        for (auto & in : instructions)
+            address += dec.decode_instruction(address, in);
+        std::vector<char> text(256 * instructions.size());
+        render_options options;
+        runner.run("render/gtavc", instructions.size(), [&]
+        {
+            auto first = text.data();
+            auto const last = first + text.size();
+            for (auto const & in : instructions)
+            {
+                first = render_instruction(first, last, in, *isa.get_text(in.opcode), options);
+                if (! first)
+                    std::abort();
+                *first ++ = '\n';
+            }
+            benchmark_keep(first - text.data());
+        });
+    }
+
+    std::filesystem::remove_all(root, error);
+    return runner.finish();
+}
@@ -0,0 +1,206 @@
+# include <bench/benchmark.hpp>
+# include <core/json.hpp>
+# include <core/json_reader.hpp>
+# include <core/json_structural.hpp>
+# include <core/json_writer.hpp>
+# include <cstdio>
+# include <cstdlib>
+# include <iterator>
+# include <string>
+# include <vector>
+
+namespace
+{
+    // counts member names, stands in for a consumer that keeps nothing
+    class key_counter final : public idascm::json_handler
+    {
+        public:
+            auto key(std::string_view) -> bool override
+            {
+                ++ count;
+                return true;
+            }
+
+        public:
+            std::size_t count = 0;
+    };
+
+    // ISA-like document: { "version": ..., "commands": { "0x0000": { ... }, ... } }
+    auto generate_isa(std::size_t command_count) -> std::string
+    {
+        std::string json;
+        json.reserve(command_count * 160);
+        json += "{\n    \"version\": \"gtavc_pc\",\n    \"commands\": {\n";
+        char buffer[512];
+        for (std::size_t i = 0; i < command_count; ++ i)
+        {
+            std::snprintf(buffer, sizeof(buffer),
+                "        \"0x%04zx\": {\n"
+                "            \"name\": \"COMMAND_%zu\",\n"
+                "            \"args\": [ \"integer\", \"real\", \"address\", \"...\" ],\n"
+                "            \"flags\": [ \"jump\", \"condition\" ],\n"
+                "            \"comment\": \"generated \\\"command\\\" %zu\",\n"
+                "        },\n",
+                i & 0xfff, i, i
+            );
+            json += buffer;
+        }
+        json += "    },\n}\n";
+        return json;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    benchmark_options options;
+    if (! benchmark_runner::parse_options(argc, argv, options))
+        return EXIT_FAILURE;
+    benchmark_runner runner(options);
+
+    std::size_t const sizes[] = { 1000, 10000, 100000 };
+
+    // token pool sizing, per byte
+    json_set_tokenizer(json_tokenizer::jsmn);
+    for (auto const count : sizes)
+    {
+        auto const json = generate_isa(count);
+        for (auto const sizing : { json_sizing::exact, json_sizing::doubling })
+        {
+            auto const name = std::string(json_sizing::exact == sizing ? "json/exact/" : "json/doubling/") + std::to_string(count);
+            runner.run(name.c_str(), json.size(), [&json, sizing]
+            {
+                auto const value = json_value::from_string(json.c_str(), json.size(), nullptr, sizing);
+                if (! value.is_valid())
+                    std::abort();
+            });
+        }
+    }
+
+    struct
+    {
+        json_tokenizer  tokenizer;
+        char const *    name;
+    }
+    const tokenizers[] = \
+    {
+        { json_tokenizer::jsmn,                 "json/tokenize/jsmn"    },
+        { json_tokenizer::structural_scalar,    "json/tokenize/scalar"  },
+        { json_tokenizer::structural_sse2,      "json/tokenize/sse2"    },
+        { json_tokenizer::structural_avx2,      "json/tokenize/avx2"    },
+    };
+    // tokenization only, no source copy or string unescaping
+    auto const json = generate_isa(sizes[std::size(sizes) - 1]);
+    std::vector<jsmntok_t> tokens;
+    for (auto const & row : tokenizers)
+    {
+        runner.run(row.name, json.size(), [&json, &tokens, &row]
+        {
+            int count = 0;
+            if (json_tokenizer::jsmn == row.tokenizer)
+            {
+                jsmn_parser parser;
+                jsmn_init(&parser);
+                count = jsmn_parse(&parser, json.c_str(), json.size(), nullptr, 0);
+                tokens.resize(count);
+                jsmn_init(&parser);
+                count = jsmn_parse(&parser, json.c_str(), json.size(), tokens.data(), (unsigned int) tokens.size());
+            }
+            else
+            {
+                json_structural_index index;
+                count = index.build(json.c_str(), json.size(), row.tokenizer);
+                tokens.resize(count);
+                count = index.tokenize(tokens.data(), tokens.size());
+            }
+            if (count <= 0)
+                std::abort();
+        });
+    }
+
+    // tree against events, both visiting every command name
+    // indexed object access walks the token pool, so the tree side is quadratic - keep it small
+    auto const isa = generate_isa(sizes[1]);
+    runner.run("json/visit/tree", isa.size(), [&isa]
+    {
+        auto const commands = json_value::from_string(isa.c_str(), isa.size()).to_object()["commands"].to_object();
+        std::uint64_t names = 0;
+        for (std::size_t i = 0; i < commands.size(); ++ i)
+            names += commands.at(i).to_object()["name"].is_valid();
+        benchmark_keep(names);
+    });
+    runner.run("json/visit/events", isa.size(), [&isa]
+    {
+        json_reader reader;
+        key_counter counter;
+        if (json_read_ok != reader.read(isa.c_str(), isa.size(), counter))
+            std::abort();
+        benchmark_keep(counter.count);
+    });
+
+    // numeric accessors against the old c_str + strtoul path
+    std::string symbols = "[";
+    for (std::size_t i = 0; i < 100000; ++ i)
+        symbols += (i & 1) ? "\"0x" + std::to_string(i * 7919) + "\"," : std::to_string(i * 7919) + ",";
+    symbols += "]";
+    auto const table = json_value::from_string(symbols.c_str(), symbols.size()).to_array();
+    std::vector<json_primitive> entries;
+    for (std::size_t i = 0; i < table.size(); ++ i)
+        entries.push_back(table[i].to_primitive());
+    runner.run("json/numbers/strtoul", entries.size(), [&entries]
+    {
+        std::uint64_t checksum = 0;
+        for (auto const & entry : entries)
+        {
+            auto const string = entry.c_str();
+            checksum += (string[0] == '0' && string[1] == 'x') ? std::strtoull(string, nullptr, 16) : std::strtoull(string, nullptr, 10);
+        }
+        benchmark_keep(checksum);
+    });
+    runner.run("json/numbers/to_uint64", entries.size(), [&entries]
+    {
+        std::uint64_t checksum = 0;
+        for (auto const & entry : entries)
+        {
+            std::uint64_t value = 0;
+            entry.to_uint64(value);
+            checksum += value;
+        }
+        benchmark_keep(checksum);
+    });
+
+    // writer, ISA-like output into memory, per command
+    json_writer writer;
+    runner.run("json/writer", 100000, [&writer]
+    {
+        writer.clear();
+        writer.begin_object();
+        writer.key("commands");
+        writer.begin_object();
+        char opcode[] = "0x0000";
+        for (std::size_t i = 0; i < 100000; ++ i)
+        {
+            for (std::size_t digit = 0; digit < 4; ++ digit)
+                opcode[5 - digit] = "0123456789abcdef"[(i >> (4 * digit)) & 0xf];
+            writer.key(opcode);
+            writer.begin_object();
+            writer.key("name");
+            writer.value_string("GENERATED_COMMAND");
+            writer.key("args");
+            writer.begin_array();
+            writer.value_string("integer");
+            writer.value_double(i * 0.25);
+            writer.value_int64(-static_cast<std::int64_t>(i));
+            writer.end_array();
+            writer.key("comment");
+            writer.value_string("generated \"command\"\n");
+            writer.end_object();
+        }
+        writer.end_object();
+        writer.end_object();
+        benchmark_keep(writer.buffer().size());
+    });
+
+    return runner.finish();
+}
@@ -0,0 +1,191 @@
+# include <bench/benchmark.hpp>
+# include <core/json.hpp>
+# include <core/json_writer.hpp>
+# include <algorithm>
+# include <atomic>
+# include <cstdlib>
+# include <cstring>
+
+namespace idascm
+{
+    namespace
+    {
+        std::atomic<std::uint64_t> g_keep(0);
+
+        // nearest rank, 'samples' sorted
+        auto percentile(std::vector<double> const & samples, unsigned percent) noexcept -> double
+        {
+            auto const rank = (samples.size() * percent + 99) / 100;
+            return samples[rank ? rank - 1 : 0];
+        }
+
+        void usage(char const * program)
+        {
+            std::fprintf(stderr,
+                "usage: %s [options]\n"
+                "  --filter <text>      run benchmarks whose name contains <text>\n"
+                "  --warmup <count>     untimed runs (default 2)\n"
+                "  --iterations <count> timed runs (default 15)\n"
+                "  --json <path>        write results as JSON\n"
+                "  --baseline <path>    compare medians with earlier JSON results\n"
+                "  --threshold <ratio>  allowed slowdown against the baseline (default 0.10)\n",
+                program);
+        }
+    }
+
+    void benchmark_keep(std::uint64_t value) noexcept
+    {
+        g_keep.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // static
+    auto benchmark_runner::parse_options(int argc, char * argv[], benchmark_options & options) -> bool
+    {
+        for (int i = 1; i < argc; ++ i)
+        {
+            auto const option = argv[i];
+            auto const value  = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (! value || 0 == std::strcmp(option, "--help"))
+            {
+                usage(argv[0]);
+                return false;
+            }
+            if (0 == std::strcmp(option, "--filter"))
+                options.filter = value;
+            else if (0 == std::strcmp(option, "--warmup"))
+                options.warmup = std::strtoul(value, nullptr, 10);
+            else if (0 == std::strcmp(option, "--iterations"))
+                options.iterations = std::max<std::size_t>(1, std::strtoul(value, nullptr, 10));
+            else if (0 == std::strcmp(option, "--json"))
+                options.output = value;
+            else if (0 == std::strcmp(option, "--baseline"))
+                options.baseline = value;
+            else if (0 == std::strcmp(option, "--threshold"))
+                options.threshold = std::strtod(value, nullptr);
+            else
+            {
+                usage(argv[0]);
+                return false;
+            }
+            ++ i;
+        }
+        return true;
+    }
+
+    benchmark_runner::benchmark_runner(benchmark_options const & options)
+        : m_options(options)
+    {}
+
+    void benchmark_runner::add(char const * name, std::uint64_t items, std::vector<double> & samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        benchmark_result result;
+        result.name         = name;
+        result.items        = items;
+        result.iterations   = samples.size();
+        result.min          = samples.front();
+        result.median       = percentile(samples, 50);
+        result.p10          = percentile(samples, 10);
+        result.p90          = percentile(samples, 90);
+        result.max          = samples.back();
+        m_results.push_back(result);
+        std::fprintf(stderr, "%-40s %14.0f ns\n", name, result.median);
+    }
+
+    void benchmark_runner::print(std::FILE * stream) const
+    {
+        std::fprintf(stream, "%-40s %14s %14s %14s %12s %12s\n", "benchmark", "median ns", "p10 ns", "p90 ns", "items", "ns/item");
+        for (auto const & result : m_results)
+        {
+            std::fprintf(stream, "%-40s %14.0f %14.0f %14.0f %12llu %12.2f\n", result.name.c_str(), result.median, result.p10, result.p90,
+                static_cast<unsigned long long>(result.items), result.items ? result.median / result.items : result.median);
+        }
+    }
+
+    void benchmark_runner::write_json(std::string & json) const
+    {
+        json_writer writer(2);
+        writer.begin_object();
+        writer.key("benchmarks");
+        writer.begin_array();
+        for (auto const & result : m_results)
+        {
+            writer.begin_object();
+            writer.key("name");         writer.value_string(result.name);
+            writer.key("items");        writer.value_uint64(result.items);
+            writer.key("iterations");   writer.value_uint64(result.iterations);
+            writer.key("min_ns");       writer.value_double(result.min);
+            writer.key("median_ns");    writer.value_double(result.median);
+            writer.key("p10_ns");       writer.value_double(result.p10);
+            writer.key("p90_ns");       writer.value_double(result.p90);
+            writer.key("max_ns");       writer.value_double(result.max);
+            writer.end_object();
+        }
+        writer.end_array();
+        writer.end_object();
+        json.append(writer.buffer().data(), writer.buffer().size());
+    }
+
+    auto benchmark_runner::compare(char const * path, double threshold, std::FILE * stream) const -> int
+    {
+        auto const benchmarks = json_value::from_file(path).to_object()["benchmarks"].to_array();
+        if (! benchmarks.is_valid())
+            return -1;
+        int regressions = 0;
+        std::fprintf(stream, "%-40s %14s %14s %9s\n", "benchmark", "baseline ns", "median ns", "change");
+        for (std::size_t i = 0; i < benchmarks.size(); ++ i)
+        {
+            auto const entry = benchmarks[i].to_object();
+            auto const name = entry["name"].to_primitive().to_string();
+            double baseline = 0;
+            if (! entry["median_ns"].to_primitive().to_double(baseline) || baseline <= 0)
+                continue;
+            auto const result = std::find_if(m_results.begin(), m_results.end(), [&name](benchmark_result const & result)
+            {
+                return result.name == name;
+            });
+            if (result == m_results.end())
+                continue;
+            auto const change = result->median / baseline - 1.0;
+            auto const regressed = change > threshold;
+            regressions += regressed;
+            std::fprintf(stream, "%-40s %14.0f %14.0f %+8.1f%%%s\n", result->name.c_str(), baseline, result->median, change * 100, regressed ? " REGRESSION" : "");
+        }
+        return regressions;
+    }
+
+    auto benchmark_runner::finish(void) const -> int
+    {
+        print(stdout);
+        if (! m_options.output.empty())
+        {
+            std::string json;
+            write_json(json);
+            auto const file = std::fopen(m_options.output.c_str(), "wb");
+            if (! file || json.size() != std::fwrite(json.data(), 1, json.size(), file))
+            {
+                std::fprintf(stderr, "unable to write '%s'\n", m_options.output.c_str());
+                if (file)
+                    std::fclose(file);
+                return EXIT_FAILURE;
+            }
+            std::fclose(file);
+        }
+        if (! m_options.baseline.empty())
+        {
+            std::printf("\n");
+            auto const regressions = compare(m_options.baseline.c_str(), m_options.threshold, stdout);
+            if (regressions < 0)
+            {
+                std::fprintf(stderr, "unable to read baseline '%s'\n", m_options.baseline.c_str());
+                return EXIT_FAILURE;
+            }
+            if (regressions)
+            {
+                std::printf("%d benchmark(s) slower than the baseline by more than %.0f%%\n", regressions, m_options.threshold * 100);
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+}
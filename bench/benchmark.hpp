@@ -0,0 +1,91 @@
+# pragma once
+# include <core/core.hpp>
+# include <chrono>
+# include <cstdint>
+# include <cstdio>
+# include <string>
+# include <vector>
+
+namespace idascm
+{
+    struct benchmark_options
+    {
+        std::size_t     warmup      = 2;        // untimed runs before sampling
+        std::size_t     iterations  = 15;       // timed runs
+        std::string     filter;                 // substring of the benchmark names to run
+        std::string     output;                 // JSON results path
+        std::string     baseline;               // JSON results to compare with
+        double          threshold   = 0.10;     // allowed median slowdown against the baseline
+    };
+
+    // times in ns per run
+    struct benchmark_result
+    {
+        std::string     name;
+        std::uint64_t   items;      // work items per run (bytes, instructions, lookups)
+        std::size_t     iterations;
+        double          min;
+        double          median;
+        double          p10;
+        double          p90;
+        double          max;
+    };
+
+    // keeps a value alive so the work producing it is not optimized away
+    void benchmark_keep(std::uint64_t value) noexcept;
+
+    class benchmark_runner
+    {
+        public:
+            // false (usage printed) on bad arguments or --help
+            static auto parse_options(int argc, char * argv[], benchmark_options & options) -> bool;
+
+        public:
+            // 'fn' is one run, 'items' scales the per item rate
+            template <typename function>
+            void run(char const * name, std::uint64_t items, function && fn)
+            {
+                if (! m_options.filter.empty() && std::string::npos == std::string(name).find(m_options.filter))
+                    return;
+                for (std::size_t i = 0; i < m_options.warmup; ++ i)
+                    fn();
+                std::vector<double> samples;
+                samples.reserve(m_options.iterations);
+                for (std::size_t i = 0; i < m_options.iterations; ++ i)
+                {
+                    auto const start = std::chrono::steady_clock::now();
+                    fn();
+                    auto const stop  = std::chrono::steady_clock::now();
+                    samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+                }
+                add(name, items, samples);
+            }
+
+            auto results(void) const noexcept -> std::vector<benchmark_result> const &
+            {
+                return m_results;
+            }
+
+            // human readable table
+            void print(std::FILE * stream) const;
+            // { "benchmarks": [ { "name", "items", "iterations", "min_ns", "median_ns", ... } ] }
+            void write_json(std::string & json) const;
+
+            // benchmarks whose median grew past the threshold, printed to 'stream'
+            // -1 if the baseline can not be read
+            auto compare(char const * path, double threshold, std::FILE * stream) const -> int;
+
+            // output and baseline handling of the options, the process exit code
+            auto finish(void) const -> int;
+
+        public:
+            explicit benchmark_runner(benchmark_options const & options);
+
+        private:
+            void add(char const * name, std::uint64_t items, std::vector<double> & samples);
+
+        private:
+            benchmark_options               m_options;
+            std::vector<benchmark_result>   m_results;
+    };
+}
@@ -0,0 +1,133 @@
+# include <core/allocation_tracker.hpp>
+# include <algorithm>
+# include <atomic>
+# include <cstdio>
+# include <cstring>
+# include <iterator>
+# include <mutex>
+
+namespace idascm
+{
+    namespace
+    {
+        // trivially constructible, so the hooks never run a thread_local initializer
+        thread_local allocation_counters t_counters = {};
+
+        std::atomic<bool>           g_installed(false);
+        std::atomic<std::uint64_t>  g_allocations(0);
+        std::atomic<std::uint64_t>  g_deallocations(0);
+        std::atomic<std::uint64_t>  g_bytes(0);
+
+        // named scope totals, a fixed table so recording never allocates
+        std::mutex                                  g_scope_mutex;
+        allocation_tracker::scope_statistics        g_scopes[256];
+        std::size_t                                 g_scope_count = 0;
+    }
+
+    // static
+    auto allocation_tracker::is_installed(void) noexcept -> bool
+    {
+        return g_installed.load(std::memory_order_relaxed);
+    }
+
+    // static
+    auto allocation_tracker::thread_counters(void) noexcept -> allocation_counters
+    {
+        return t_counters;
+    }
+
+    // static
+    auto allocation_tracker::process_counters(void) noexcept -> allocation_counters
+    {
+        return
+        {
+            g_allocations.load(std::memory_order_relaxed),
+            g_deallocations.load(std::memory_order_relaxed),
+            g_bytes.load(std::memory_order_relaxed),
+        };
+    }
+
+    // static
+    void allocation_tracker::install(void) noexcept
+    {
+        g_installed.store(true, std::memory_order_relaxed);
+    }
+
+    // static
+    void allocation_tracker::record_allocation(std::size_t size) noexcept
+    {
+        ++ t_counters.allocations;
+        t_counters.bytes += size;
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    // static
+    void allocation_tracker::record_deallocation(void) noexcept
+    {
+        ++ t_counters.deallocations;
+        g_deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // static
+    void allocation_tracker::record_scope(char const * name, allocation_counters const & counters) noexcept
+    {
+        std::lock_guard<std::mutex> lock(g_scope_mutex);
+        auto const last  = g_scopes + g_scope_count;
+        auto       entry = std::find_if(g_scopes, last, [name](scope_statistics const & stats)
+        {
+            return stats.name == name || 0 == std::strcmp(stats.name, name);
+        });
+        if (entry == last)
+        {
+            // names past the table are not reported
+            if (g_scope_count == std::size(g_scopes))
+                return;
+            *entry = { name, 0, {} };
+            ++ g_scope_count;
+        }
+        ++ entry->count;
+        entry->counters.allocations     += counters.allocations;
+        entry->counters.deallocations   += counters.deallocations;
+        entry->counters.bytes           += counters.bytes;
+    }
+
+    // static
+    auto allocation_tracker::summarize(void) -> std::vector<scope_statistics>
+    {
+        std::vector<scope_statistics> result;
+        {
+            std::lock_guard<std::mutex> lock(g_scope_mutex);
+            result.assign(g_scopes, g_scopes + g_scope_count);
+        }
+        std::sort(result.begin(), result.end(), [](scope_statistics const & lhs, scope_statistics const & rhs)
+        {
+            return lhs.counters.bytes > rhs.counters.bytes;
+        });
+        return result;
+    }
+
+    // static
+    void allocation_tracker::write_summary(std::string & text)
+    {
+        char line[512];
+        std::snprintf(line, sizeof(line), "%-32s %10s %12s %12s %14s %12s\n",
+            "scope", "count", "allocations", "frees", "bytes", "bytes/scope");
+        text += line;
+        for (auto const & stats : summarize())
+        {
+            std::snprintf(line, sizeof(line), "%-32s %10llu %12llu %12llu %14llu %12.1f\n",
+                stats.name, static_cast<unsigned long long>(stats.count),
+                static_cast<unsigned long long>(stats.counters.allocations), static_cast<unsigned long long>(stats.counters.deallocations),
+                static_cast<unsigned long long>(stats.counters.bytes), double(stats.counters.bytes) / stats.count);
+            text += line;
+        }
+    }
+
+    // static
+    void allocation_tracker::reset_scopes(void) noexcept
+    {
+        std::lock_guard<std::mutex> lock(g_scope_mutex);
+        g_scope_count = 0;
+    }
+}
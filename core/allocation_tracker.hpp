@@ -0,0 +1,226 @@
+# pragma once
+# include <core/core.hpp>
+# include <cstddef>
+# include <cstdint>
+# include <cstdlib>
+# include <new>
+# include <string>
+# include <vector>
+
+// opt-in global operator new/delete hooks
+// exactly one translation unit of an executable (a test or benchmark, never the IDA module)
+// defines IDASCM_ALLOCATION_HOOKS before including this header, without it nothing is counted
+// and allocation_tracker::is_installed() is false
+
+namespace idascm
+{
+    struct allocation_counters
+    {
+        std::uint64_t   allocations;
+        std::uint64_t   deallocations;
+        std::uint64_t   bytes;          // requested by allocations
+    };
+
+    inline auto operator - (allocation_counters const & lhs, allocation_counters const & rhs) noexcept -> allocation_counters
+    {
+        return { lhs.allocations - rhs.allocations, lhs.deallocations - rhs.deallocations, lhs.bytes - rhs.bytes };
+    }
+
+    class allocation_tracker
+    {
+        public:
+            // allocations of the calling thread while the scope is alive (nested scopes overlap)
+            // a named scope adds its counters to the totals of its name when it ends, see summarize()
+            class scope
+            {
+                public:
+                    auto counters(void) const noexcept -> allocation_counters
+                    {
+                        return thread_counters() - m_start;
+                    }
+
+                    auto name(void) const noexcept -> char const *
+                    {
+                        return m_name;
+                    }
+
+                public:
+                    // 'name' must outlive the tracker (a string literal)
+                    explicit scope(char const * name = nullptr) noexcept
+                        : m_name(name)
+                        , m_start(thread_counters())
+                    {}
+
+                    ~scope(void) noexcept
+                    {
+                        if (m_name)
+                            record_scope(m_name, counters());
+                    }
+
+                private:
+                    scope(scope const &) = delete;
+                    auto operator = (scope const &) -> scope & = delete;
+
+                private:
+                    char const *        m_name;
+                    allocation_counters m_start;
+            };
+
+            // per scope name totals of every thread
+            struct scope_statistics
+            {
+                char const *        name;
+                std::uint64_t       count;      // scopes ended
+                allocation_counters counters;
+            };
+
+        public:
+            // hooks are linked in
+            static auto is_installed(void) noexcept -> bool;
+
+            // named scopes, the most bytes first
+            // a scope nested in one of the same name is counted in both
+            static auto summarize(void) -> std::vector<scope_statistics>;
+            // fixed width table of summarize()
+            static void write_summary(std::string & text);
+            // forgets the named scope totals
+            static void reset_scopes(void) noexcept;
+
+            // totals of the calling thread
+            static auto thread_counters(void) noexcept -> allocation_counters;
+            // totals of every thread
+            static auto process_counters(void) noexcept -> allocation_counters;
+
+            // called by the hooks
+            static void install(void) noexcept;
+            static void record_allocation(std::size_t size) noexcept;
+            static void record_deallocation(void) noexcept;
+
+        private:
+            // takes a lock, never allocates: scopes end inside other scopes
+            static void record_scope(char const * name, allocation_counters const & counters) noexcept;
+    };
+
+    // allocations 'fn' made on the calling thread
+    template <typename function>
+    auto count_allocations(function && fn) -> allocation_counters
+    {
+        allocation_tracker::scope scope;
+        fn();
+        return scope.counters();
+    }
+
+    // true if 'fn' did not touch the heap, false as well when the hooks are not installed
+    // (an untracked region proves nothing)
+    template <typename function>
+    auto is_allocation_free(function && fn) -> bool
+    {
+        return allocation_tracker::is_installed() && 0 == count_allocations(fn).allocations;
+    }
+}
+
+# if defined IDASCM_ALLOCATION_HOOKS
+namespace idascm
+{
+    namespace
+    {
+        struct allocation_hooks_installer
+        {
+            allocation_hooks_installer(void) noexcept
+            {
+                allocation_tracker::install();
+            }
+        } const g_allocation_hooks_installer;
+
+        auto allocation_hooks_allocate(std::size_t size) noexcept -> void *
+        {
+            auto const memory = std::malloc(size ? size : 1);
+            if (memory)
+                allocation_tracker::record_allocation(size);
+            return memory;
+        }
+
+        auto allocation_hooks_allocate(std::size_t size, std::align_val_t alignment) noexcept -> void *
+        {
+            auto const align = static_cast<std::size_t>(alignment);
+#   if defined _MSC_VER
+            auto const memory = _aligned_malloc(size ? size : 1, align);
+#   else
+            auto const memory = std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align);
+#   endif
+            if (memory)
+                allocation_tracker::record_allocation(size);
+            return memory;
+        }
+
+        void allocation_hooks_free(void * memory) noexcept
+        {
+            if (! memory)
+                return;
+            allocation_tracker::record_deallocation();
+            std::free(memory);
+        }
+
+        void allocation_hooks_free(void * memory, std::align_val_t) noexcept
+        {
+            if (! memory)
+                return;
+            allocation_tracker::record_deallocation();
+#   if defined _MSC_VER
+            _aligned_free(memory);
+#   else
+            std::free(memory);
+#   endif
+        }
+    }
+}
+
+auto operator new (std::size_t size) -> void *
+{
+    if (auto const memory = idascm::allocation_hooks_allocate(size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+auto operator new [] (std::size_t size) -> void *
+{
+    if (auto const memory = idascm::allocation_hooks_allocate(size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+auto operator new (std::size_t size, std::nothrow_t const &) noexcept -> void *
+{
+    return idascm::allocation_hooks_allocate(size);
+}
+
+auto operator new [] (std::size_t size, std::nothrow_t const &) noexcept -> void *
+{
+    return idascm::allocation_hooks_allocate(size);
+}
+
+auto operator new (std::size_t size, std::align_val_t alignment) -> void *
+{
+    if (auto const memory = idascm::allocation_hooks_allocate(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+
+auto operator new [] (std::size_t size, std::align_val_t alignment) -> void *
+{
+    if (auto const memory = idascm::allocation_hooks_allocate(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete (void * memory) noexcept                                       { idascm::allocation_hooks_free(memory); }
+void operator delete [] (void * memory) noexcept                                    { idascm::allocation_hooks_free(memory); }
+void operator delete (void * memory, std::size_t) noexcept                          { idascm::allocation_hooks_free(memory); }
+void operator delete [] (void * memory, std::size_t) noexcept                       { idascm::allocation_hooks_free(memory); }
+void operator delete (void * memory, std::nothrow_t const &) noexcept               { idascm::allocation_hooks_free(memory); }
+void operator delete [] (void * memory, std::nothrow_t const &) noexcept            { idascm::allocation_hooks_free(memory); }
+void operator delete (void * memory, std::align_val_t alignment) noexcept                   { idascm::allocation_hooks_free(memory, alignment); }
+void operator delete [] (void * memory, std::align_val_t alignment) noexcept                { idascm::allocation_hooks_free(memory, alignment); }
+void operator delete (void * memory, std::size_t, std::align_val_t alignment) noexcept      { idascm::allocation_hooks_free(memory, alignment); }
+void operator delete [] (void * memory, std::size_t, std::align_val_t alignment) noexcept   { idascm::allocation_hooks_free(memory, alignment); }
+# endif
@@ -0,0 +1,194 @@
+# include <core/arena.hpp>
+# include <cstdint>
+# include <cstring>
+
+namespace idascm
+{
+    // header of every arena block, data follows
+    struct alignas(std::max_align_t) arena_block
+    {
+        arena_block *   next;
+        std::size_t     size;   // data bytes
+        std::size_t     used;
+
+        auto data(void) noexcept -> unsigned char *
+        {
+            return reinterpret_cast<unsigned char *>(this + 1);
+        }
+    };
+
+    namespace
+    {
+        auto align_offset(void const * pointer, std::size_t alignment) noexcept -> std::size_t
+        {
+            auto const address = reinterpret_cast<std::uintptr_t>(pointer);
+            return (alignment - (address & (alignment - 1))) & (alignment - 1);
+        }
+
+        auto block_fits(arena_block * block, std::size_t size, std::size_t alignment) noexcept -> bool
+        {
+            auto const padding = align_offset(block->data() + block->used, alignment);
+            return block->size - block->used >= padding && block->size - block->used - padding >= size;
+        }
+
+        static_assert(sizeof(arena_block) % alignof(std::max_align_t) == 0, "block data must stay aligned");
+    }
+
+    arena::arena(std::size_t block_size) noexcept
+        : m_first(nullptr)
+        , m_current(nullptr)
+        , m_block_size(block_size ? block_size : 4096)
+    {}
+
+    arena::arena(arena && other) noexcept
+        : m_first(other.m_first)
+        , m_current(other.m_current)
+        , m_block_size(other.m_block_size)
+    {
+        other.m_first   = nullptr;
+        other.m_current = nullptr;
+    }
+
+    auto arena::operator = (arena && other) noexcept -> arena &
+    {
+        if (this != &other)
+        {
+            release();
+            m_first         = other.m_first;
+            m_current       = other.m_current;
+            m_block_size    = other.m_block_size;
+            other.m_first   = nullptr;
+            other.m_current = nullptr;
+        }
+        return *this;
+    }
+
+    arena::~arena(void) noexcept
+    {
+        release();
+    }
+
+    auto arena::allocate(std::size_t size, std::size_t alignment) noexcept -> void *
+    {
+        if (! alignment || (alignment & (alignment - 1)))
+            return nullptr;
+        if (! m_current || ! block_fits(m_current, size, alignment))
+        {
+            if (! grow(size, alignment))
+                return nullptr;
+        }
+        auto const data = m_current->data() + m_current->used;
+        auto const padding = align_offset(data, alignment);
+        m_current->used += padding + size;
+        return data + padding;
+    }
+
+    auto arena::store(std::string_view string) noexcept -> std::string_view
+    {
+        if (string.empty())
+            return std::string_view();
+        auto const data = static_cast<char *>(allocate(string.size() + 1, 1));
+        if (! data)
+            return std::string_view();
+        std::memcpy(data, string.data(), string.size());
+        data[string.size()] = '\0';
+        return std::string_view(data, string.size());
+    }
+
+    auto arena::reserve(std::size_t size) noexcept -> bool
+    {
+        if (m_current && block_fits(m_current, size, alignof(std::max_align_t)))
+            return true;
+        return grow(size, alignof(std::max_align_t));
+    }
+
+    auto arena::mark(void) const noexcept -> marker
+    {
+        return { m_current, m_current ? m_current->used : 0 };
+    }
+
+    void arena::rewind(marker const & marker) noexcept
+    {
+        if (! marker.block)
+        {
+            reset();
+            return;
+        }
+        for (auto block = marker.block->next; block; block = block->next)
+            block->used = 0;
+        m_current       = marker.block;
+        m_current->used = marker.used;
+    }
+
+    void arena::reset(void) noexcept
+    {
+        for (auto block = m_first; block; block = block->next)
+            block->used = 0;
+        m_current = m_first;
+    }
+
+    void arena::release(void) noexcept
+    {
+        while (m_first)
+        {
+            auto const next = m_first->next;
+            ::operator delete(m_first);
+            m_first = next;
+        }
+        m_current = nullptr;
+    }
+
+    auto arena::used(void) const noexcept -> std::size_t
+    {
+        std::size_t result = 0;
+        for (auto block = m_first; block; block = block->next)
+            result += block->used;
+        return result;
+    }
+
+    auto arena::capacity(void) const noexcept -> std::size_t
+    {
+        std::size_t result = 0;
+        for (auto block = m_first; block; block = block->next)
+            result += block->size;
+        return result;
+    }
+
+    auto arena::block_count(void) const noexcept -> std::size_t
+    {
+        std::size_t result = 0;
+        for (auto block = m_first; block; block = block->next)
+            ++ result;
+        return result;
+    }
+
+    // moves on to the next free block if it is large enough, otherwise links a new one after the current
+    auto arena::grow(std::size_t size, std::size_t alignment) noexcept -> bool
+    {
+        if (m_current && m_current->next && block_fits(m_current->next, size, alignment))
+        {
+            m_current = m_current->next;
+            return true;
+        }
+        auto const slack = alignment > alignof(std::max_align_t) ? alignment : 0;
+        if (size > static_cast<std::size_t>(-1) - sizeof(arena_block) - slack)
+            return false;
+        auto const data_size = size + slack > m_block_size ? size + slack : m_block_size;
+        auto const memory = ::operator new(sizeof(arena_block) + data_size, std::nothrow);
+        if (! memory)
+            return false;
+        auto const block = new (memory) arena_block { nullptr, data_size, 0 };
+        if (m_current)
+        {
+            block->next = m_current->next;
+            m_current->next = block;
+        }
+        else
+        {
+            block->next = m_first;
+            m_first = block;
+        }
+        m_current = block;
+        return true;
+    }
+}
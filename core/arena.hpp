@@ -0,0 +1,168 @@
+# pragma once
+# include <core/core.hpp>
+# include <cstddef>
+# include <new>
+# include <string_view>
+# include <type_traits>
+# include <utility>
+
+namespace idascm
+{
+    struct arena_block;
+
+    // monotonic allocator: memory is carved out of large blocks and only
+    // given back all at once (reset / rewind / destruction)
+    // no destructors are run, objects placed in an arena must not need one
+    // not thread safe, use one arena per thread
+    class arena
+    {
+        public:
+            // allocation state to come back to, see rewind() and scope
+            struct marker
+            {
+                arena_block *   block;
+                std::size_t     used;
+            };
+
+            // rewinds the arena to where it was at construction time
+            class scope
+            {
+                public:
+                    explicit scope(arena & arena) noexcept
+                        : m_arena(arena)
+                        , m_marker(arena.mark())
+                    {}
+
+                    ~scope(void) noexcept
+                    {
+                        m_arena.rewind(m_marker);
+                    }
+
+                private:
+                    scope(scope const &) = delete;
+                    auto operator = (scope const &) -> scope & = delete;
+
+                private:
+                    arena &     m_arena;
+                    marker      m_marker;
+            };
+
+        public:
+            // nullptr if the system is out of memory
+            auto allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) noexcept -> void *;
+
+            template <typename type, typename... types>
+            auto make(types && ... values) noexcept -> type *
+            {
+                static_assert(std::is_trivially_destructible<type>::value, "arena objects are never destroyed");
+                auto memory = allocate(sizeof(type), alignof(type));
+                if (! memory)
+                    return nullptr;
+                return new (memory) type { std::forward<types>(values) ... };
+            }
+
+            template <typename type>
+            auto make_array(std::size_t count) noexcept -> type *
+            {
+                static_assert(std::is_trivially_destructible<type>::value, "arena objects are never destroyed");
+                if (count > static_cast<std::size_t>(-1) / sizeof(type))
+                    return nullptr;
+                auto memory = allocate(sizeof(type) * count, alignof(type));
+                if (! memory)
+                    return nullptr;
+                auto const first = static_cast<type *>(memory);
+                for (std::size_t i = 0; i < count; ++ i)
+                    new (first + i) type;
+                return first;
+            }
+
+            // zero terminated copy, empty strings take no space
+            auto store(std::string_view string) noexcept -> std::string_view;
+
+            // makes sure the next 'size' bytes come from a single block
+            auto reserve(std::size_t size) noexcept -> bool;
+
+            auto mark(void) const noexcept -> marker;
+            // gives back everything allocated after 'marker' was taken, blocks are kept for reuse
+            void rewind(marker const & marker) noexcept;
+            // rewind to the very beginning, blocks are kept for reuse
+            void reset(void) noexcept;
+            // frees every block
+            void release(void) noexcept;
+
+            auto used(void) const noexcept -> std::size_t;
+            auto capacity(void) const noexcept -> std::size_t;
+            auto block_count(void) const noexcept -> std::size_t;
+
+        public:
+            // 'block_size' - size of regular blocks, larger requests get a block of their own
+            explicit arena(std::size_t block_size = 4096) noexcept;
+            arena(arena && other) noexcept;
+            auto operator = (arena && other) noexcept -> arena &;
+            ~arena(void) noexcept;
+
+        private:
+            arena(arena const &) = delete;
+            auto operator = (arena const &) -> arena & = delete;
+
+        private:
+            auto grow(std::size_t size, std::size_t alignment) noexcept -> bool;
+
+        private:
+            arena_block *   m_first;
+            arena_block *   m_current;      // blocks past it are free
+            std::size_t     m_block_size;
+    };
+
+    // STL allocator over an arena, deallocation is a no-op
+    template <typename type>
+    class arena_allocator
+    {
+        public:
+            using value_type = type;
+
+        public:
+            auto allocate(std::size_t count) -> type *
+            {
+                if (count > static_cast<std::size_t>(-1) / sizeof(type))
+                    throw std::bad_alloc();
+                auto const memory = m_arena->allocate(sizeof(type) * count, alignof(type));
+                if (! memory)
+                    throw std::bad_alloc();
+                return static_cast<type *>(memory);
+            }
+
+            void deallocate(type *, std::size_t) noexcept
+            {}
+
+            auto get_arena(void) const noexcept -> arena &
+            {
+                return *m_arena;
+            }
+
+        public:
+            arena_allocator(arena & arena) noexcept
+                : m_arena(&arena)
+            {}
+
+            template <typename other>
+            arena_allocator(arena_allocator<other> const & allocator) noexcept
+                : m_arena(&allocator.get_arena())
+            {}
+
+        private:
+            arena * m_arena;
+    };
+
+    template <typename first, typename second>
+    auto operator == (arena_allocator<first> const & lhs, arena_allocator<second> const & rhs) noexcept -> bool
+    {
+        return &lhs.get_arena() == &rhs.get_arena();
+    }
+
+    template <typename first, typename second>
+    auto operator != (arena_allocator<first> const & lhs, arena_allocator<second> const & rhs) noexcept -> bool
+    {
+        return ! (lhs == rhs);
+    }
+}
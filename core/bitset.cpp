@@ -0,0 +1,75 @@
+# include <core/bitset.hpp>
+# if defined _M_X64 || defined __x86_64__
+#   define IDASCM_BITSET_X64
+#   include <immintrin.h>
+#   if defined _MSC_VER
+#     define IDASCM_TARGET_AVX2
+#   else
+#     define IDASCM_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+# endif
+
+namespace idascm
+{
+    namespace
+    {
+        auto bit_count_scalar(std::uint64_t const * words, std::size_t count) noexcept -> std::size_t
+        {
+            std::size_t result = 0;
+            for (std::size_t i = 0; i < count; ++ i)
+                result += bit_count(words[i]);
+            return result;
+        }
+
+# if defined IDASCM_BITSET_X64
+        // nibble lookup (vpshufb) per byte, byte sums folded with vpsadbw
+        IDASCM_TARGET_AVX2
+        auto bit_count_avx2(std::uint64_t const * words, std::size_t count) noexcept -> std::size_t
+        {
+            __m256i const table = _mm256_setr_epi8(
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+            );
+            __m256i const low = _mm256_set1_epi8(0x0f);
+            __m256i total = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256i const v  = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(words + i));
+                __m256i const lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+                __m256i const hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+                total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+            }
+            std::size_t result = static_cast<std::size_t>(
+                  _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1)
+                + _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3)
+            );
+            return result + bit_count_scalar(words + i, count - i);
+        }
+# endif
+    }
+
+    auto bit_count(std::uint64_t const * words, std::size_t count) noexcept -> std::size_t
+    {
+# if defined IDASCM_BITSET_X64
+        static bool const s_avx2 = cpu_supports_avx2();
+        if (s_avx2 && count >= 16)
+            return bit_count_avx2(words, count);
+# endif
+        return bit_count_scalar(words, count);
+    }
+
+    void bitset_rank_index::build(std::uint64_t const * words, std::size_t word_count)
+    {
+        m_words = words;
+        m_blocks.assign(word_count / 8 + 1, 0);
+        std::size_t total = 0;
+        for (std::size_t block = 0; block < m_blocks.size(); ++ block)
+        {
+            m_blocks[block] = total;
+            auto const first = block * 8;
+            if (first < word_count)
+                total += bit_count(words + first, word_count - first < 8 ? word_count - first : 8);
+        }
+    }
+}
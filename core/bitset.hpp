@@ -0,0 +1,330 @@
+# pragma once
+# include <core/core.hpp>
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+# if defined _MSC_VER
+#   include <intrin.h>
+# endif
+
+namespace idascm
+{
+    inline auto bit_count(std::uint64_t word) noexcept -> unsigned
+    {
+# if defined _MSC_VER && defined _M_X64
+        return static_cast<unsigned>(__popcnt64(word));
+# elif defined __GNUC__
+        return static_cast<unsigned>(__builtin_popcountll(word));
+# else
+        word = word - ((word >> 1) & 0x5555555555555555ull);
+        word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return static_cast<unsigned>((word * 0x0101010101010101ull) >> 56);
+# endif
+    }
+
+    // index of the lowest set bit, 'word' must not be 0
+    inline auto bit_lowest(std::uint64_t word) noexcept -> unsigned
+    {
+# if defined _MSC_VER && defined _M_X64
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return index;
+# elif defined __GNUC__
+        return static_cast<unsigned>(__builtin_ctzll(word));
+# else
+        unsigned index = 0;
+        while (! (word & 1))
+        {
+            word >>= 1;
+            ++ index;
+        }
+        return index;
+# endif
+    }
+
+    // set bits of words[0, count), vectorized (AVX2) when the CPU allows
+    auto bit_count(std::uint64_t const * words, std::size_t count) noexcept -> std::size_t;
+
+    // bitset operations over a word storage (words(), word_count(), size())
+    // bits past size() are kept clear
+    template <typename storage>
+    class basic_bitset : public storage
+    {
+        public:
+            using storage::storage;
+            using storage::size;
+            using storage::words;
+            using storage::word_count;
+
+        public:
+            auto test(std::size_t index) const noexcept -> bool
+            {
+                return 0 != (words()[index / 64] & (std::uint64_t(1) << (index % 64)));
+            }
+
+            void set(std::size_t index) noexcept
+            {
+                words()[index / 64] |= std::uint64_t(1) << (index % 64);
+            }
+
+            void set(std::size_t index, bool value) noexcept
+            {
+                if (value)
+                    set(index);
+                else
+                    reset(index);
+            }
+
+            void reset(std::size_t index) noexcept
+            {
+                words()[index / 64] &= ~(std::uint64_t(1) << (index % 64));
+            }
+
+            void flip(std::size_t index) noexcept
+            {
+                words()[index / 64] ^= std::uint64_t(1) << (index % 64);
+            }
+
+            void set(void) noexcept
+            {
+                for (std::size_t i = 0; i < word_count(); ++ i)
+                    words()[i] = ~std::uint64_t(0);
+                trim();
+            }
+
+            void reset(void) noexcept
+            {
+                for (std::size_t i = 0; i < word_count(); ++ i)
+                    words()[i] = 0;
+            }
+
+            void flip(void) noexcept
+            {
+                for (std::size_t i = 0; i < word_count(); ++ i)
+                    words()[i] = ~words()[i];
+                trim();
+            }
+
+            auto count(void) const noexcept -> std::size_t
+            {
+                return bit_count(words(), word_count());
+            }
+
+            auto any(void) const noexcept -> bool
+            {
+                for (std::size_t i = 0; i < word_count(); ++ i)
+                    if (words()[i])
+                        return true;
+                return false;
+            }
+
+            auto none(void) const noexcept -> bool
+            {
+                return ! any();
+            }
+
+            // set bits in [0, index)
+            auto rank(std::size_t index) const noexcept -> std::size_t
+            {
+                auto result = bit_count(words(), index / 64);
+                if (index % 64)
+                    result += bit_count(words()[index / 64] & ((std::uint64_t(1) << (index % 64)) - 1));
+                return result;
+            }
+
+            // first set bit at or past 'index', size() if none
+            auto find_next(std::size_t index) const noexcept -> std::size_t
+            {
+                if (index >= size())
+                    return size();
+                auto word = index / 64;
+                auto bits = words()[word] & (~std::uint64_t(0) << (index % 64));
+                while (! bits)
+                {
+                    if (++ word >= word_count())
+                        return size();
+                    bits = words()[word];
+                }
+                return word * 64 + bit_lowest(bits);
+            }
+
+            auto find_first(void) const noexcept -> std::size_t
+            {
+                return find_next(0);
+            }
+
+            // fn(index) for every set bit in increasing order
+            template <typename function>
+            void for_each(function && fn) const
+            {
+                for (std::size_t word = 0; word < word_count(); ++ word)
+                    for (auto bits = words()[word]; bits; bits &= bits - 1)
+                        fn(word * 64 + bit_lowest(bits));
+            }
+
+            // same size only
+            auto operator &= (basic_bitset const & other) noexcept -> basic_bitset &
+            {
+                for (std::size_t i = 0; i < word_count(); ++ i)
+                    words()[i] &= other.words()[i];
+                return *this;
+            }
+
+            auto operator |= (basic_bitset const & other) noexcept -> basic_bitset &
+            {
+                for (std::size_t i = 0; i < word_count(); ++ i)
+                    words()[i] |= other.words()[i];
+                return *this;
+            }
+
+            auto operator ^= (basic_bitset const & other) noexcept -> basic_bitset &
+            {
+                for (std::size_t i = 0; i < word_count(); ++ i)
+                    words()[i] ^= other.words()[i];
+                return *this;
+            }
+
+            auto operator == (basic_bitset const & other) const noexcept -> bool
+            {
+                if (size() != other.size())
+                    return false;
+                for (std::size_t i = 0; i < word_count(); ++ i)
+                    if (words()[i] != other.words()[i])
+                        return false;
+                return true;
+            }
+
+            auto operator != (basic_bitset const & other) const noexcept -> bool
+            {
+                return ! (*this == other);
+            }
+
+        private:
+            void trim(void) noexcept
+            {
+                if (size() % 64)
+                    words()[word_count() - 1] &= (std::uint64_t(1) << (size() % 64)) - 1;
+            }
+    };
+
+    template <std::size_t bits>
+    class fixed_bitset_storage
+    {
+        public:
+            auto words(void) noexcept -> std::uint64_t *
+            {
+                return m_words;
+            }
+
+            auto words(void) const noexcept -> std::uint64_t const *
+            {
+                return m_words;
+            }
+
+            constexpr auto word_count(void) const noexcept -> std::size_t
+            {
+                return (bits + 63) / 64;
+            }
+
+            constexpr auto size(void) const noexcept -> std::size_t
+            {
+                return bits;
+            }
+
+        public:
+            fixed_bitset_storage(void) noexcept
+                : m_words {}
+            {}
+
+        private:
+            std::uint64_t   m_words[(bits + 63) / 64];
+    };
+
+    class dynamic_bitset_storage
+    {
+        public:
+            auto words(void) noexcept -> std::uint64_t *
+            {
+                return m_words.data();
+            }
+
+            auto words(void) const noexcept -> std::uint64_t const *
+            {
+                return m_words.data();
+            }
+
+            auto word_count(void) const noexcept -> std::size_t
+            {
+                return m_words.size();
+            }
+
+            auto size(void) const noexcept -> std::size_t
+            {
+                return m_size;
+            }
+
+            // new bits are clear
+            void resize(std::size_t size)
+            {
+                m_words.resize((size + 63) / 64, 0);
+                if (size < m_size && size % 64)
+                    m_words.back() &= (std::uint64_t(1) << (size % 64)) - 1;
+                m_size = size;
+            }
+
+        public:
+            explicit dynamic_bitset_storage(std::size_t size = 0)
+                : m_words((size + 63) / 64, 0)
+                , m_size(size)
+            {}
+
+        private:
+            std::vector<std::uint64_t>  m_words;
+            std::size_t                 m_size;
+    };
+
+    // bitset with a compile time size (opcode sets, flags per operand type)
+    template <std::size_t bits>
+    using fixed_bitset = basic_bitset<fixed_bitset_storage<bits>>;
+
+    // bitset sized at run time (address maps over a whole script)
+    using dynamic_bitset = basic_bitset<dynamic_bitset_storage>;
+
+    // constant time rank over a bitset that no longer changes
+    // one cumulative count per 512 bits, an eighth of the bitset's size
+    class bitset_rank_index
+    {
+        public:
+            template <typename storage>
+            void build(basic_bitset<storage> const & bitset)
+            {
+                build(bitset.words(), bitset.word_count());
+            }
+
+            void build(std::uint64_t const * words, std::size_t word_count);
+
+            // set bits in [0, index), 'index' within the indexed bitset
+            auto rank(std::size_t index) const noexcept -> std::size_t
+            {
+                auto const block = index / 512;
+                auto result = m_blocks[block];
+                auto const first = block * 8;
+                auto const last  = index / 64;
+                for (auto word = first; word < last; ++ word)
+                    result += bit_count(m_words[word]);
+                if (index % 64)
+                    result += bit_count(m_words[last] & ((std::uint64_t(1) << (index % 64)) - 1));
+                return result;
+            }
+
+        public:
+            bitset_rank_index(void) noexcept
+                : m_words(nullptr)
+            {}
+
+        private:
+            std::uint64_t const *       m_words;
+            std::vector<std::size_t>    m_blocks;   // set bits before each 512 bit block
+    };
+}
@@ -1,4 +1,8 @@
 # include <core/core.hpp>
+# if defined _MSC_VER && defined _M_X64
+#   include <intrin.h>
+#   include <immintrin.h>
+# endif
 
 namespace idascm
 {
@@ -6,4 +10,21 @@ namespace idascm
     {
         return IDASCM_GIT_REVISION " [" __DATE__ " " __TIME__ " " IDASCM_TOSTRING(IDASCM_BUILD_TYPE) "]";
     }
+
+    auto cpu_supports_avx2(void) noexcept -> bool
+    {
+# if defined _MSC_VER && defined _M_X64
+        int info[4] = {};
+        __cpuid(info, 1);
+        bool const osxsave = (info[2] & (1 << 27)) != 0;
+        if (! osxsave || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+# elif defined __x86_64__ && defined __GNUC__
+        return __builtin_cpu_supports("avx2");
+# else
+        return false;
+# endif
+    }
 }
@@ -13,4 +13,7 @@
 namespace idascm
 {
     auto build_version(void) noexcept -> char const *;
+
+    // x86-64 with AVX2 usable by the OS (false on other architectures)
+    auto cpu_supports_avx2(void) noexcept -> bool;
 }
@@ -0,0 +1,442 @@
+# pragma once
+# include <core/core.hpp>
+# include <cstdint>
+# include <cstring>
+# include <functional>
+# include <memory>
+# include <new>
+# include <type_traits>
+# include <utility>
+# if defined _M_X64 || defined __x86_64__ || defined __SSE2__
+#   define IDASCM_HASH_SSE2
+#   include <emmintrin.h>
+# endif
+# if defined _MSC_VER
+#   include <intrin.h>
+# endif
+
+namespace idascm
+{
+    // default hash: std::hash, integers are mixed first (std::hash is usually the identity
+    // for them, which leaves the low bits and the control byte badly distributed)
+    template <typename key, typename = void>
+    struct flat_hash
+    {
+        auto operator () (key const & value) const noexcept -> std::size_t
+        {
+            return std::hash<key>()(value);
+        }
+    };
+
+    template <typename key>
+    struct flat_hash<key, std::enable_if_t<std::is_integral<key>::value || std::is_enum<key>::value>>
+    {
+        auto operator () (key value) const noexcept -> std::size_t
+        {
+            // murmur3 finalizer
+            auto x = static_cast<std::uint64_t>(value);
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ull;
+            x ^= x >> 33;
+            return static_cast<std::size_t>(x);
+        }
+    };
+
+    // open addressing hash map with flat storage
+    // a control byte per slot holds 7 bits of the hash (or 'empty'), lookups compare 16 control bytes
+    // at once and only touch slots whose byte matches
+    // linear probing with backward shift deletion: no tombstones, the table never degrades
+    // pointers and iterators are invalidated by insertion (rehash) and erasure
+    template <typename key, typename value, typename hash = flat_hash<key>, typename equal = std::equal_to<key>>
+    class flat_hash_map
+    {
+        public:
+            using value_type = std::pair<key, value>;   // keys must not be modified through iteration
+
+            template <typename entry>
+            class basic_iterator
+            {
+                public:
+                    auto operator * (void) const noexcept -> entry &
+                    {
+                        return m_map->m_slots[m_index];
+                    }
+
+                    auto operator -> (void) const noexcept -> entry *
+                    {
+                        return &m_map->m_slots[m_index];
+                    }
+
+                    auto operator ++ (void) noexcept -> basic_iterator &
+                    {
+                        m_index = m_map->next_full(m_index + 1);
+                        return *this;
+                    }
+
+                    auto operator == (basic_iterator const & other) const noexcept -> bool
+                    {
+                        return m_index == other.m_index;
+                    }
+
+                    auto operator != (basic_iterator const & other) const noexcept -> bool
+                    {
+                        return m_index != other.m_index;
+                    }
+
+                public:
+                    basic_iterator(flat_hash_map const * map, std::size_t index) noexcept
+                        : m_map(map)
+                        , m_index(index)
+                    {}
+
+                private:
+                    flat_hash_map const *   m_map;
+                    std::size_t             m_index;
+            };
+
+            using iterator          = basic_iterator<value_type>;
+            using const_iterator    = basic_iterator<value_type const>;
+
+        public:
+            auto find(key const & k) noexcept -> value *
+            {
+                auto const index = find_index(k);
+                return index < m_capacity ? &m_slots[index].second : nullptr;
+            }
+
+            auto find(key const & k) const noexcept -> value const *
+            {
+                auto const index = find_index(k);
+                return index < m_capacity ? &m_slots[index].second : nullptr;
+            }
+
+            auto contains(key const & k) const noexcept -> bool
+            {
+                return find_index(k) < m_capacity;
+            }
+
+            // value of an existing key is left untouched, 'second' tells if the key was added
+            template <typename... types>
+            auto emplace(key const & k, types && ... values) -> std::pair<value *, bool>
+            {
+                auto const h = hash()(k);
+                auto index = find_index(k, h);
+                if (index < m_capacity)
+                    return { &m_slots[index].second, false };
+                if ((m_size + 1) * 8 > m_capacity * 7)
+                    rehash(m_capacity ? m_capacity * 2 : min_capacity);
+                index = find_empty(h);
+                new (&m_slots[index]) value_type(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::forward<types>(values) ...));
+                set_control(index, control_hash(h));
+                ++ m_size;
+                return { &m_slots[index].second, true };
+            }
+
+            auto insert(key const & k, value const & v) -> bool
+            {
+                return emplace(k, v).second;
+            }
+
+            // assigns existing keys
+            auto insert_or_assign(key const & k, value const & v) -> value &
+            {
+                auto const result = emplace(k, v);
+                if (! result.second)
+                    *result.first = v;
+                return *result.first;
+            }
+
+            auto operator [] (key const & k) -> value &
+            {
+                return *emplace(k).first;
+            }
+
+            auto erase(key const & k) -> bool
+            {
+                auto index = find_index(k);
+                if (index >= m_capacity)
+                    return false;
+                m_slots[index].~value_type();
+                -- m_size;
+                // pull back later members of the run whose home is not past the hole
+                auto const mask = m_capacity - 1;
+                for (auto next = (index + 1) & mask; control_empty != m_control[next]; next = (next + 1) & mask)
+                {
+                    auto const home = hash()(m_slots[next].first) & mask;
+                    if (((next - home) & mask) < ((next - index) & mask))
+                        continue;
+                    new (&m_slots[index]) value_type(std::move(m_slots[next]));
+                    m_slots[next].~value_type();
+                    set_control(index, m_control[next]);
+                    index = next;
+                }
+                set_control(index, control_empty);
+                return true;
+            }
+
+            void clear(void) noexcept
+            {
+                destroy();
+                if (m_capacity)
+                    std::memset(m_control, control_empty, m_capacity + group_width);
+                m_size = 0;
+            }
+
+            // room for 'count' elements without rehashing
+            void reserve(std::size_t count)
+            {
+                std::size_t capacity = min_capacity;
+                while (capacity * 7 < count * 8)
+                    capacity *= 2;
+                if (capacity > m_capacity)
+                    rehash(capacity);
+            }
+
+            auto size(void) const noexcept -> std::size_t
+            {
+                return m_size;
+            }
+
+            auto empty(void) const noexcept -> bool
+            {
+                return ! m_size;
+            }
+
+            auto capacity(void) const noexcept -> std::size_t
+            {
+                return m_capacity;
+            }
+
+            // storage bytes (slots and control bytes)
+            auto memory_usage(void) const noexcept -> std::size_t
+            {
+                return m_capacity ? m_capacity * sizeof(value_type) + m_capacity + group_width : 0;
+            }
+
+            auto begin(void) noexcept -> iterator
+            {
+                return iterator(this, next_full(0));
+            }
+
+            auto end(void) noexcept -> iterator
+            {
+                return iterator(this, m_capacity);
+            }
+
+            auto begin(void) const noexcept -> const_iterator
+            {
+                return const_iterator(this, next_full(0));
+            }
+
+            auto end(void) const noexcept -> const_iterator
+            {
+                return const_iterator(this, m_capacity);
+            }
+
+        public:
+            flat_hash_map(void) noexcept
+                : m_control(nullptr)
+                , m_slots(nullptr)
+                , m_capacity(0)
+                , m_size(0)
+            {}
+
+            flat_hash_map(flat_hash_map const & other)
+                : flat_hash_map()
+            {
+                reserve(other.m_size);
+                for (auto const & entry : other)
+                    emplace(entry.first, entry.second);
+            }
+
+            flat_hash_map(flat_hash_map && other) noexcept
+                : flat_hash_map()
+            {
+                swap(other);
+            }
+
+            auto operator = (flat_hash_map other) noexcept -> flat_hash_map &
+            {
+                swap(other);
+                return *this;
+            }
+
+            ~flat_hash_map(void) noexcept
+            {
+                destroy();
+                deallocate();
+            }
+
+            void swap(flat_hash_map & other) noexcept
+            {
+                std::swap(m_control,    other.m_control);
+                std::swap(m_slots,      other.m_slots);
+                std::swap(m_capacity,   other.m_capacity);
+                std::swap(m_size,       other.m_size);
+            }
+
+        private:
+            enum : std::uint8_t
+            {
+                control_empty = 0x80,   // full slots hold the 7 upper hash bits
+            };
+
+            enum : std::size_t
+            {
+                group_width     = 16,
+                min_capacity    = 16,
+            };
+
+        private:
+            static auto control_hash(std::size_t h) noexcept -> std::uint8_t
+            {
+                return static_cast<std::uint8_t>(h >> (sizeof(std::size_t) * 8 - 7));
+            }
+
+            // bit N set if control byte N of the group equals 'byte'
+            static auto match(std::uint8_t const * group, std::uint8_t byte) noexcept -> std::uint32_t
+            {
+# if defined IDASCM_HASH_SSE2
+                auto const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(group));
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(byte)))));
+# else
+                std::uint32_t mask = 0;
+                for (std::size_t i = 0; i < group_width; ++ i)
+                    mask |= std::uint32_t(group[i] == byte) << i;
+                return mask;
+# endif
+            }
+
+            static auto lowest(std::uint32_t mask) noexcept -> unsigned
+            {
+# if defined _MSC_VER
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                return index;
+# elif defined __GNUC__
+                return static_cast<unsigned>(__builtin_ctz(mask));
+# else
+                unsigned index = 0;
+                while (! (mask & 1))
+                {
+                    mask >>= 1;
+                    ++ index;
+                }
+                return index;
+# endif
+            }
+
+            auto find_index(key const & k) const noexcept -> std::size_t
+            {
+                return m_size ? find_index(k, hash()(k)) : m_capacity;
+            }
+
+            // slot index, m_capacity if missing
+            // members of a run are never preceded by a hole, the first group with an empty slot ends the search
+            auto find_index(key const & k, std::size_t h) const noexcept -> std::size_t
+            {
+                if (! m_capacity)
+                    return 0;
+                auto const mask = m_capacity - 1;
+                auto const tag  = control_hash(h);
+                for (auto position = h & mask; ; position = (position + group_width) & mask)
+                {
+                    auto const group = m_control + position;
+                    for (auto candidates = match(group, tag); candidates; candidates &= candidates - 1)
+                    {
+                        auto const index = (position + lowest(candidates)) & mask;
+                        if (equal()(m_slots[index].first, k))
+                            return index;
+                    }
+                    if (match(group, control_empty))
+                        return m_capacity;
+                }
+            }
+
+            auto find_empty(std::size_t h) const noexcept -> std::size_t
+            {
+                auto const mask = m_capacity - 1;
+                for (auto position = h & mask; ; position = (position + group_width) & mask)
+                {
+                    if (auto const empty = match(m_control + position, control_empty))
+                        return (position + lowest(empty)) & mask;
+                }
+            }
+
+            // the first group_width bytes are mirrored past the end, so groups never wrap
+            void set_control(std::size_t index, std::uint8_t byte) noexcept
+            {
+                m_control[index] = byte;
+                if (index < group_width)
+                    m_control[m_capacity + index] = byte;
+            }
+
+            auto next_full(std::size_t index) const noexcept -> std::size_t
+            {
+                while (index < m_capacity && control_empty == m_control[index])
+                    ++ index;
+                return index;
+            }
+
+            void rehash(std::size_t capacity)
+            {
+                flat_hash_map table;
+                table.allocate(capacity);
+                for (std::size_t i = 0; i < m_capacity; ++ i)
+                {
+                    if (control_empty == m_control[i])
+                        continue;
+                    auto const h = hash()(m_slots[i].first);
+                    auto const index = table.find_empty(h);
+                    new (&table.m_slots[index]) value_type(std::move(m_slots[i]));
+                    table.set_control(index, control_hash(h));
+                    ++ table.m_size;
+                }
+                swap(table);
+            }
+
+            void allocate(std::size_t capacity)
+            {
+                auto slots = std::allocator<value_type>().allocate(capacity);
+                try
+                {
+                    m_control = new std::uint8_t[capacity + group_width];
+                }
+                catch (...)
+                {
+                    std::allocator<value_type>().deallocate(slots, capacity);
+                    throw;
+                }
+                std::memset(m_control, control_empty, capacity + group_width);
+                m_slots     = slots;
+                m_capacity  = capacity;
+            }
+
+            void destroy(void) noexcept
+            {
+                if (std::is_trivially_destructible<value_type>::value)
+                    return;
+                for (std::size_t i = 0; i < m_capacity; ++ i)
+                    if (control_empty != m_control[i])
+                        m_slots[i].~value_type();
+            }
+
+            void deallocate(void) noexcept
+            {
+                if (m_slots)
+                    std::allocator<value_type>().deallocate(m_slots, m_capacity);
+                delete [] m_control;
+                m_slots     = nullptr;
+                m_control   = nullptr;
+                m_capacity  = 0;
+            }
+
+        private:
+            std::uint8_t *  m_control;      // m_capacity + group_width bytes
+            value_type *    m_slots;
+            std::size_t     m_capacity;     // power of two
+            std::size_t     m_size;
+    };
+}
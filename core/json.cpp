@@ -1,41 +1,90 @@
 # include <core/json.hpp>
+# include <core/arena.hpp>
+# define IDASCM_JSMN_IMPLEMENTATION
+# include <core/json_token.hpp>
+# include <core/json_structural.hpp>
+# include <core/mapped_file.hpp>
+# include <core/memory_report.hpp>
+# include <core/profiler.hpp>
 # include <algorithm>
+# include <atomic>
 # include <cassert>
+# include <charconv>
+# include <cstdio>
 # include <cstring>
-# include <3rd-party/jsmn/jsmn.h>
+# include <limits>
+# include <type_traits>
 
 namespace idascm
 {
+    // immutable once parsed, shared between threads through atomic reference counting
+    // the header, the source copy and the token pool live in the document's own arena
     struct json_data
     {
-        char *          source;     // input source as is
-        std::size_t     length;     // input source length
-        std::size_t     refs;       // references
-        std::size_t     count;      // token pool usage
-        std::size_t     capacity;   // token pool max size
-        jsmntok_t *     tokens;     // token pool
+        char *                      source;     // input source as is
+        std::size_t                 length;     // input source length
+        std::atomic<std::size_t>    refs;       // references
+        std::size_t                 count;      // token pool usage
+        std::size_t                 capacity;   // token pool max size
+        jsmntok_t *                 tokens;     // token pool
+        mapped_file                 mapping;    // source backing (file mapped documents only)
+        arena                       memory;     // every allocation above, this header included
     };
 
     namespace
     {
+        std::atomic<json_tokenizer> g_tokenizer { json_tokenizer::structural };
+
+        // the last owner must see every other owner's reads finished before freeing
         void json_data_release(json_data * data)
         {
-            if (-- data->refs)
+            if (1 != data->refs.fetch_sub(1, std::memory_order_acq_rel))
                 return;
-            delete [] data->source;
-            delete [] data->tokens;
-            delete data;
+            // the header is stored in the blocks it owns, take them out before it goes away
+            arena memory(static_cast<arena &&>(data->memory));
+            data->~json_data();
+        }
+
+        // header placed at the start of a block with room for 'size' more bytes
+        auto json_data_allocate(std::size_t size) -> json_data *
+        {
+            arena memory;
+            if (! memory.reserve(sizeof(json_data) + size))
+                return nullptr;
+            auto const header = memory.allocate(sizeof(json_data), alignof(json_data));
+            if (! header)
+                return nullptr;
+            auto const data = new (header) json_data;
+            data->memory    = static_cast<arena &&>(memory);
+            data->refs.store(1, std::memory_order_relaxed);
+            data->source    = nullptr;
+            data->length    = 0;
+            data->tokens    = nullptr;
+            data->capacity  = 0;
+            data->count     = 0;
+            return data;
+        }
+
+        auto json_data_allocate_tokens(json_data * data, std::size_t capacity) -> bool
+        {
+            if (capacity > static_cast<std::size_t>(-1) / sizeof(jsmntok_t))
+                return false;
+            data->tokens    = static_cast<jsmntok_t *>(data->memory.allocate(capacity * sizeof(jsmntok_t), alignof(jsmntok_t)));
+            data->capacity  = data->tokens ? capacity : 0;
+            return nullptr != data->tokens;
         }
 
+        // single block for the header, the source and a known token pool
+        // token pool is left empty for zero capacity (see json_data_tokenize)
         auto json_data_create(std::size_t length, std::size_t capacity) -> json_data *
         {
-            auto data = new (std::nothrow) json_data;
+            if (length > static_cast<std::size_t>(-1) / 4 || capacity > static_cast<std::size_t>(-1) / 4 / sizeof(jsmntok_t))
+                return nullptr;
+            auto data = json_data_allocate(length + 1 + alignof(jsmntok_t) + capacity * sizeof(jsmntok_t));
             if (! data)
                 return nullptr;
-            data->refs              = 1;
-            data->source            = new (std::nothrow) char[length + 1];
-            data->tokens            = new (std::nothrow) jsmntok_t[capacity];
-            if (! data->source || ! data->tokens)
+            data->source = static_cast<char *>(data->memory.allocate(length + 1, 1));
+            if (! data->source || (capacity && ! json_data_allocate_tokens(data, capacity)))
             {
                 json_data_release(data);
                 return nullptr;
@@ -43,11 +92,128 @@ namespace idascm
             data->length            = length;
             data->source[0]         = '\0';
             data->source[length]    = '\0';
-            data->capacity          = capacity;
-            data->count             = 0;
             return data;
         }
 
+        // source points into a private (copy-on-write) file mapping, the zero slack byte terminates it
+        auto json_data_create(mapped_file && file) -> json_data *
+        {
+            if (! file.is_open() || ! file.slack())
+                return nullptr;
+            auto data = json_data_allocate(0);
+            if (! data)
+                return nullptr;
+            data->mapping   = static_cast<mapped_file &&>(file);
+            data->source    = static_cast<char *>(data->mapping.data());
+            data->length    = data->mapping.size();
+            return data;
+        }
+
+        // counts tokens first, then parses the source once into an exactly sized pool
+        auto json_data_tokenize_jsmn(json_data * data, int & error_code) -> bool
+        {
+            jsmn_parser parser;
+            jsmn_init(&parser);
+            auto const count = jsmn_parse(&parser, data->source, data->length, nullptr, 0);
+            if (count < 0)
+            {
+                error_code = count;
+                return false;
+            }
+            if (! json_data_allocate_tokens(data, std::max<std::size_t>(count, 1)))
+            {
+                error_code = JSMN_ERROR_NOMEM;
+                return false;
+            }
+            jsmn_init(&parser);
+            auto const result = jsmn_parse(&parser, data->source, data->length, data->tokens, (unsigned int) data->capacity);
+            if (result < 0)
+            {
+                error_code = result;
+                return false;
+            }
+            data->count = result;
+            error_code  = 0;
+            return true;
+        }
+
+        // structural index when it models the input, jsmn for the rest and for every failure,
+        // so tokens and error codes are always the ones jsmn gives
+        auto json_data_tokenize(json_data * data, int & error_code) -> bool
+        {
+            assert(data && ! data->tokens);
+            auto const tokenizer = json_current_tokenizer();
+            if (json_tokenizer::jsmn != tokenizer)
+            {
+                json_structural_index index;
+                auto const count = index.build(data->source, data->length, tokenizer);
+                if (count >= 0 && json_data_allocate_tokens(data, std::max<std::size_t>(count, 1)))
+                {
+                    auto const result = index.tokenize(data->tokens, data->capacity);
+                    if (result >= 0)
+                    {
+                        data->count = result;
+                        error_code  = 0;
+                        return true;
+                    }
+                }
+            }
+            return json_data_tokenize_jsmn(data, error_code);
+        }
+
+        auto hex_digit(char c) noexcept -> int
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+
+        // \uXXXX code unit, -1 if malformed
+        auto read_code_unit(char const * string) noexcept -> long
+        {
+            long value = 0;
+            for (int i = 0; i < 4; ++ i)
+            {
+                auto const digit = hex_digit(string[i]);
+                if (digit < 0)
+                    return -1;
+                value = (value << 4) | digit;
+            }
+            return value;
+        }
+
+        // UTF-8 is never longer than the escape sequence, so this works in place
+        auto write_utf8(char * dst, unsigned long code) noexcept -> char *
+        {
+            if (code < 0x80)
+            {
+                *dst++ = static_cast<char>(code);
+            }
+            else if (code < 0x800)
+            {
+                *dst++ = static_cast<char>(0xc0 | (code >> 6));
+                *dst++ = static_cast<char>(0x80 | (code & 0x3f));
+            }
+            else if (code < 0x10000)
+            {
+                *dst++ = static_cast<char>(0xe0 | (code >> 12));
+                *dst++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                *dst++ = static_cast<char>(0x80 | (code & 0x3f));
+            }
+            else
+            {
+                *dst++ = static_cast<char>(0xf0 | (code >> 18));
+                *dst++ = static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+                *dst++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                *dst++ = static_cast<char>(0x80 | (code & 0x3f));
+            }
+            return dst;
+        }
+
         auto unescape_string(char * string) -> int
         {
             assert(string);
@@ -58,6 +224,8 @@ namespace idascm
                 if (*dst == '\\')
                 {
                     ++ dst;
+                    if (! *dst)
+                        break;
                     switch (*dst)
                     {
                         case 'n':
@@ -69,9 +237,39 @@ namespace idascm
                         case 't':
                             *src++ = '\t';
                             break;
+                        case 'b':
+                            *src++ = '\b';
+                            break;
+                        case 'f':
+                            *src++ = '\f';
+                            break;
                         case '"':
-                            *src++ = '"';
+                        case '\\':
+                        case '/':
+                            *src++ = *dst;
                             break;
+                        case 'u':
+                        {
+                            long code = read_code_unit(dst + 1);
+                            if (code < 0)
+                            {
+                                *src++ = 0;
+                                break;
+                            }
+                            dst += 4;
+                            // surrogate pair
+                            if (code >= 0xd800 && code < 0xdc00 && dst[1] == '\\' && dst[2] == 'u')
+                            {
+                                long const low = read_code_unit(dst + 3);
+                                if (low >= 0xdc00 && low < 0xe000)
+                                {
+                                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                                    dst += 6;
+                                }
+                            }
+                            src = write_utf8(src, static_cast<unsigned long>(code));
+                            break;
+                        }
                         default:
                             *src++ = 0;
                             break;
@@ -193,19 +391,102 @@ namespace idascm
             return nullptr;
         }
 
-        auto file_contents(char const * path) -> std::string
+        // primitive token text (unescaped), without relying on the terminator
+        auto token_span(json_data const * data, std::size_t index, char const * & first, char const * & last) noexcept -> bool
+        {
+            if (! data)
+                return false;
+            auto const & token = data->tokens[index];
+            switch (token.type)
+            {
+                case JSMN_STRING:
+                case JSMN_PRIMITIVE:
+                    first = data->source + token.start;
+                    last  = data->source + token.end;
+                    return true;
+                default:
+                    break;
+            }
+            return false;
+        }
+
+        // optional '-', optional "0x" (hex), rest must be digits
+        template <typename type>
+        auto parse_integer(char const * first, char const * last, type & value) noexcept -> bool
         {
-            std::string contents;
+            bool const negative = first != last && '-' == *first;
+            if (negative)
+                ++ first;
+            int base = 10;
+            if (last - first > 2 && '0' == first[0] && ('x' == first[1] || 'X' == first[1]))
+            {
+                base   = 16;
+                first += 2;
+            }
+            std::uint64_t magnitude = 0;
+            auto const result = std::from_chars(first, last, magnitude, base);
+            if (result.ec != std::errc() || result.ptr != last || first == last)
+                return false;
+            auto constexpr max = static_cast<std::uint64_t>(std::numeric_limits<type>::max());
+            if (negative)
+            {
+                if (! std::is_signed<type>::value || magnitude > max + 1)
+                    return false;
+                value = static_cast<type>(0 - magnitude);
+                return true;
+            }
+            if (magnitude > max)
+                return false;
+            value = static_cast<type>(magnitude);
+            return true;
+        }
+
+        // from_chars takes the sign itself in general format, hex needs it stripped along with the prefix
+        auto parse_real(char const * first, char const * last, double & value) noexcept -> bool
+        {
+            bool const negative = first != last && '-' == *first;
+            char const * digits = first + negative;
+            auto format = std::chars_format::general;
+            if (last - digits > 2 && '0' == digits[0] && ('x' == digits[1] || 'X' == digits[1]))
+            {
+                format = std::chars_format::hex;
+                first  = digits + 2;
+            }
+            double result = 0.;
+            auto const status = std::from_chars(first, last, result, format);
+            if (status.ec != std::errc() || status.ptr != last || first == last)
+                return false;
+            value = (std::chars_format::hex == format && negative) ? -result : result;
+            return true;
+        }
+
+        // reads the file straight into the document source buffer
+        auto file_read(char const * path, int & error_code) -> json_data *
+        {
+            json_data * data = nullptr;
+            error_code = JSMN_ERROR_INVAL;
             if (auto stream = std::fopen(path, "rb"))
             {
                 std::fseek(stream, 0, SEEK_END);
                 auto const length = std::ftell(stream);
                 std::fseek(stream, 0, SEEK_SET);
-                contents.resize(length);
-                std::fread(&contents[0], 1, length, stream);
+                if (length >= 0)
+                {
+                    data = json_data_create(static_cast<std::size_t>(length), 0);
+                    if (data)
+                    {
+                        data->length = std::fread(data->source, 1, data->length, stream);
+                        data->source[data->length] = '\0';
+                        error_code = 0;
+                    }
+                    else
+                    {
+                        error_code = JSMN_ERROR_NOMEM;
+                    }
+                }
                 std::fclose(stream);
             }
-            return contents;
+            return data;
         }
     }
 
@@ -216,56 +497,174 @@ namespace idascm
         return from_string(string, string ? std::strlen(string) : 0);
     }
 
-    // static
-    auto json_value::from_string(char const * string, std::size_t length, int * error_code) -> json_value
+    namespace
     {
-        std::size_t capacity = 128;
-        while (true)
+        auto parse_exact(char const * string, std::size_t length, int & error_code) -> json_data *
         {
-            json_data * data = json_data_create(length, capacity);
+            json_data * data = json_data_create(length, 0);
             if (! data)
             {
-                if (error_code)
-                    *error_code = JSMN_ERROR_NOMEM;
-                break;
+                error_code = JSMN_ERROR_NOMEM;
+                return nullptr;
             }
-            std::memcpy(data->source, string, length + 1);
-
-            jsmn_parser parser;
-            jsmn_init(&parser);
-            int result = jsmn_parse(&parser, data->source, data->length, data->tokens, (unsigned int) data->capacity);
-            if (result >= 0)
+            std::memcpy(data->source, string, length);
+            if (! json_data_tokenize(data, error_code))
             {
-                data->count = result;
-                json_value value;
-                value.m_data    = data;
-                value.m_begin   = 0;
-                value.m_end     = data->count;
-                fix_strings(data);
-                if (error_code)
-                    *error_code = 0;
-                return value;
+                json_data_release(data);
+                return nullptr;
             }
-            json_data_release(data);
-            switch (result)
+            return data;
+        }
+
+        // legacy strategy: doubles the pool and starts over until everything fits
+        auto parse_doubling(char const * string, std::size_t length, int & error_code) -> json_data *
+        {
+            std::size_t capacity = 128;
+            while (true)
             {
-                case JSMN_ERROR_NOMEM:
+                json_data * data = json_data_create(length, capacity);
+                if (! data)
+                {
+                    error_code = JSMN_ERROR_NOMEM;
+                    return nullptr;
+                }
+                std::memcpy(data->source, string, length);
+
+                jsmn_parser parser;
+                jsmn_init(&parser);
+                int result = jsmn_parse(&parser, data->source, data->length, data->tokens, (unsigned int) data->capacity);
+                if (result >= 0)
+                {
+                    data->count = result;
+                    error_code  = 0;
+                    return data;
+                }
+                json_data_release(data);
+                if (JSMN_ERROR_NOMEM == result)
+                {
                     capacity <<= 1;
                     continue;
+                }
+                error_code = result;
+                return nullptr;
             }
-            if (error_code)
-                *error_code = result;
-            break;
         }
-        return {};
+    }
+
+    void json_set_tokenizer(json_tokenizer tokenizer) noexcept
+    {
+        g_tokenizer.store(tokenizer, std::memory_order_relaxed);
+    }
+
+    auto json_current_tokenizer(void) noexcept -> json_tokenizer
+    {
+        return g_tokenizer.load(std::memory_order_relaxed);
+    }
+
+    auto json_parse_int64(std::string_view text, std::int64_t & value) noexcept -> bool
+    {
+        return parse_integer(text.data(), text.data() + text.size(), value);
+    }
+
+    auto json_parse_uint64(std::string_view text, std::uint64_t & value) noexcept -> bool
+    {
+        return parse_integer(text.data(), text.data() + text.size(), value);
+    }
+
+    auto json_parse_double(std::string_view text, double & value) noexcept -> bool
+    {
+        return parse_real(text.data(), text.data() + text.size(), value);
+    }
+
+    auto json_parse_bool(std::string_view text, bool & value) noexcept -> bool
+    {
+        if (text == "true")
+        {
+            value = true;
+            return true;
+        }
+        if (text == "false")
+        {
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    auto json_unescape(char * string) noexcept -> std::size_t
+    {
+        return static_cast<std::size_t>(unescape_string(string));
     }
 
     // static
-    // TODO: error handling
-    auto json_value::from_file(char const * path) -> json_value
+    auto json_value::from_string(char const * string, std::size_t length, int * error_code, json_sizing sizing) -> json_value
+    {
+        IDASCM_PROFILE_ZONE("json_value::from_string");
+        int result = 0;
+        json_data * data = nullptr;
+        switch (sizing)
+        {
+            case json_sizing::exact:
+                data = parse_exact(string, length, result);
+                break;
+            case json_sizing::doubling:
+                data = parse_doubling(string, length, result);
+                break;
+        }
+        if (error_code)
+            *error_code = result;
+        return from_data(data);
+    }
+
+    // static
+    auto json_value::from_data(json_data * data) -> json_value
+    {
+        json_value value;
+        if (data)
+        {
+            fix_strings(data);
+            value.m_data    = data;
+            value.m_begin   = 0;
+            value.m_end     = data->count;
+        }
+        return value;
+    }
+
+    // static
+    // tokens point into a private file mapping, the file is only read into memory if it can not be mapped
+    auto json_value::from_file(char const * path, int * error_code) -> json_value
+    {
+        IDASCM_PROFILE_ZONE("json_value::from_file");
+        int result = 0;
+        mapped_file file;
+        json_data * data = nullptr;
+        if (file.open(path, mapped_file::access::copy_on_write))
+            data = json_data_create(static_cast<mapped_file &&>(file));
+        if (! data)
+            data = file_read(path, result);
+        if (data && ! json_data_tokenize(data, result))
+        {
+            json_data_release(data);
+            data = nullptr;
+        }
+        if (error_code)
+            *error_code = result;
+        return from_data(data);
+    }
+
+    auto json_value::memory_usage(void) const -> memory_report
     {
-        auto const contents = file_contents(path);
-        return from_string(contents.c_str(), contents.length());
+        memory_report report;
+        if (! m_data)
+            return report;
+        // header, token pool and (unless mapped) the source copy all live in the arena
+        auto const tokens = m_data->capacity * sizeof(jsmntok_t);
+        auto const source = m_data->mapping.is_open() ? 0 : m_data->length + 1;
+        report.add("tokens", tokens);
+        report.add("source", source);
+        report.add("arena overhead", m_data->memory.capacity() - std::min(m_data->memory.capacity(), tokens + source));
+        report.add("mapping", m_data->mapping.size());
+        return report;
     }
 
     auto json_value::type(void) const noexcept -> json_type
@@ -328,7 +727,7 @@ namespace idascm
         if (m_data != data)
         {
             if (data)
-                ++ data->refs;
+                data->refs.fetch_add(1, std::memory_order_relaxed);
             release();
         }
         m_data  = data;
@@ -383,6 +782,34 @@ namespace idascm
         return nullptr;
     }
 
+    auto json_primitive::to_int64(std::int64_t & value) const noexcept -> bool
+    {
+        char const * first = nullptr;
+        char const * last  = nullptr;
+        return token_span(m_data, m_begin, first, last) && parse_integer(first, last, value);
+    }
+
+    auto json_primitive::to_uint64(std::uint64_t & value) const noexcept -> bool
+    {
+        char const * first = nullptr;
+        char const * last  = nullptr;
+        return token_span(m_data, m_begin, first, last) && parse_integer(first, last, value);
+    }
+
+    auto json_primitive::to_double(double & value) const noexcept -> bool
+    {
+        char const * first = nullptr;
+        char const * last  = nullptr;
+        return token_span(m_data, m_begin, first, last) && parse_real(first, last, value);
+    }
+
+    auto json_primitive::to_bool(bool & value) const noexcept -> bool
+    {
+        char const * first = nullptr;
+        char const * last  = nullptr;
+        return token_span(m_data, m_begin, first, last) && json_parse_bool(std::string_view(first, last - first), value);
+    }
+
     auto json_array::at(std::size_t index) const -> json_value
     {
         // if (index >= size())
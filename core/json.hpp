@@ -1,4 +1,5 @@
 # pragma once
+# include <cstdint>
 # include <string_view>
 
 namespace idascm
@@ -7,6 +8,7 @@ namespace idascm
     class json_object;
     class json_primitive;
     class json_value;
+    class memory_report;
 
     enum class json_type
     {
@@ -16,12 +18,44 @@ namespace idascm
         primitive,
     };
 
+    // token pool sizing strategy
+    enum class json_sizing
+    {
+        exact,      // counting pass, then a single exactly sized token pool
+        doubling,   // start small, grow and re-parse on JSMN_ERROR_NOMEM (jsmn only)
+    };
+
+    // tokenizer backend, process wide
+    enum class json_tokenizer
+    {
+        jsmn,               // byte at a time state machine
+        structural,         // SIMD structural index, best instruction set available
+        structural_scalar,  // structural index, portable block classification
+        structural_sse2,
+        structural_avx2,    // falls back to SSE2 if the CPU lacks AVX2
+    };
+    void json_set_tokenizer(json_tokenizer tokenizer) noexcept;
+    auto json_current_tokenizer(void) noexcept -> json_tokenizer;
+
+    // primitive text conversions shared by json_primitive and json_reader
+    // integers take an optional '-' and an optional "0x" prefix, the whole text must be consumed
+    auto json_parse_int64(std::string_view text, std::int64_t & value) noexcept -> bool;
+    auto json_parse_uint64(std::string_view text, std::uint64_t & value) noexcept -> bool;
+    auto json_parse_double(std::string_view text, double & value) noexcept -> bool;
+    auto json_parse_bool(std::string_view text, bool & value) noexcept -> bool;
+
+    // in place unescaping of a NUL terminated string body, returns the new length
+    auto json_unescape(char * string) noexcept -> std::size_t;
+
+    // a value is a view into a reference counted, read-only document
+    // distinct values sharing one document may be copied, read and destroyed on any threads
+    // concurrently; a single value object is no more thread-safe than an int
     class json_value
     {
         public:
             static auto from_string(char const * string) -> json_value;
-            static auto from_string(char const * string, std::size_t length, int * error_code = nullptr) -> json_value;
-            static auto from_file(char const * path) -> json_value;
+            static auto from_string(char const * string, std::size_t length, int * error_code = nullptr, json_sizing sizing = json_sizing::exact) -> json_value;
+            static auto from_file(char const * path, int * error_code = nullptr) -> json_value;
 
         public:
             auto type(void) const noexcept -> json_type;
@@ -34,6 +68,9 @@ namespace idascm
             auto to_array(void) const -> json_array;
             auto to_object(void) const -> json_object;
 
+            // the whole document behind the value, shared by every value viewing it
+            auto memory_usage(void) const -> memory_report;
+
         public:
             auto operator = (json_value const & other) -> json_value &
             {
@@ -72,6 +109,8 @@ namespace idascm
             }
 
         protected:
+            static auto from_data(struct json_data * data) -> json_value;
+
             void assign(struct json_data * data, std::size_t begin, std::size_t end) noexcept;
             void assign(json_value const & other) noexcept
             {
@@ -97,6 +136,13 @@ namespace idascm
             auto to_string(void) const noexcept -> std::string_view;
             auto c_str(void) const noexcept -> char const *;
 
+            // parsed in place from the token text, "0x" prefix for hex
+            // false (value untouched) if malformed or out of range
+            auto to_int64(std::int64_t & value) const noexcept -> bool;
+            auto to_uint64(std::uint64_t & value) const noexcept -> bool;
+            auto to_double(double & value) const noexcept -> bool;
+            auto to_bool(bool & value) const noexcept -> bool;
+
         public:
             auto operator = (json_primitive const & other) noexcept -> json_primitive &
             {
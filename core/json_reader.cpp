@@ -0,0 +1,243 @@
+# include <core/json_reader.hpp>
+# include <core/mapped_file.hpp>
+# include <cstdio>
+# include <cstring>
+
+namespace idascm
+{
+    namespace
+    {
+        enum : std::uint8_t
+        {
+            frame_array,
+            frame_object_key,       // next string or primitive is a member name
+            frame_object_value,     // member name read, value pending
+        };
+
+        // primitive terminators, same set as jsmn (non-strict)
+        auto is_delimiter(char c) noexcept -> bool
+        {
+            switch (c)
+            {
+                case ' ':
+                case '\t':
+                case '\r':
+                case '\n':
+                case ',':
+                case ':':
+                case ']':
+                case '}':
+                    return true;
+                default:
+                    break;
+            }
+            return false;
+        }
+
+        auto is_hex_digit(char c) noexcept -> bool
+        {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        }
+
+        auto read_whole_file(char const * path, std::vector<char> & buffer) -> bool
+        {
+            auto stream = std::fopen(path, "rb");
+            if (! stream)
+                return false;
+            bool result = false;
+            std::fseek(stream, 0, SEEK_END);
+            auto const length = std::ftell(stream);
+            std::fseek(stream, 0, SEEK_SET);
+            if (length >= 0)
+            {
+                buffer.resize(static_cast<std::size_t>(length));
+                result = std::fread(buffer.data(), 1, buffer.size(), stream) == buffer.size();
+            }
+            std::fclose(stream);
+            return result;
+        }
+    }
+
+    auto json_reader::read(char const * source, std::size_t length, json_handler & handler) -> int
+    {
+        m_stack.clear();
+        m_position = 0;
+        char const * const last = source + length;
+        char const * p = source;
+        auto const fail = [&](int status) -> int
+        {
+            m_position = static_cast<std::size_t>(p - source);
+            return status;
+        };
+        // strings and primitives either name a member or are a value
+        // returns true for a member name and advances the enclosing object state
+        auto const next_is_key = [&](void) -> bool
+        {
+            if (m_stack.empty())
+                return false;
+            auto & frame = m_stack.back();
+            if (frame_object_key == frame)
+            {
+                frame = frame_object_value;
+                return true;
+            }
+            if (frame_object_value == frame)
+                frame = frame_object_key;
+            return false;
+        };
+        while (p != last)
+        {
+            switch (*p)
+            {
+                case ' ':
+                case '\t':
+                case '\r':
+                case '\n':
+                case ',':
+                case ':':
+                {
+                    ++ p;
+                    break;
+                }
+                case '{':
+                case '[':
+                {
+                    if (! m_stack.empty() && frame_object_key == m_stack.back())
+                        return fail(json_read_invalid);
+                    next_is_key();
+                    bool const object = '{' == *p;
+                    m_stack.push_back(object ? frame_object_key : frame_array);
+                    if (! (object ? handler.start_object() : handler.start_array()))
+                        return fail(json_read_aborted);
+                    ++ p;
+                    break;
+                }
+                case '}':
+                {
+                    if (m_stack.empty() || frame_object_key != m_stack.back())
+                        return fail(json_read_invalid);
+                    m_stack.pop_back();
+                    if (! handler.end_object())
+                        return fail(json_read_aborted);
+                    ++ p;
+                    break;
+                }
+                case ']':
+                {
+                    if (m_stack.empty() || frame_array != m_stack.back())
+                        return fail(json_read_invalid);
+                    m_stack.pop_back();
+                    if (! handler.end_array())
+                        return fail(json_read_aborted);
+                    ++ p;
+                    break;
+                }
+                case '"':
+                {
+                    char const * end = nullptr;
+                    std::string_view string;
+                    if (auto const status = read_string(p + 1, last, end, string))
+                        return fail(status);
+                    if (! (next_is_key() ? handler.key(string) : handler.value_string(string)))
+                        return fail(json_read_aborted);
+                    p = end;
+                    break;
+                }
+                default:
+                {
+                    char const * end = p;
+                    while (end != last && ! is_delimiter(*end))
+                    {
+                        auto const c = static_cast<unsigned char>(*end);
+                        if (c < 32 || c >= 127)
+                        {
+                            p = end;
+                            return fail(json_read_invalid);
+                        }
+                        ++ end;
+                    }
+                    auto const text = std::string_view(p, static_cast<std::size_t>(end - p));
+                    if (! (next_is_key() ? handler.key(text) : handler.value_primitive(text)))
+                        return fail(json_read_aborted);
+                    p = end;
+                    break;
+                }
+            }
+        }
+        if (! m_stack.empty())
+            return fail(json_read_partial);
+        return json_read_ok;
+    }
+
+    auto json_reader::read_file(char const * path, json_handler & handler) -> int
+    {
+        mapped_file file;
+        if (file.open(path, mapped_file::access::read))
+            return read(static_cast<char const *>(file.data()), file.size(), handler);
+        // empty files and file systems without mapping support
+        std::vector<char> buffer;
+        if (! read_whole_file(path, buffer))
+            return json_read_nomem;
+        return read(buffer.data(), buffer.size(), handler);
+    }
+
+    // 'first' points past the opening quote, 'end' receives the position past the closing one
+    // strings without escapes are viewed in place, the rest is unescaped into the scratch buffer
+    auto json_reader::read_string(char const * first, char const * last, char const * & end, std::string_view & string) -> int
+    {
+        auto const size = static_cast<std::size_t>(last - first);
+        auto quote = static_cast<char const *>(std::memchr(first, '"', size));
+        if (! quote)
+            return json_read_partial;
+        auto escape = static_cast<char const *>(std::memchr(first, '\\', static_cast<std::size_t>(quote - first)));
+        if (! escape)
+        {
+            string = std::string_view(first, static_cast<std::size_t>(quote - first));
+            end    = quote + 1;
+            return json_read_ok;
+        }
+        // validate escapes and find the real closing quote
+        char const * p = escape;
+        for (;;)
+        {
+            if (p == last)
+                return json_read_partial;
+            if ('"' == *p)
+                break;
+            if ('\\' == *p)
+            {
+                if (++ p == last)
+                    return json_read_partial;
+                switch (*p)
+                {
+                    case '"':
+                    case '/':
+                    case '\\':
+                    case 'b':
+                    case 'f':
+                    case 'r':
+                    case 'n':
+                    case 't':
+                        break;
+                    case 'u':
+                        for (int i = 0; i < 4; ++ i)
+                        {
+                            if (++ p == last)
+                                return json_read_partial;
+                            if (! is_hex_digit(*p))
+                                return json_read_invalid;
+                        }
+                        break;
+                    default:
+                        return json_read_invalid;
+                }
+            }
+            ++ p;
+        }
+        m_scratch.assign(first, p);
+        auto const length = json_unescape(&m_scratch[0]);
+        string = std::string_view(m_scratch.data(), length);
+        end    = p + 1;
+        return json_read_ok;
+    }
+}
@@ -0,0 +1,75 @@
+# pragma once
+# include <core/json.hpp>
+# include <cstdint>
+# include <string>
+# include <string_view>
+# include <vector>
+
+namespace idascm
+{
+    // json_read result codes, negative values match the jsmn error codes
+    enum json_read_status : int
+    {
+        json_read_ok        =  0,
+        json_read_nomem     = -1,   // file could not be mapped
+        json_read_invalid   = -2,   // malformed input
+        json_read_partial   = -3,   // input ended inside a string or container
+        json_read_aborted   = -4,   // handler returned false
+    };
+
+    // event sink for json_reader
+    // every callback returns false to stop reading
+    // string views stay valid until the callback returns (escaped strings live in a scratch buffer)
+    class json_handler
+    {
+        public:
+            virtual auto start_object(void) -> bool { return true; }
+            virtual auto end_object(void) -> bool { return true; }
+            virtual auto start_array(void) -> bool { return true; }
+            virtual auto end_array(void) -> bool { return true; }
+
+            // object member name, the member value follows as the next event
+            virtual auto key(std::string_view key) -> bool { (void) key; return true; }
+
+            // quoted string (unescaped)
+            virtual auto value_string(std::string_view string) -> bool { (void) string; return true; }
+
+            // unquoted primitive text as is (number, true, false, null or anything jsmn would accept)
+            // convert with json_parse_int64 and friends
+            virtual auto value_primitive(std::string_view text) -> bool { (void) text; return true; }
+
+        protected:
+            ~json_handler(void) = default;
+    };
+
+    // single pass event reader, nothing but a small nesting stack is allocated
+    // accepts the same relaxed input as the jsmn based tokenizer (non-strict mode):
+    // separators are optional and trailing commas are fine, primitives need not be quoted
+    class json_reader
+    {
+        public:
+            auto read(char const * source, std::size_t length, json_handler & handler) -> int;
+
+            // maps the file read-only, events point straight into the mapping
+            auto read_file(char const * path, json_handler & handler) -> int;
+
+            // byte offset of the last error
+            auto position(void) const noexcept -> std::size_t
+            {
+                return m_position;
+            }
+
+        public:
+            json_reader(void)
+                : m_position(0)
+            {}
+
+        private:
+            auto read_string(char const * first, char const * last, char const * & end, std::string_view & string) -> int;
+
+        private:
+            std::vector<std::uint8_t>   m_stack;    // open containers
+            std::string                 m_scratch;  // unescaped strings
+            std::size_t                 m_position;
+    };
+}
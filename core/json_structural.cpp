@@ -0,0 +1,475 @@
+# include <core/json_structural.hpp>
+# include <core/core.hpp>
+# include <cstring>
+# if defined _M_X64 || defined __x86_64__
+#   define IDASCM_JSON_X64
+#   include <immintrin.h>
+#   if defined _MSC_VER
+#     include <intrin.h>
+#     define IDASCM_TARGET_AVX2
+#   else
+#     define IDASCM_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+# endif
+
+namespace idascm
+{
+    namespace
+    {
+        constexpr std::size_t   g_block_size    = 64;
+        constexpr std::uint64_t g_odd_bits      = 0xaaaaaaaaaaaaaaaaull;
+
+        // per block character classes, bit N stands for byte N
+        struct block_masks
+        {
+            std::uint64_t   quote;      // "
+            std::uint64_t   backslash;  // \ (escape)
+            std::uint64_t   open;       // { [
+            std::uint64_t   close;      // } ]
+            std::uint64_t   separator;  // : ,
+            std::uint64_t   space;      // ' ' \t \r \n
+        };
+
+        auto count_bits(std::uint64_t value) noexcept -> int
+        {
+# if defined _MSC_VER && defined IDASCM_JSON_X64
+            return static_cast<int>(__popcnt64(value));
+# elif defined __GNUC__
+            return __builtin_popcountll(value);
+# else
+            int count = 0;
+            for (; value; value &= value - 1)
+                ++ count;
+            return count;
+# endif
+        }
+
+        auto lowest_bit(std::uint64_t value) noexcept -> unsigned
+        {
+# if defined _MSC_VER && defined IDASCM_JSON_X64
+            unsigned long index;
+            _BitScanForward64(&index, value);
+            return index;
+# elif defined __GNUC__
+            return static_cast<unsigned>(__builtin_ctzll(value));
+# else
+            unsigned index = 0;
+            while (! (value & 1))
+            {
+                value >>= 1;
+                ++ index;
+            }
+            return index;
+# endif
+        }
+
+        // bit N = xor of bits [0..N]
+        auto prefix_xor(std::uint64_t value) noexcept -> std::uint64_t
+        {
+            value ^= value << 1;
+            value ^= value << 2;
+            value ^= value << 4;
+            value ^= value << 8;
+            value ^= value << 16;
+            value ^= value << 32;
+            return value;
+        }
+
+        void classify_scalar(char const * block, block_masks & masks) noexcept
+        {
+            masks = {};
+            for (std::size_t i = 0; i < g_block_size; ++ i)
+            {
+                std::uint64_t const bit = std::uint64_t(1) << i;
+                switch (block[i])
+                {
+                    case '"':
+                        masks.quote |= bit;
+                        break;
+                    case '\\':
+                        masks.backslash |= bit;
+                        break;
+                    case '{':
+                    case '[':
+                        masks.open |= bit;
+                        break;
+                    case '}':
+                    case ']':
+                        masks.close |= bit;
+                        break;
+                    case ':':
+                    case ',':
+                        masks.separator |= bit;
+                        break;
+                    case ' ':
+                    case '\t':
+                    case '\r':
+                    case '\n':
+                        masks.space |= bit;
+                        break;
+                }
+            }
+        }
+
+# if defined IDASCM_JSON_X64
+        // '[' | 0x20 == '{' and ']' | 0x20 == '}', so brackets need a single compare each
+        void classify_sse2(char const * block, block_masks & masks) noexcept
+        {
+            masks = {};
+            __m128i const quote     = _mm_set1_epi8('"');
+            __m128i const backslash = _mm_set1_epi8('\\');
+            __m128i const lower     = _mm_set1_epi8(0x20);
+            __m128i const open      = _mm_set1_epi8('{');
+            __m128i const close     = _mm_set1_epi8('}');
+            __m128i const colon     = _mm_set1_epi8(':');
+            __m128i const comma     = _mm_set1_epi8(',');
+            __m128i const space     = _mm_set1_epi8(' ');
+            __m128i const tab       = _mm_set1_epi8('\t');
+            __m128i const cr        = _mm_set1_epi8('\r');
+            __m128i const lf        = _mm_set1_epi8('\n');
+            for (std::size_t i = 0; i < g_block_size; i += 16)
+            {
+                __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(block + i));
+                __m128i const l = _mm_or_si128(v, lower);
+                auto const mask = [i](__m128i const & m) -> std::uint64_t
+                {
+                    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(m))) << i;
+                };
+                masks.quote     |= mask(_mm_cmpeq_epi8(v, quote));
+                masks.backslash |= mask(_mm_cmpeq_epi8(v, backslash));
+                masks.open      |= mask(_mm_cmpeq_epi8(l, open));
+                masks.close     |= mask(_mm_cmpeq_epi8(l, close));
+                masks.separator |= mask(_mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+                masks.space     |= mask(_mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf))
+                ));
+            }
+        }
+
+        IDASCM_TARGET_AVX2
+        void classify_avx2(char const * block, block_masks & masks) noexcept
+        {
+            masks = {};
+            __m256i const quote     = _mm256_set1_epi8('"');
+            __m256i const backslash = _mm256_set1_epi8('\\');
+            __m256i const lower     = _mm256_set1_epi8(0x20);
+            __m256i const open      = _mm256_set1_epi8('{');
+            __m256i const close     = _mm256_set1_epi8('}');
+            __m256i const colon     = _mm256_set1_epi8(':');
+            __m256i const comma     = _mm256_set1_epi8(',');
+            __m256i const space     = _mm256_set1_epi8(' ');
+            __m256i const tab       = _mm256_set1_epi8('\t');
+            __m256i const cr        = _mm256_set1_epi8('\r');
+            __m256i const lf        = _mm256_set1_epi8('\n');
+            for (std::size_t i = 0; i < g_block_size; i += 32)
+            {
+                // no lambda here: it would not inherit the avx2 target
+                __m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(block + i));
+                __m256i const l = _mm256_or_si256(v, lower);
+                __m256i const s = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf))
+                );
+                __m256i const p = _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma));
+                masks.quote     |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << i;
+                masks.backslash |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)))) << i;
+                masks.open      |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, open)))) << i;
+                masks.close     |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, close)))) << i;
+                masks.separator |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(p))) << i;
+                masks.space     |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(s))) << i;
+            }
+        }
+# endif
+
+        using classify_function = void (*)(char const *, block_masks &) noexcept;
+
+        auto classifier(json_tokenizer isa) noexcept -> classify_function
+        {
+            switch (isa)
+            {
+# if defined IDASCM_JSON_X64
+                case json_tokenizer::structural_avx2:
+                    return classify_avx2;
+                case json_tokenizer::structural_sse2:
+                    return classify_sse2;
+# endif
+                default:
+                    return classify_scalar;
+            }
+        }
+
+        // jsmn (non-strict) primitive terminators, quotes and opening brackets are part of a primitive
+        auto is_primitive_end(unsigned char c) noexcept -> bool
+        {
+            switch (c)
+            {
+                case '\0':
+                case ':':
+                case ',':
+                case ']':
+                case '}':
+                case ' ':
+                case '\t':
+                case '\r':
+                case '\n':
+                    return true;
+            }
+            return false;
+        }
+
+        auto is_hex(char c) noexcept -> bool
+        {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        }
+
+        // escapes jsmn accepts: \" \/ \\ \b \f \r \n \t and \u with four hex digits
+        auto is_valid_escape(char const * source, std::size_t length, std::size_t position) noexcept -> bool
+        {
+            if (position >= length)
+                return false;
+            switch (source[position])
+            {
+                case '"':
+                case '/':
+                case '\\':
+                case 'b':
+                case 'f':
+                case 'r':
+                case 'n':
+                case 't':
+                    return true;
+                case 'u':
+                    if (length - position <= 4)
+                        return false;
+                    for (std::size_t i = 1; i <= 4; ++ i)
+                    {
+                        if (! is_hex(source[position + i]))
+                            return false;
+                    }
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    auto json_resolve_tokenizer(json_tokenizer tokenizer) noexcept -> json_tokenizer
+    {
+# if defined IDASCM_JSON_X64
+        static bool const s_avx2 = cpu_supports_avx2();
+        switch (tokenizer)
+        {
+            case json_tokenizer::structural:
+            case json_tokenizer::structural_avx2:
+                return s_avx2 ? json_tokenizer::structural_avx2 : json_tokenizer::structural_sse2;
+            default:
+                return tokenizer;
+        }
+# else
+        switch (tokenizer)
+        {
+            case json_tokenizer::jsmn:
+                return tokenizer;
+            default:
+                return json_tokenizer::structural_scalar;
+        }
+# endif
+    }
+
+    auto json_structural_index::build(char const * source, std::size_t length, json_tokenizer isa) -> int
+    {
+        m_source = source;
+        m_length = length;
+        m_index.clear();
+        if (length > 0x7fffffff) // token offsets are int
+            return JSMN_ERROR_NOMEM;
+        // jsmn stops at the first NUL
+        if (std::memchr(source, '\0', length))
+            return json_structural_unsupported;
+        m_index.resize(length / 4 + g_block_size);
+        std::size_t used = 0;
+
+        auto const classify = classifier(json_resolve_tokenizer(isa));
+
+        std::uint64_t next_is_escaped   = 0;
+        std::uint64_t prev_in_string    = 0;
+        std::uint64_t prev_scalar       = 0;
+        std::size_t   container_count   = 0;
+        std::size_t   quote_count       = 0;
+        std::size_t   primitive_count   = 0;
+        for (std::size_t base = 0; base < length; base += g_block_size)
+        {
+            char tail[g_block_size];
+            char const * block = source + base;
+            if (length - base < g_block_size)
+            {
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, block, length - base);
+                block = tail;
+            }
+            block_masks masks;
+            classify(block, masks);
+
+            // characters preceded by an odd backslash run
+            std::uint64_t escaped = next_is_escaped;
+            if (masks.backslash)
+            {
+                std::uint64_t const potential   = masks.backslash & ~next_is_escaped;
+                std::uint64_t const code        = (((potential << 1) | g_odd_bits) - potential) ^ g_odd_bits;
+                escaped                         = code ^ (masks.backslash | next_is_escaped);
+                next_is_escaped                 = (code & masks.backslash) >> 63;
+            }
+            else
+            {
+                next_is_escaped = 0;
+            }
+
+            // in_string covers opening quote and contents, not the closing quote
+            std::uint64_t const quote       = masks.quote & ~escaped;
+            std::uint64_t const in_string   = prefix_xor(quote) ^ prev_in_string;
+            prev_in_string = static_cast<std::uint64_t>(static_cast<std::int64_t>(in_string) >> 63);
+
+            std::uint64_t const scalar      = ~(masks.open | masks.close | masks.separator | masks.space | masks.quote | in_string);
+            std::uint64_t const after       = (scalar << 1) | prev_scalar;  // preceded by a primitive character
+            std::uint64_t const primitive   = scalar & ~after;
+            prev_scalar = scalar >> 63;
+
+            std::uint64_t const open        = masks.open & ~in_string;
+
+            // jsmn reads a quote or an opening bracket glued to a primitive as part of it,
+            // and backslashes outside strings as primitive characters
+            if (((quote | open) & after) || (masks.backslash & ~in_string))
+                return json_structural_unsupported;
+            for (std::uint64_t bits = escaped & in_string; bits; bits &= bits - 1)
+            {
+                if (! is_valid_escape(source, length, base + lowest_bit(bits)))
+                    return json_structural_unsupported;
+            }
+            std::uint64_t structural        = open | ((masks.close | masks.separator) & ~in_string) | quote | primitive;
+
+            container_count += count_bits(open);
+            quote_count     += count_bits(quote);
+            primitive_count += count_bits(primitive);
+            // room for a whole block, so the extraction loop has no bounds checks
+            if (used + g_block_size > m_index.size())
+                m_index.resize(m_index.size() * 2);
+            std::uint32_t * out = m_index.data() + used;
+            int const count = count_bits(structural);
+            for (int i = 0; i < count; ++ i)
+            {
+                out[i] = static_cast<std::uint32_t>(base + lowest_bit(structural));
+                structural &= structural - 1;
+            }
+            used += count;
+        }
+        m_index.resize(used);
+        if (quote_count & 1)
+            return JSMN_ERROR_PART;
+        return static_cast<int>(container_count + quote_count / 2 + primitive_count);
+    }
+
+    auto json_structural_index::tokenize(jsmntok_t * tokens, std::size_t capacity) const -> int
+    {
+        int         next    = 0;
+        int         super   = -1;
+        std::size_t open    = 0;
+        auto const alloc = [&](jsmntype_t type, int start, int end) -> jsmntok_t *
+        {
+            if (static_cast<std::size_t>(next) >= capacity)
+                return nullptr;
+            auto const token = &tokens[next ++];
+            token->type     = type;
+            token->start    = start;
+            token->end      = end;
+            token->size     = 0;
+            token->parent   = super;
+            if (super != -1)
+                tokens[super].size ++;
+            return token;
+        };
+
+        for (std::size_t i = 0; i < m_index.size(); ++ i)
+        {
+            int const pos = static_cast<int>(m_index[i]);
+            switch (m_source[pos])
+            {
+                case '{':
+                case '[':
+                {
+                    if (! alloc(m_source[pos] == '{' ? JSMN_OBJECT : JSMN_ARRAY, pos, -1))
+                        return JSMN_ERROR_NOMEM;
+                    super = next - 1;
+                    ++ open;
+                    break;
+                }
+                case '}':
+                case ']':
+                {
+                    auto const type = m_source[pos] == '}' ? JSMN_OBJECT : JSMN_ARRAY;
+                    if (next < 1)
+                        return JSMN_ERROR_INVAL;
+                    jsmntok_t * token = &tokens[next - 1];
+                    while (true)
+                    {
+                        if (token->start != -1 && token->end == -1)
+                        {
+                            if (token->type != type)
+                                return JSMN_ERROR_INVAL;
+                            token->end  = pos + 1;
+                            super       = token->parent;
+                            -- open;
+                            break;
+                        }
+                        if (token->parent == -1)
+                        {
+                            if (token->type != type || super == -1)
+                                return JSMN_ERROR_INVAL;
+                            break;
+                        }
+                        token = &tokens[token->parent];
+                    }
+                    break;
+                }
+                case ':':
+                {
+                    super = next - 1;
+                    break;
+                }
+                case ',':
+                {
+                    if (super != -1 && tokens[super].type != JSMN_ARRAY && tokens[super].type != JSMN_OBJECT)
+                        super = tokens[super].parent;
+                    break;
+                }
+                case '"':
+                {
+                    // closing quote always follows, everything in between is masked out
+                    if (i + 1 >= m_index.size())
+                        return JSMN_ERROR_PART;
+                    int const end = static_cast<int>(m_index[++ i]);
+                    if (! alloc(JSMN_STRING, pos + 1, end))
+                        return JSMN_ERROR_NOMEM;
+                    break;
+                }
+                default:
+                {
+                    int end = pos;
+                    for (; static_cast<std::size_t>(end) < m_length; ++ end)
+                    {
+                        auto const c = static_cast<unsigned char>(m_source[end]);
+                        if (is_primitive_end(c))
+                            break;
+                        if (c < 32 || c >= 127)
+                            return JSMN_ERROR_INVAL;
+                    }
+                    if (! alloc(JSMN_PRIMITIVE, pos, end))
+                        return JSMN_ERROR_NOMEM;
+                    break;
+                }
+            }
+        }
+        if (open)
+            return JSMN_ERROR_PART;
+        return next;
+    }
+}
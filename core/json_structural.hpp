@@ -0,0 +1,43 @@
+# pragma once
+# include <core/json.hpp>
+# include <core/json_token.hpp>
+# include <cstdint>
+# include <vector>
+
+namespace idascm
+{
+    // build() result for input the index does not model, jsmn has to tokenize it:
+    // NUL bytes, escapes jsmn rejects, quotes or brackets glued to a primitive,
+    // backslashes outside strings
+    constexpr int json_structural_unsupported = -100;
+
+    // two stage tokenizer for the input jsmn (non-strict, parent links) reads as plain JSON
+    // stage 1 classifies 64 byte blocks with SIMD compares and collects positions of
+    // brackets, separators, unescaped quotes and primitive starts outside of strings
+    // stage 2 walks that index and fills the token pool
+    // whenever both stages succeed the tokens are jsmn's, errors are not guaranteed to be
+    // the ones jsmn reports: callers run jsmn on any failure (see json_data_tokenize)
+    class json_structural_index
+    {
+        public:
+            // stage 1, returns exact token count, json_structural_unsupported or a jsmn error code
+            auto build(char const * source, std::size_t length, json_tokenizer isa) -> int;
+
+            // stage 2, returns token count or jsmn error code
+            auto tokenize(jsmntok_t * tokens, std::size_t capacity) const -> int;
+
+        public:
+            json_structural_index(void)
+                : m_source(nullptr)
+                , m_length(0)
+            {}
+
+        private:
+            char const *                m_source;
+            std::size_t                 m_length;
+            std::vector<std::uint32_t>  m_index;
+    };
+
+    // instruction set actually used for the requested tokenizer on this machine
+    auto json_resolve_tokenizer(json_tokenizer tokenizer) noexcept -> json_tokenizer;
+}
@@ -0,0 +1,8 @@
+# pragma once
+// jsmn token model shared by the json tokenizers
+// the jsmn implementation itself is compiled into json.cpp only (IDASCM_JSMN_IMPLEMENTATION)
+# define JSMN_PARENT_LINKS // closing brackets walk parents instead of rescanning the pool
+# if ! defined IDASCM_JSMN_IMPLEMENTATION
+#   define JSMN_HEADER
+# endif
+# include <3rd-party/jsmn/jsmn.h>
@@ -0,0 +1,257 @@
+# include <core/json_writer.hpp>
+# include <algorithm>
+# include <cassert>
+# include <charconv>
+# include <cmath>
+# include <cstring>
+
+namespace idascm
+{
+    namespace
+    {
+        // 0 - as is, otherwise the short escape character ('u' - \u00XX form)
+        char const g_escape_table[256] = \
+        {
+            'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+            'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+            0,   0,   '"', 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+            0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+            0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+            0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   '\\',0,   0,   0,
+        };
+
+        char const g_hex_digits[] = "0123456789abcdef";
+    }
+
+    json_writer::json_writer(unsigned indent)
+        : m_file(nullptr)
+        , m_data(nullptr)
+        , m_capacity(0)
+        , m_used(0)
+        , m_indent(indent)
+        , m_depth(0)
+        , m_separator(false)
+        , m_key(false)
+        , m_failed(false)
+    {}
+
+    json_writer::json_writer(std::FILE * file, unsigned indent, std::size_t buffer_size)
+        : m_file(file)
+        , m_buffer(new char[buffer_size ? buffer_size : 1])
+        , m_data(m_buffer.get())
+        , m_capacity(buffer_size ? buffer_size : 1)
+        , m_used(0)
+        , m_indent(indent)
+        , m_depth(0)
+        , m_separator(false)
+        , m_key(false)
+        , m_failed(! file)
+    {}
+
+    json_writer::~json_writer(void) noexcept
+    {
+        flush();
+    }
+
+    void json_writer::begin_object(void)
+    {
+        open('{');
+    }
+
+    void json_writer::end_object(void)
+    {
+        close('}');
+    }
+
+    void json_writer::begin_array(void)
+    {
+        open('[');
+    }
+
+    void json_writer::end_array(void)
+    {
+        close(']');
+    }
+
+    void json_writer::key(std::string_view key)
+    {
+        separate();
+        write_escaped(key);
+        write(':');
+        if (m_indent)
+            write(' ');
+        m_key = true;
+    }
+
+    void json_writer::value_string(std::string_view string)
+    {
+        separate();
+        write_escaped(string);
+        m_separator = true;
+    }
+
+    void json_writer::value_int64(std::int64_t value)
+    {
+        separate();
+        char buffer[24];
+        auto const result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        write(buffer, result.ptr - buffer);
+        m_separator = true;
+    }
+
+    void json_writer::value_uint64(std::uint64_t value)
+    {
+        separate();
+        char buffer[24];
+        auto const result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        write(buffer, result.ptr - buffer);
+        m_separator = true;
+    }
+
+    void json_writer::value_double(double value)
+    {
+        if (! std::isfinite(value))
+        {
+            value_null();
+            return;
+        }
+        separate();
+        char buffer[32];
+        auto const result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        write(buffer, result.ptr - buffer);
+        m_separator = true;
+    }
+
+    void json_writer::value_bool(bool value)
+    {
+        separate();
+        if (value)
+            write("true", 4);
+        else
+            write("false", 5);
+        m_separator = true;
+    }
+
+    void json_writer::value_null(void)
+    {
+        separate();
+        write("null", 4);
+        m_separator = true;
+    }
+
+    auto json_writer::flush(void) -> bool
+    {
+        if (m_file && m_used)
+        {
+            if (std::fwrite(m_data, 1, m_used, m_file) != m_used)
+                m_failed = true;
+            m_used = 0;
+        }
+        return ! m_failed;
+    }
+
+    void json_writer::clear(void) noexcept
+    {
+        m_used      = 0;
+        m_depth     = 0;
+        m_separator = false;
+        m_key       = false;
+    }
+
+    void json_writer::open(char bracket)
+    {
+        separate();
+        write(bracket);
+        ++ m_depth;
+        m_separator = false;
+    }
+
+    void json_writer::close(char bracket)
+    {
+        assert(m_depth);
+        -- m_depth;
+        // non-empty containers close on their own line
+        if (m_separator)
+            newline();
+        write(bracket);
+        m_separator = true;
+    }
+
+    // every container element goes on its own line, values following a key stay on the key line
+    void json_writer::separate(void)
+    {
+        if (m_key)
+        {
+            m_key = false;
+            return;
+        }
+        if (m_separator)
+            write(',');
+        if (m_depth)
+            newline();
+    }
+
+    void json_writer::newline(void)
+    {
+        if (! m_indent)
+            return;
+        write('\n');
+        for (unsigned i = 0; i < m_depth * m_indent; ++ i)
+            write(' ');
+    }
+
+    // makes room for 'size' more bytes: memory output grows, file output drains
+    auto json_writer::reserve(std::size_t size) -> bool
+    {
+        if (m_file)
+        {
+            flush();
+            return size <= m_capacity;
+        }
+        m_capacity = std::max<std::size_t>(m_used + size, std::max<std::size_t>(m_capacity * 2, 4096));
+        m_memory.resize(m_capacity);
+        m_data = &m_memory[0];
+        return true;
+    }
+
+    void json_writer::write(char const * data, std::size_t size)
+    {
+        if (m_used + size > m_capacity && ! reserve(size))
+        {
+            // larger than the whole staging buffer - straight to the file
+            if (std::fwrite(data, 1, size, m_file) != size)
+                m_failed = true;
+            return;
+        }
+        std::memcpy(m_data + m_used, data, size);
+        m_used += size;
+    }
+
+    // copies runs of plain characters in one go
+    void json_writer::write_escaped(std::string_view string)
+    {
+        write('"');
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < string.size(); ++ i)
+        {
+            auto const c = static_cast<unsigned char>(string[i]);
+            auto const escape = g_escape_table[c];
+            if (! escape)
+                continue;
+            write(string.data() + run, i - run);
+            run = i + 1;
+            if ('u' == escape)
+            {
+                char const sequence[] = { '\\', 'u', '0', '0', g_hex_digits[c >> 4], g_hex_digits[c & 0xf] };
+                write(sequence, sizeof(sequence));
+            }
+            else
+            {
+                char const sequence[] = { '\\', escape };
+                write(sequence, sizeof(sequence));
+            }
+        }
+        write(string.data() + run, string.size() - run);
+        write('"');
+    }
+}
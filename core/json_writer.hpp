@@ -0,0 +1,87 @@
+# pragma once
+# include <cstdint>
+# include <cstdio>
+# include <memory>
+# include <string>
+# include <string_view>
+
+namespace idascm
+{
+    // streaming JSON emitter
+    // writes either into a growable memory buffer or, through a fixed size buffer, into a FILE *
+    // separators are tracked with two flags, so nesting depth costs nothing
+    class json_writer
+    {
+        public:
+            void begin_object(void);
+            void end_object(void);
+            void begin_array(void);
+            void end_array(void);
+
+            void key(std::string_view key);
+
+            void value_string(std::string_view string);
+            void value_int64(std::int64_t value);
+            void value_uint64(std::uint64_t value);
+            void value_double(double value); // shortest round-trip, non-finite values become null
+            void value_bool(bool value);
+            void value_null(void);
+
+            // flushes buffered output to the file (no-op for memory output)
+            auto flush(void) -> bool;
+
+            // false once a file write failed
+            auto good(void) const noexcept -> bool
+            {
+                return ! m_failed;
+            }
+
+            // memory output only
+            auto buffer(void) const noexcept -> std::string_view
+            {
+                return std::string_view(m_data, m_used);
+            }
+
+            void clear(void) noexcept;
+
+        public:
+            // memory output, 'indent' spaces per level (0 - compact)
+            explicit json_writer(unsigned indent = 0);
+
+            // file output, the file is not closed
+            explicit json_writer(std::FILE * file, unsigned indent = 0, std::size_t buffer_size = 1 << 20);
+
+            ~json_writer(void) noexcept;
+
+        private:
+            json_writer(json_writer const &) = delete;
+            auto operator = (json_writer const &) -> json_writer & = delete;
+
+        private:
+            void open(char bracket);
+            void close(char bracket);
+            void separate(void);
+            void newline(void);
+            auto reserve(std::size_t size) -> bool;
+            void write(char const * data, std::size_t size);
+            void write(char c)
+            {
+                if (m_used < m_capacity || reserve(1))
+                    m_data[m_used ++] = c;
+            }
+            void write_escaped(std::string_view string);
+
+        private:
+            std::FILE *             m_file;
+            std::unique_ptr<char[]> m_buffer;       // file output staging
+            std::string             m_memory;       // memory output
+            char *                  m_data;         // one of the above
+            std::size_t             m_capacity;
+            std::size_t             m_used;
+            unsigned                m_indent;
+            unsigned                m_depth;
+            bool                    m_separator;    // next value needs a ','
+            bool                    m_key;          // key written, value pending
+            bool                    m_failed;
+    };
+}
@@ -1,7 +1,16 @@
 # include <core/logger.hpp>
+# include <core/logger_trace.hpp>
 # include <algorithm>
+# include <chrono>
+# include <condition_variable>
 # include <cstdarg>
 # include <cstdio>
+# include <cstring>
+# include <iterator>
+# include <memory>
+# include <string>
+# include <thread>
+# include <vector>
 # if defined IDASCM_PLATFORM_WINDOWS
 #   include <windows.h>
 # endif
@@ -20,6 +29,18 @@ namespace idascm
             "trace",
         };
 
+        char const * const g_subsystem_table[] = \
+        {
+            "general",
+            "json",
+            "isa",
+            "decoder",
+            "analyzer",
+            "emulator",
+            "output",
+            "module",
+        };
+
         char const * const g_prefix_table[] = \
         {
             nullptr,
@@ -50,6 +71,19 @@ namespace idascm
         };
 # endif
 
+        // formats into 'message', always newline and NUL terminated
+        // returns the length of the whole text, longer than 'size' - 2 if it was cut
+        template <std::size_t size>
+        auto format_message(char (&message)[size], char const * format, va_list args) -> int
+        {
+            int const whole = std::vsnprintf(message, size - 1, format, args);
+            int length = std::max(0, std::min(whole, static_cast<int>(size) - 2));
+            if (length && message[length - 1] != '\n')
+                message[length++] = '\n';
+            message[length] = '\0';
+            return whole;
+        }
+
         class file_handler : public logger::handler
         {
             public:
@@ -81,6 +115,206 @@ namespace idascm
         };
     }
 
+    // bounded multi-producer single-consumer ring (sequence numbered slots)
+    // a slot is free for position p when its sequence is p and readable when it is p + 1
+    struct logger_queue
+    {
+        struct slot
+        {
+            std::atomic<std::size_t>    sequence;
+            logger::context             context;
+            char                        message[1024];
+        };
+
+        std::unique_ptr<slot[]>         slots;
+        std::size_t                     mask;
+        logger::overflow                policy;
+        alignas(64)
+        std::atomic<std::size_t>        tail;           // next position to claim, producers
+        alignas(64)
+        std::atomic<std::size_t>        head;           // next position to dispatch, consumer
+        std::atomic<std::uint64_t>      dropped;
+        std::atomic<bool>               running;
+        std::atomic<bool>               sleeping;       // consumer is (about to be) waiting on 'wake'
+        std::mutex                      mutex;
+        std::condition_variable         wake;           // consumer
+        std::condition_variable         progress;       // flush waiters
+        std::thread                     thread;
+
+        // claims a slot or returns nullptr (drop policy, ring full)
+        auto claim(std::size_t & position) -> slot *
+        {
+            position = tail.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                auto & s = slots[position & mask];
+                auto const sequence = s.sequence.load(std::memory_order_acquire);
+                auto const diff = static_cast<std::ptrdiff_t>(sequence - position);
+                if (0 == diff)
+                {
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        return &s;
+                }
+                else if (diff < 0)
+                {
+                    if (logger::overflow::drop == policy)
+                    {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return nullptr;
+                    }
+                    notify();
+                    std::this_thread::yield();
+                    position = tail.load(std::memory_order_relaxed);
+                }
+                else
+                {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void publish(slot & s, std::size_t position)
+        {
+            s.sequence.store(position + 1, std::memory_order_release);
+            if (sleeping.load(std::memory_order_seq_cst))
+                notify();
+        }
+
+        void notify(void)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            wake.notify_one();
+        }
+
+        void run(logger & owner)
+        {
+            auto position = head.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                auto & s = slots[position & mask];
+                if (s.sequence.load(std::memory_order_acquire) == position + 1)
+                {
+                    owner.dispatch(s.context, s.message);
+                    s.sequence.store(position + mask + 1, std::memory_order_release);
+                    head.store(++ position, std::memory_order_release);
+                    continue;
+                }
+                // drained (or the next slot is still being written)
+                std::unique_lock<std::mutex> lock(mutex);
+                progress.notify_all();
+                if (! running.load(std::memory_order_acquire) && tail.load(std::memory_order_acquire) == position)
+                    break;
+                sleeping.store(true, std::memory_order_seq_cst);
+                // the timeout covers a producer that published between the check above and the wait
+                wake.wait_for(lock, std::chrono::milliseconds(10), [&s, position, this]
+                {
+                    return s.sequence.load(std::memory_order_acquire) == position + 1 || ! running.load(std::memory_order_acquire);
+                });
+                sleeping.store(false, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // trace records on their way to the file
+    struct logger_trace_buffer
+    {
+        std::vector<char> bytes;
+
+        void put(void const * data, std::size_t size)
+        {
+            auto const first = static_cast<char const *>(data);
+            bytes.insert(bytes.end(), first, first + size);
+        }
+
+        template <typename type>
+        void put(type value)
+        {
+            put(&value, sizeof(value));
+        }
+
+        void put_string(char const * string, std::size_t length)
+        {
+            put(static_cast<std::uint32_t>(length));
+            put(string, length);
+        }
+    };
+
+    // binary trace session: every thread stages its message records in its own buffer and
+    // hands them over in blocks, the lock is only taken for new call sites and for writing
+    struct logger_trace
+    {
+        static std::size_t const stage_size = 64 * 1024;
+
+        std::FILE *                             file;
+        std::mutex                              mutex;      // file, sites, stages, site_count
+        logger_trace_buffer                     sites;      // header and site records
+        std::vector<std::unique_ptr<logger_trace_buffer>> stages;
+        std::uint32_t                           session;
+        std::uint32_t                           site_count;
+        std::chrono::steady_clock::time_point   start;
+
+        void write(logger_trace_buffer & buffer)
+        {
+            if (! buffer.bytes.empty())
+                std::fwrite(buffer.bytes.data(), 1, buffer.bytes.size(), file);
+            buffer.bytes.clear();
+        }
+
+        // under 'mutex', the sites go first: every site a stage refers to is registered by then
+        void drain(logger_trace_buffer & stage)
+        {
+            write(sites);
+            write(stage);
+        }
+    };
+
+    namespace
+    {
+        auto clock_ms(void) -> std::int64_t
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // small per-thread number for trace records
+        auto current_thread_index(void) -> std::uint32_t
+        {
+            static std::atomic<std::uint32_t> counter { 0 };
+            thread_local std::uint32_t const index = ++ counter;
+            return index;
+        }
+
+        // counts the calling thread as a user of the object a 'users' counter guards
+        // whoever clears the guarded pointer waits for the count to drop before releasing the object
+        class user_scope
+        {
+            public:
+                explicit user_scope(std::atomic<std::size_t> & users) noexcept
+                    : m_users(users)
+                {
+                    m_users.fetch_add(1, std::memory_order_seq_cst);
+                }
+
+                ~user_scope(void) noexcept
+                {
+                    m_users.fetch_sub(1, std::memory_order_release);
+                }
+
+            private:
+                user_scope(user_scope const &) = delete;
+                auto operator = (user_scope const &) -> user_scope & = delete;
+
+            private:
+                std::atomic<std::size_t> & m_users;
+        };
+
+        // after the guarded pointer was cleared: no thread can still hold it once the count is 0
+        void wait_users(std::atomic<std::size_t> const & users) noexcept
+        {
+            while (users.load(std::memory_order_seq_cst))
+                std::this_thread::yield();
+        }
+    }
+
     logger & logger::instance(void)
     {
         static logger instance;
@@ -88,8 +322,17 @@ namespace idascm
     }
 
     logger::logger(void)
-        : m_level(level::info)
+        : m_queue(nullptr)
+        , m_queue_users(0)
+        , m_trace(nullptr)
+        , m_trace_users(0)
+        , m_burst(16)
+        , m_window(1000)
+        , m_summary_interval(5000)
+        , m_summary_time(clock_ms())
+        , m_suppressed(nullptr)
     {
+        set_level(level::info);
         std::memset(m_handlers, 0, sizeof(m_handlers));
 # if defined IDASCM_BUILD_DEBUG
         static file_handler file;
@@ -102,12 +345,16 @@ namespace idascm
 # endif
     }
 
+    // suppressed counts are not flushed here, handlers may already be gone at static destruction
     logger::~logger(void)
     {
+        stop_trace();
+        stop_async();
     }
 
     auto logger::add_handler(handler * handler) -> bool
     {
+        std::lock_guard<std::mutex> lock(m_handler_mutex);
         for (std::size_t i = 0; i < std::size(m_handlers); ++ i)
         {
             if (m_handlers[i])
@@ -120,6 +367,7 @@ namespace idascm
 
     auto logger::remove_handler(handler * handler) -> bool
     {
+        std::lock_guard<std::mutex> lock(m_handler_mutex);
         for (std::size_t i = 0; i < std::size(m_handlers); ++ i)
         {
             if (m_handlers[i] != handler)
@@ -132,26 +380,78 @@ namespace idascm
 
     void logger::add_message(level level, char const * file, int line, char const * function, char const * format, ...)
     {
-        if (level > m_level)
+        if (level > current_level())
             return;
-        char message[1024] = { 0 };
-        va_list args;
-        va_start(args, format);
-        int length = std::vsnprintf(message, sizeof(message) - 1, format, args);
-        va_end(args);
-        if (length && message[length - 1] != '\n')
-        {
-            message[length++] = '\n';
-            message[length++] = '\0';
-        }
-        
         context const ctx = \
         {
             level,
             file,
             line,
-            function
+            function,
+            subsystem::general,
+        };
+        va_list args;
+        va_start(args, format);
+        vmessage(ctx, format, args);
+        va_end(args);
+    }
+
+    void logger::message(site const & site, char const * format, ...)
+    {
+        context const ctx = \
+        {
+            site.level,
+            site.file,
+            site.line,
+            site.function,
+            site.subsystem,
         };
+        va_list args;
+        va_start(args, format);
+        vmessage(ctx, format, args);
+        va_end(args);
+    }
+
+    void logger::vmessage(context const & ctx, char const * format, va_list args)
+    {
+        // messages logged by handlers themselves bypass the ring
+        {
+            user_scope scope(m_queue_users);
+            auto const queue = m_queue.load(std::memory_order_seq_cst);
+            if (queue && std::this_thread::get_id() != queue->thread.get_id())
+            {
+                std::size_t position = 0;
+                if (auto slot = queue->claim(position))
+                {
+                    slot->context = ctx;
+                    format_message(slot->message, format, args);
+                    queue->publish(*slot, position);
+                }
+                return;
+            }
+        }
+        // text longer than the buffer (a profiler summary) goes out whole, queued text is cut at the slot size
+        va_list copy;
+        va_copy(copy, args);
+        char message[1024];
+        auto const length = format_message(message, format, args);
+        if (length <= static_cast<int>(sizeof(message)) - 2)
+            dispatch(ctx, message);
+        else
+        {
+            std::string text(static_cast<std::size_t>(length) + 1, '\0');
+            std::vsnprintf(&text[0], text.size(), format, copy);
+            text.back() = '\n';
+            if ('\n' == text[text.size() - 2])
+                text.pop_back();
+            dispatch(ctx, text.c_str());
+        }
+        va_end(copy);
+    }
+
+    void logger::dispatch(context const & ctx, char const * message)
+    {
+        std::lock_guard<std::mutex> lock(m_handler_mutex);
         for (auto const & handler : m_handlers)
         {
             if (handler)
@@ -159,10 +459,243 @@ namespace idascm
         }
     }
 
+    auto logger::start_async(std::size_t capacity, overflow policy) -> bool
+    {
+        if (m_queue.load(std::memory_order_acquire))
+            return false;
+        std::size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        auto queue = new logger_queue;
+        queue->slots.reset(new logger_queue::slot[size]);
+        for (std::size_t i = 0; i < size; ++ i)
+            queue->slots[i].sequence.store(i, std::memory_order_relaxed);
+        queue->mask = size - 1;
+        queue->policy = policy;
+        queue->tail.store(0, std::memory_order_relaxed);
+        queue->head.store(0, std::memory_order_relaxed);
+        queue->dropped.store(0, std::memory_order_relaxed);
+        queue->running.store(true, std::memory_order_relaxed);
+        queue->sleeping.store(false, std::memory_order_relaxed);
+        queue->thread = std::thread([queue, this] { queue->run(*this); });
+        m_queue.store(queue, std::memory_order_seq_cst);
+        return true;
+    }
+
+    void logger::stop_async(void)
+    {
+        // unpublished first, producers that already hold the queue finish while it is still drained
+        auto queue = m_queue.exchange(nullptr, std::memory_order_seq_cst);
+        if (! queue)
+            return;
+        wait_users(m_queue_users);
+        queue->running.store(false, std::memory_order_release);
+        queue->notify();
+        queue->thread.join();
+        if (auto const dropped = queue->dropped.load(std::memory_order_relaxed))
+            add_message(level::warning, __FILE__, __LINE__, __FUNCTION__, "%llu log messages dropped (queue full)", static_cast<unsigned long long>(dropped));
+        delete queue;
+    }
+
+    void logger::flush(void)
+    {
+        user_scope scope(m_queue_users);
+        auto queue = m_queue.load(std::memory_order_seq_cst);
+        if (! queue || std::this_thread::get_id() == queue->thread.get_id())
+            return;
+        auto const target = queue->tail.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        while (queue->head.load(std::memory_order_acquire) < target)
+        {
+            queue->wake.notify_one();
+            queue->progress.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+
+    auto logger::dropped_count(void) const noexcept -> std::uint64_t
+    {
+        user_scope scope(m_queue_users);
+        if (auto const queue = m_queue.load(std::memory_order_seq_cst))
+            return queue->dropped.load(std::memory_order_relaxed);
+        return 0;
+    }
+
+    void logger::set_rate_limit(std::uint32_t burst, std::uint32_t window, std::uint32_t summary_interval)
+    {
+        m_burst.store(burst, std::memory_order_relaxed);
+        m_window.store(window, std::memory_order_relaxed);
+        m_summary_interval.store(summary_interval, std::memory_order_relaxed);
+        m_summary_time.store(clock_ms(), std::memory_order_relaxed);
+    }
+
+    // lock-free and approximate: concurrent callers may let a few extra messages through at a window edge
+    auto logger::admit(site & site) -> bool
+    {
+        auto const burst = m_burst.load(std::memory_order_relaxed);
+        if (! burst)
+            return true;
+        auto const now = clock_ms();
+        auto start = site.window.load(std::memory_order_relaxed);
+        if (now - start >= m_window.load(std::memory_order_relaxed) && site.window.compare_exchange_strong(start, now, std::memory_order_relaxed))
+            site.count.store(0, std::memory_order_relaxed);
+        bool const admitted = site.count.fetch_add(1, std::memory_order_relaxed) < burst;
+        if (! admitted)
+        {
+            site.suppressed.fetch_add(1, std::memory_order_relaxed);
+            if (! site.listed.exchange(true, std::memory_order_relaxed))
+            {
+                auto head = m_suppressed.load(std::memory_order_relaxed);
+                do
+                {
+                    site.next = head;
+                }
+                while (! m_suppressed.compare_exchange_weak(head, &site, std::memory_order_release, std::memory_order_relaxed));
+            }
+        }
+        auto last = m_summary_time.load(std::memory_order_relaxed);
+        if (now - last >= m_summary_interval.load(std::memory_order_relaxed) && m_suppressed.load(std::memory_order_relaxed))
+        {
+            if (m_summary_time.compare_exchange_strong(last, now, std::memory_order_relaxed))
+                flush_suppressed();
+        }
+        return admitted;
+    }
+
+    void logger::flush_suppressed(void)
+    {
+        for (auto site = m_suppressed.load(std::memory_order_acquire); site; site = site->next)
+        {
+            if (auto const count = site->suppressed.exchange(0, std::memory_order_relaxed))
+                message(*site, "%u similar messages suppressed", count);
+        }
+    }
+
+    auto logger::start_trace(char const * path) -> bool
+    {
+        if (m_trace.load(std::memory_order_relaxed))
+            return false;
+        auto file = std::fopen(path, "wb");
+        if (! file)
+            return false;
+        static std::atomic<std::uint32_t> session { 0 };
+        auto trace = new logger_trace;
+        trace->file         = file;
+        trace->session      = ++ session;
+        trace->site_count   = 0;
+        trace->start        = std::chrono::steady_clock::now();
+        trace->sites.put("IDASCMLT", 8);
+        trace->sites.put(log_trace_version);
+        trace->sites.put(std::uint32_t(0));
+        m_trace.store(trace, std::memory_order_seq_cst);
+        return true;
+    }
+
+    void logger::stop_trace(void)
+    {
+        auto trace = m_trace.exchange(nullptr, std::memory_order_seq_cst);
+        if (! trace)
+            return;
+        wait_users(m_trace_users);
+        {
+            // no thread is in trace() any more, their stages can be taken
+            std::lock_guard<std::mutex> lock(trace->mutex);
+            trace->write(trace->sites);
+            for (auto & stage : trace->stages)
+                trace->write(*stage);
+        }
+        std::fclose(trace->file);
+        delete trace;
+    }
+
+    void logger::trace(site & site, char const * format, argument const * arguments, std::size_t count)
+    {
+        user_scope scope(m_trace_users);
+        auto trace = m_trace.load(std::memory_order_seq_cst);
+        if (! trace)
+            return;
+        auto const time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace->start).count();
+        auto const thread = current_thread_index();
+        count = std::min<std::size_t>(count, 0xff);
+
+        // the calling thread's stage, one per thread and session
+        thread_local std::uint32_t          t_session   = 0;
+        thread_local logger_trace_buffer *  t_stage     = nullptr;
+        if (t_session != trace->session)
+        {
+            std::lock_guard<std::mutex> lock(trace->mutex);
+            trace->stages.emplace_back(new logger_trace_buffer);
+            t_stage   = trace->stages.back().get();
+            t_session = trace->session;
+        }
+        auto & stage = *t_stage;
+
+        if (site.session.load(std::memory_order_acquire) != trace->session)
+        {
+            std::lock_guard<std::mutex> lock(trace->mutex);
+            if (site.session.load(std::memory_order_relaxed) != trace->session)
+            {
+                site.id      = ++ trace->site_count;
+                site.bounded = log_format_bounded_strings(format);
+                trace->sites.put(log_trace_record_site);
+                trace->sites.put(site.id);
+                trace->sites.put(static_cast<std::uint8_t>(site.level));
+                trace->sites.put(static_cast<std::uint8_t>(site.subsystem));
+                trace->sites.put(static_cast<std::int32_t>(site.line));
+                trace->sites.put_string(site.file, std::strlen(site.file));
+                trace->sites.put_string(site.function, std::strlen(site.function));
+                trace->sites.put_string(format, std::strlen(format));
+                site.session.store(trace->session, std::memory_order_release);
+            }
+        }
+        stage.put(log_trace_record_message);
+        stage.put(static_cast<std::uint64_t>(time));
+        stage.put(thread);
+        stage.put(site.id);
+        stage.put(static_cast<std::uint8_t>(count));
+        for (std::size_t i = 0; i < count; ++ i)
+        {
+            auto const & arg = arguments[i];
+            if (argument::kind::string == arg.tag && ! arg.s)
+            {
+                stage.put(argument::kind::pointer);
+                stage.put(std::uint64_t(0));
+                continue;
+            }
+            stage.put(arg.tag);
+            if (argument::kind::string == arg.tag)
+            {
+                // '%.*s' strings need not be terminated
+                std::size_t limit = 4096;
+                if (i && i < 32 && (site.bounded & (1u << i)) && argument::kind::signed_integer == arguments[i - 1].tag)
+                    limit = static_cast<std::size_t>(std::max<std::int64_t>(0, std::min<std::int64_t>(arguments[i - 1].i, 4096)));
+                std::size_t length = 0;
+                while (length < limit && arg.s[length])
+                    ++ length;
+                stage.put_string(arg.s, length);
+            }
+            else
+            {
+                stage.put(arg.u);
+            }
+        }
+        if (stage.bytes.size() >= logger_trace::stage_size)
+        {
+            std::lock_guard<std::mutex> lock(trace->mutex);
+            trace->drain(stage);
+        }
+    }
+
     auto to_string(logger::level level) noexcept -> char const *
     {
         if (std::size_t(level) < std::size(g_level_table))
             return g_level_table[std::size_t(level)];
         return nullptr;
     }
+
+    auto to_string(logger::subsystem subsystem) noexcept -> char const *
+    {
+        if (std::size_t(subsystem) < std::size(g_subsystem_table))
+            return g_subsystem_table[std::size_t(subsystem)];
+        return nullptr;
+    }
 }
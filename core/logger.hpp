@@ -1,22 +1,68 @@
 # pragma once
 # include <core/core.hpp>
+# include <atomic>
 # include <cstdarg>
 # include <cstdio>
+# include <mutex>
+# include <type_traits>
 
-# define IDASCM_LOG(L, F, ...) \
-    if ((L) <= ::idascm::logger::instance().current_level()) \
+# define IDASCM_LOG_LEVEL_ERROR     1
+# define IDASCM_LOG_LEVEL_WARNING   2
+# define IDASCM_LOG_LEVEL_INFO      3
+# define IDASCM_LOG_LEVEL_DEBUG     4
+# define IDASCM_LOG_LEVEL_TRACE     5
+
+// least severe level compiled in, calls below it expand to nothing
+# if ! defined IDASCM_LOG_MIN_LEVEL
+#   define IDASCM_LOG_MIN_LEVEL IDASCM_LOG_LEVEL_TRACE
+# endif
+
+// subsystem of the including translation unit (logger::subsystem member name),
+// define it before the first include
+# if ! defined IDASCM_LOG_SUBSYSTEM
+#   define IDASCM_LOG_SUBSYSTEM general
+# endif
+
+# define IDASCM_LOG(L, ...) \
+    if ((L) <= ::idascm::logger::instance().current_level(::idascm::logger::subsystem::IDASCM_LOG_SUBSYSTEM)) \
     { \
-        ::idascm::logger::instance().add_message(L, __FILE__, __LINE__, __FUNCTION__, F, __VA_ARGS__); \
+        static ::idascm::logger::site idascm_log_site = { L, ::idascm::logger::subsystem::IDASCM_LOG_SUBSYSTEM, __FILE__, __LINE__, __FUNCTION__ }; \
+        ::idascm::logger::instance().log(idascm_log_site, __VA_ARGS__); \
     }
 
-# define IDASCM_LOG_E(F, ...) IDASCM_LOG(::idascm::logger::level::error,   F, __VA_ARGS__)
-# define IDASCM_LOG_W(F, ...) IDASCM_LOG(::idascm::logger::level::warning, F, __VA_ARGS__)
-# define IDASCM_LOG_I(F, ...) IDASCM_LOG(::idascm::logger::level::info,    F, __VA_ARGS__)
-# define IDASCM_LOG_D(F, ...) IDASCM_LOG(::idascm::logger::level::debug,   F, __VA_ARGS__)
-# define IDASCM_LOG_T(F, ...) IDASCM_LOG(::idascm::logger::level::trace,   F, __VA_ARGS__)
+# define IDASCM_LOG_NONE(...) ((void) 0)
+
+# if IDASCM_LOG_MIN_LEVEL >= IDASCM_LOG_LEVEL_ERROR
+#   define IDASCM_LOG_E(...) IDASCM_LOG(::idascm::logger::level::error,   __VA_ARGS__)
+# else
+#   define IDASCM_LOG_E(...) IDASCM_LOG_NONE(__VA_ARGS__)
+# endif
+# if IDASCM_LOG_MIN_LEVEL >= IDASCM_LOG_LEVEL_WARNING
+#   define IDASCM_LOG_W(...) IDASCM_LOG(::idascm::logger::level::warning, __VA_ARGS__)
+# else
+#   define IDASCM_LOG_W(...) IDASCM_LOG_NONE(__VA_ARGS__)
+# endif
+# if IDASCM_LOG_MIN_LEVEL >= IDASCM_LOG_LEVEL_INFO
+#   define IDASCM_LOG_I(...) IDASCM_LOG(::idascm::logger::level::info,    __VA_ARGS__)
+# else
+#   define IDASCM_LOG_I(...) IDASCM_LOG_NONE(__VA_ARGS__)
+# endif
+# if IDASCM_LOG_MIN_LEVEL >= IDASCM_LOG_LEVEL_DEBUG
+#   define IDASCM_LOG_D(...) IDASCM_LOG(::idascm::logger::level::debug,   __VA_ARGS__)
+# else
+#   define IDASCM_LOG_D(...) IDASCM_LOG_NONE(__VA_ARGS__)
+# endif
+# if IDASCM_LOG_MIN_LEVEL >= IDASCM_LOG_LEVEL_TRACE
+#   define IDASCM_LOG_T(...) IDASCM_LOG(::idascm::logger::level::trace,   __VA_ARGS__)
+# else
+#   define IDASCM_LOG_T(...) IDASCM_LOG_NONE(__VA_ARGS__)
+# endif
 
 namespace idascm
 {
+    struct logger_queue;
+    struct logger_trace;
+
     class logger
     {
         public:
@@ -30,12 +76,26 @@ namespace idascm
                 trace,
             };
 
+            enum class subsystem : std::uint8_t
+            {
+                general,
+                json,
+                isa,        // command sets and manager
+                decoder,
+                analyzer,
+                emulator,
+                output,
+                module,     // IDA module glue
+                count,
+            };
+
             struct context
             {
-                level           level;
-                char const *    file;
-                int             line;
-                char const *    function;
+                logger::level       level;
+                char const *        file;
+                int                 line;
+                char const *        function;
+                logger::subsystem   subsystem;
             };
 
             class handler
@@ -44,6 +104,94 @@ namespace idascm
                     virtual void message(context const & ctx, char const * message) = 0;
             };
 
+            // asynchronous mode behaviour when the ring is full
+            enum class overflow
+            {
+                drop,   // message is discarded and counted (see dropped_count)
+                block,  // producer waits for a free slot
+            };
+
+            // call site, one static instance per IDASCM_LOG_x expansion
+            struct site
+            {
+                logger::level               level;
+                logger::subsystem           subsystem;
+                char const *                file;
+                int                         line;
+                char const *                function;
+                std::uint32_t               id          = 0;        // trace session local, set under the trace lock
+                std::atomic<std::uint32_t>  session     = { 0 };    // trace session 'id' belongs to, published after it
+                std::uint32_t               bounded     = 0;        // string arguments limited by a '*' precision (bit per argument)
+                std::atomic<std::int64_t>   window      = { 0 };    // rate limit window start (ms)
+                std::atomic<std::uint32_t>  count       = { 0 };    // messages in the current window
+                std::atomic<std::uint32_t>  suppressed  = { 0 };    // messages dropped since the last summary
+                std::atomic<bool>           listed      = { false };
+                site *                      next        = nullptr;  // suppressed site list
+            };
+
+            // raw printf argument as recorded by the binary trace
+            struct argument
+            {
+                enum class kind : std::uint8_t
+                {
+                    none,
+                    signed_integer,
+                    unsigned_integer,
+                    real,
+                    string,
+                    pointer,
+                };
+
+                kind                tag;
+                std::uint32_t       length;     // string length (trace files only, strings are not terminated)
+                union
+                {
+                    std::int64_t    i;
+                    std::uint64_t   u;
+                    double          d;
+                    char const *    s;
+                    void const *    p;
+                };
+
+                template <typename type>
+                static auto make(type const & value) noexcept -> argument
+                {
+                    argument arg = {};
+                    using decayed = std::decay_t<type>;
+                    if constexpr (std::is_floating_point<decayed>::value)
+                    {
+                        arg.tag  = kind::real;
+                        arg.d    = value;
+                    }
+                    else if constexpr (std::is_same<decayed, char const *>::value || std::is_same<decayed, char *>::value)
+                    {
+                        arg.tag  = kind::string;
+                        arg.s    = value;
+                    }
+                    else if constexpr (std::is_pointer<decayed>::value || std::is_null_pointer<decayed>::value)
+                    {
+                        arg.tag  = kind::pointer;
+                        arg.p    = value;
+                    }
+                    else if constexpr (std::is_enum<decayed>::value)
+                    {
+                        return make(static_cast<std::underlying_type_t<decayed>>(value));
+                    }
+                    else if constexpr (std::is_signed<decltype(+value)>::value)
+                    {
+                        arg.tag  = kind::signed_integer;
+                        arg.i    = +value;
+                    }
+                    else
+                    {
+                        static_assert(std::is_integral<decayed>::value, "unsupported log argument type");
+                        arg.tag  = kind::unsigned_integer;
+                        arg.u    = +value;
+                    }
+                    return arg;
+                }
+            };
+
         public:
             static logger & instance(void);
 
@@ -51,23 +199,99 @@ namespace idascm
             auto add_handler(handler * handler) -> bool;
             auto remove_handler(handler * handler) -> bool;
             void add_message(level level, char const * file, int line, char const * function, char const * format, ...);
+
+            // IDASCM_LOG_x entry point: text through the handlers, or a binary record while tracing
+            template <typename... types>
+            void log(site & site, char const * format, types const & ... values)
+            {
+                if (m_trace.load(std::memory_order_acquire))
+                {
+                    argument const list[] = { argument::make(values) ..., argument {} };
+                    trace(site, format, list, sizeof ... (values));
+                    return;
+                }
+                if (admit(site))
+                    message(site, format, values ...);
+            }
+
             auto current_level(void) const -> level
             {
-                return m_level;
+                return m_level.load(std::memory_order_relaxed);
+            }
+            auto current_level(subsystem subsystem) const -> level
+            {
+                if (std::size_t(subsystem) < std::size_t(logger::subsystem::count))
+                    return m_levels[std::size_t(subsystem)].load(std::memory_order_relaxed);
+                return current_level();
             }
+            // sets every subsystem
             void set_level(level level)
             {
-                m_level = level;
+                m_level.store(level, std::memory_order_relaxed);
+                for (auto & subsystem_level : m_levels)
+                    subsystem_level.store(level, std::memory_order_relaxed);
+            }
+            void set_level(subsystem subsystem, level level)
+            {
+                if (std::size_t(subsystem) < std::size_t(logger::subsystem::count))
+                    m_levels[std::size_t(subsystem)].store(level, std::memory_order_relaxed);
             }
 
+            // asynchronous mode: callers format into a bounded lock-free ring (multiple producers)
+            // and a background thread hands messages to the handlers, so no I/O happens on the caller
+            // 'capacity' is rounded up to a power of two
+            auto start_async(std::size_t capacity = 1024, overflow policy = overflow::drop) -> bool;
+            // dispatches everything queued and joins the thread, concurrent logging calls either
+            // reach the queue before it is drained or go straight to the handlers
+            void stop_async(void);
+            // waits until every message queued so far reached the handlers
+            void flush(void);
+            auto dropped_count(void) const noexcept -> std::uint64_t;
+
+            // per call site rate limit: at most 'burst' messages every 'window' ms (0 - unlimited, 16 by default)
+            // the rest is counted and summarized every 'summary_interval' ms and by flush_suppressed(),
+            // call it at shutdown while the handlers are still there
+            // applies to text output only, binary traces record everything
+            void set_rate_limit(std::uint32_t burst, std::uint32_t window = 1000, std::uint32_t summary_interval = 5000);
+            // reports every call site with suppressed messages now
+            void flush_suppressed(void);
+
+            // binary trace mode: IDASCM_LOG_x calls append the call site id and the raw arguments
+            // to 'path' instead of formatting, render it with idascm-trace
+            // handlers see nothing while tracing, add_message calls are not recorded
+            // each thread stages its records and writes them in 64 KiB blocks, a call only takes
+            // the trace lock the first time its site or thread shows up in the session
+            auto start_trace(char const * path) -> bool;
+            void stop_trace(void);
+
         protected:
             logger(void);
             ~logger(void);
 
         private:
-            level       m_level;
-            handler *   m_handlers[8];
+            friend struct logger_queue;
+            void dispatch(context const & ctx, char const * message);
+            void message(site const & site, char const * format, ...);
+            void vmessage(context const & ctx, char const * format, va_list args);
+            void trace(site & site, char const * format, argument const * arguments, std::size_t count);
+            auto admit(site & site) -> bool;
+
+        private:
+            std::atomic<level>          m_level;
+            std::atomic<level>          m_levels[std::size_t(subsystem::count)];
+            handler *                   m_handlers[8];
+            std::mutex                  m_handler_mutex;    // handler list and dispatch
+            std::atomic<logger_queue *> m_queue;            // asynchronous mode only
+            mutable std::atomic<std::size_t> m_queue_users; // threads that may hold m_queue
+            std::atomic<logger_trace *> m_trace;            // binary trace mode only
+            std::atomic<std::size_t>    m_trace_users;      // threads that may hold m_trace
+            std::atomic<std::uint32_t>  m_burst;            // rate limit
+            std::atomic<std::uint32_t>  m_window;
+            std::atomic<std::uint32_t>  m_summary_interval;
+            std::atomic<std::int64_t>   m_summary_time;
+            std::atomic<site *>         m_suppressed;       // sites that ever dropped a message
     };
 
     auto to_string(logger::level level) noexcept -> char const *;
+    auto to_string(logger::subsystem subsystem) noexcept -> char const *;
 }
@@ -0,0 +1,392 @@
+# include <core/logger_trace.hpp>
+# include <algorithm>
+# include <cstdio>
+# include <cstring>
+
+namespace idascm
+{
+    namespace
+    {
+        auto conversion_kind(char c) -> logger::argument::kind
+        {
+            switch (c)
+            {
+                case 'd':
+                case 'i':
+                case 'c':
+                    return logger::argument::kind::signed_integer;
+                case 'u':
+                case 'o':
+                case 'x':
+                case 'X':
+                    return logger::argument::kind::unsigned_integer;
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A':
+                    return logger::argument::kind::real;
+                case 's':
+                    return logger::argument::kind::string;
+                case 'p':
+                    return logger::argument::kind::pointer;
+                default:
+                    break;
+            }
+            return logger::argument::kind::none;
+        }
+
+        auto is_length_modifier(char c) -> bool
+        {
+            return nullptr != std::strchr("hlLqjzt", c);
+        }
+
+        auto as_int(logger::argument const & arg) -> long long
+        {
+            switch (arg.tag)
+            {
+                case logger::argument::kind::real:
+                    return static_cast<long long>(arg.d);
+                default:
+                    return static_cast<long long>(arg.i);
+            }
+        }
+
+        auto as_double(logger::argument const & arg) -> double
+        {
+            switch (arg.tag)
+            {
+                case logger::argument::kind::signed_integer:
+                    return static_cast<double>(arg.i);
+                case logger::argument::kind::unsigned_integer:
+                    return static_cast<double>(arg.u);
+                default:
+                    return arg.d;
+            }
+        }
+
+        template <typename... types>
+        void append_format(std::string & text, char const * spec, types ... values)
+        {
+            char buffer[256];
+            int const length = std::snprintf(buffer, sizeof(buffer), spec, values ...);
+            if (length < 0)
+                return;
+            if (static_cast<std::size_t>(length) < sizeof(buffer))
+            {
+                text.append(buffer, length);
+                return;
+            }
+            auto const offset = text.size();
+            text.resize(offset + length + 1);
+            std::snprintf(&text[offset], length + 1, spec, values ...);
+            text.resize(offset + length);
+        }
+
+        // bounds checked cursor over the file image
+        class trace_cursor
+        {
+            public:
+                template <typename type>
+                auto read(type & value) -> bool
+                {
+                    if (static_cast<std::size_t>(m_last - m_first) < sizeof(value))
+                        return false;
+                    std::memcpy(&value, m_first, sizeof(value));
+                    m_first += sizeof(value);
+                    return true;
+                }
+
+                auto read_string(char const * & data, std::uint32_t & length) -> bool
+                {
+                    if (! read(length) || static_cast<std::size_t>(m_last - m_first) < length)
+                        return false;
+                    data = m_first;
+                    m_first += length;
+                    return true;
+                }
+
+                auto read_string(std::string & string) -> bool
+                {
+                    char const * data = nullptr;
+                    std::uint32_t length = 0;
+                    if (! read_string(data, length))
+                        return false;
+                    string.assign(data, length);
+                    return true;
+                }
+
+                auto done(void) const noexcept -> bool
+                {
+                    return m_first == m_last;
+                }
+
+            public:
+                trace_cursor(char const * first, char const * last)
+                    : m_first(first)
+                    , m_last(last)
+                {}
+
+            private:
+                char const *    m_first;
+                char const *    m_last;
+        };
+    }
+
+    auto log_format_parse(char const * format, std::vector<log_format_conversion> & conversions) -> bool
+    {
+        conversions.clear();
+        if (! format)
+            return false;
+        for (char const * p = format; *p; ++ p)
+        {
+            if ('%' != *p)
+                continue;
+            if ('%' == p[1])
+            {
+                ++ p;
+                continue;
+            }
+            log_format_conversion conversion = {};
+            conversion.first = p ++;
+            while (*p && std::strchr("-+ #0", *p))
+                ++ p;
+            if ('*' == *p)
+            {
+                ++ conversion.stars;
+                ++ p;
+            }
+            while (*p >= '0' && *p <= '9')
+                ++ p;
+            if ('.' == *p)
+            {
+                ++ p;
+                if ('*' == *p)
+                {
+                    ++ conversion.stars;
+                    conversion.star_precision = true;
+                    ++ p;
+                }
+                while (*p >= '0' && *p <= '9')
+                    ++ p;
+            }
+            while (*p && is_length_modifier(*p))
+                ++ p;
+            conversion.kind = conversion_kind(*p);
+            if (logger::argument::kind::none == conversion.kind)
+                return false;
+            conversion.last = p + 1;
+            conversions.push_back(conversion);
+        }
+        return true;
+    }
+
+    auto log_format_bounded_strings(char const * format) -> std::uint32_t
+    {
+        std::vector<log_format_conversion> conversions;
+        if (! log_format_parse(format, conversions))
+            return 0;
+        std::uint32_t mask = 0;
+        unsigned index = 0;
+        for (auto const & conversion : conversions)
+        {
+            index += conversion.stars;
+            if (logger::argument::kind::string == conversion.kind && conversion.star_precision && index < 32)
+                mask |= 1u << index;
+            ++ index;
+        }
+        return mask;
+    }
+
+    auto log_format_render(char const * format, logger::argument const * arguments, std::size_t count, std::string & text) -> bool
+    {
+        std::vector<log_format_conversion> conversions;
+        if (! log_format_parse(format, conversions))
+            return false;
+        std::size_t index = 0;
+        char const * literal = format;
+        for (auto const & conversion : conversions)
+        {
+            for (char const * p = literal; p != conversion.first; ++ p)
+            {
+                text += *p;
+                if ('%' == p[0] && '%' == p[1])
+                    ++ p;
+            }
+            literal = conversion.last;
+            if (index + conversion.stars + 1 > count)
+                return false;
+            // specification without length modifiers, the proper one is added back per argument
+            std::string spec;
+            for (char const * p = conversion.first; p + 1 != conversion.last; ++ p)
+                if (! is_length_modifier(*p))
+                    spec += *p;
+            int stars[2] = {};
+            for (unsigned i = 0; i < conversion.stars; ++ i)
+                stars[i] = static_cast<int>(as_int(arguments[index ++]));
+            auto const & arg = arguments[index ++];
+            char const c = conversion.last[-1];
+            auto const emit = [&text, &spec, &stars, &conversion](auto value)
+            {
+                if (0 == conversion.stars)
+                    append_format(text, spec.c_str(), value);
+                else if (1 == conversion.stars)
+                    append_format(text, spec.c_str(), stars[0], value);
+                else
+                    append_format(text, spec.c_str(), stars[0], stars[1], value);
+            };
+            switch (conversion.kind)
+            {
+                case logger::argument::kind::signed_integer:
+                case logger::argument::kind::unsigned_integer:
+                {
+                    if ('c' == c)
+                    {
+                        spec += c;
+                        emit(static_cast<int>(as_int(arg)));
+                        break;
+                    }
+                    spec += "ll";
+                    spec += c;
+                    emit(as_int(arg));
+                    break;
+                }
+                case logger::argument::kind::real:
+                {
+                    spec += c;
+                    emit(as_double(arg));
+                    break;
+                }
+                case logger::argument::kind::string:
+                {
+                    spec += c;
+                    std::string const value = logger::argument::kind::string == arg.tag ? std::string(arg.s, arg.length) : std::string("(null)");
+                    emit(value.c_str());
+                    break;
+                }
+                default:
+                {
+                    append_format(text, "0x%llx", static_cast<unsigned long long>(arg.u));
+                    break;
+                }
+            }
+        }
+        for (char const * p = literal; *p; ++ p)
+        {
+            text += *p;
+            if ('%' == p[0] && '%' == p[1])
+                ++ p;
+        }
+        return true;
+    }
+
+    auto log_trace_file::load(char const * path) -> bool
+    {
+        auto stream = std::fopen(path, "rb");
+        if (! stream)
+            return false;
+        std::vector<char> data;
+        char buffer[1 << 16];
+        std::size_t size = 0;
+        while ((size = std::fread(buffer, 1, sizeof(buffer), stream)) > 0)
+            data.insert(data.end(), buffer, buffer + size);
+        std::fclose(stream);
+        return load(static_cast<std::vector<char> &&>(data));
+    }
+
+    auto log_trace_file::load(std::vector<char> && data) -> bool
+    {
+        m_data = static_cast<std::vector<char> &&>(data);
+        m_sites.clear();
+        m_messages.clear();
+        trace_cursor cursor(m_data.data(), m_data.data() + m_data.size());
+        char magic[8] = {};
+        std::uint32_t version = 0;
+        std::uint32_t reserved = 0;
+        if (! cursor.read(magic) || 0 != std::memcmp(magic, "IDASCMLT", 8) || ! cursor.read(version) || ! cursor.read(reserved))
+            return false;
+        if (log_trace_version != version)
+            return false;
+        while (! cursor.done())
+        {
+            std::uint8_t type = 0;
+            if (! cursor.read(type))
+                return false;
+            if (log_trace_record_site == type)
+            {
+                log_trace_site site = {};
+                std::uint8_t level = 0;
+                std::uint8_t subsystem = 0;
+                std::int32_t line = 0;
+                if (! cursor.read(site.id) || ! cursor.read(level) || ! cursor.read(subsystem) || ! cursor.read(line))
+                    return false;
+                if (! cursor.read_string(site.file) || ! cursor.read_string(site.function) || ! cursor.read_string(site.format))
+                    return false;
+                site.level      = static_cast<logger::level>(level);
+                site.subsystem  = static_cast<logger::subsystem>(subsystem);
+                site.line       = line;
+                m_sites.push_back(static_cast<log_trace_site &&>(site));
+            }
+            else if (log_trace_record_message == type)
+            {
+                log_trace_message message = {};
+                std::uint8_t count = 0;
+                if (! cursor.read(message.time) || ! cursor.read(message.thread) || ! cursor.read(message.site) || ! cursor.read(count))
+                    return false;
+                message.arguments.resize(count);
+                for (auto & arg : message.arguments)
+                {
+                    if (! cursor.read(arg.tag))
+                        return false;
+                    if (logger::argument::kind::string == arg.tag)
+                    {
+                        if (! cursor.read_string(arg.s, arg.length))
+                            return false;
+                    }
+                    else if (! cursor.read(arg.u))
+                    {
+                        return false;
+                    }
+                }
+                m_messages.push_back(static_cast<log_trace_message &&>(message));
+            }
+            else
+            {
+                return false;
+            }
+        }
+        // threads hand their records over in blocks
+        std::stable_sort(m_messages.begin(), m_messages.end(), [](log_trace_message const & lhs, log_trace_message const & rhs)
+        {
+            return lhs.time < rhs.time;
+        });
+        return true;
+    }
+
+    auto log_trace_file::find_site(std::uint32_t id) const noexcept -> log_trace_site const *
+    {
+        // ids are handed out in order, starting at 1
+        if (id && id <= m_sites.size() && m_sites[id - 1].id == id)
+            return &m_sites[id - 1];
+        for (auto const & site : m_sites)
+            if (site.id == id)
+                return &site;
+        return nullptr;
+    }
+
+    auto log_trace_file::render(log_trace_message const & message, std::string & text) const -> bool
+    {
+        auto const site = find_site(message.site);
+        if (! site)
+            return false;
+        append_format(text, "%s(%d): [%s] ", site->file.c_str(), site->line, to_string(site->level));
+        if (! log_format_render(site->format.c_str(), message.arguments.data(), message.arguments.size(), text))
+            return false;
+        if (text.empty() || '\n' != text.back())
+            text += '\n';
+        return true;
+    }
+}
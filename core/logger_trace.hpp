@@ -0,0 +1,89 @@
+# pragma once
+# include <core/logger.hpp>
+# include <cstdint>
+# include <string>
+# include <vector>
+
+namespace idascm
+{
+    // binary trace file layout (native byte order)
+    //   header  : "IDASCMLT" u32 version u32 reserved
+    //   site    : u8 1, u32 id, u8 level, u8 subsystem, i32 line, string file, string function, string format
+    //   message : u8 2, u64 time (ns since start), u32 thread, u32 site id, u8 count, argument * count
+    //   argument: u8 kind, string (kind::string) or 8 raw bytes
+    //   string  : u32 length, bytes (not terminated)
+    // a site comes before its first message, messages come in blocks per thread
+    enum : std::uint8_t
+    {
+        log_trace_record_site       = 1,
+        log_trace_record_message    = 2,
+    };
+    std::uint32_t const log_trace_version = 1;
+
+    // single printf conversion
+    struct log_format_conversion
+    {
+        char const *                first;          // '%'
+        char const *                last;           // past the conversion character
+        logger::argument::kind      kind;           // argument the conversion itself consumes
+        unsigned                    stars;          // leading int arguments taken by '*' width / precision
+        bool                        star_precision; // the last of them is the precision
+    };
+
+    // conversions in order, "%%" is skipped; false on a malformed specification
+    auto log_format_parse(char const * format, std::vector<log_format_conversion> & conversions) -> bool;
+
+    // bit per argument: string conversions with a '*' precision (the preceding argument bounds the string)
+    auto log_format_bounded_strings(char const * format) -> std::uint32_t;
+
+    // printf with recorded arguments, strings use argument::length
+    auto log_format_render(char const * format, logger::argument const * arguments, std::size_t count, std::string & text) -> bool;
+
+    struct log_trace_site
+    {
+        std::uint32_t       id;
+        logger::level       level;
+        logger::subsystem   subsystem;
+        int                 line;
+        std::string         file;
+        std::string         function;
+        std::string         format;
+    };
+
+    struct log_trace_message
+    {
+        std::uint64_t                   time;
+        std::uint32_t                   thread;
+        std::uint32_t                   site;
+        std::vector<logger::argument>   arguments;  // strings point into the owning log_trace_file
+    };
+
+    // whole trace file loaded in memory
+    class log_trace_file
+    {
+        public:
+            auto load(char const * path) -> bool;
+            auto load(std::vector<char> && data) -> bool;
+
+            auto sites(void) const noexcept -> std::vector<log_trace_site> const &
+            {
+                return m_sites;
+            }
+
+            // in time order
+            auto messages(void) const noexcept -> std::vector<log_trace_message> const &
+            {
+                return m_messages;
+            }
+
+            auto find_site(std::uint32_t id) const noexcept -> log_trace_site const *;
+
+            // "file(line): [level] message\n"
+            auto render(log_trace_message const & message, std::string & text) const -> bool;
+
+        private:
+            std::vector<char>               m_data;
+            std::vector<log_trace_site>     m_sites;
+            std::vector<log_trace_message>  m_messages;
+    };
+}
@@ -0,0 +1,109 @@
+# include <core/mapped_file.hpp>
+# include <utility>
+# if defined IDASCM_PLATFORM_WINDOWS
+#   include <windows.h>
+# else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+# endif
+
+namespace idascm
+{
+    namespace
+    {
+        auto page_size(void) noexcept -> std::size_t
+        {
+# if defined IDASCM_PLATFORM_WINDOWS
+            SYSTEM_INFO info = {};
+            ::GetSystemInfo(&info);
+            return info.dwPageSize;
+# else
+            return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+# endif
+        }
+    }
+
+    auto mapped_file::open(char const * path, access mode) -> bool
+    {
+        close();
+        if (! path || ! path[0])
+            return false;
+# if defined IDASCM_PLATFORM_WINDOWS
+        auto const file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (INVALID_HANDLE_VALUE == file)
+            return false;
+        LARGE_INTEGER size = {};
+        if (! ::GetFileSizeEx(file, &size) || 0 == size.QuadPart)
+        {
+            ::CloseHandle(file);
+            return false;
+        }
+        auto const protect  = (access::copy_on_write == mode) ? PAGE_WRITECOPY : PAGE_READONLY;
+        auto const desired  = (access::copy_on_write == mode) ? FILE_MAP_COPY  : FILE_MAP_READ;
+        auto const mapping  = ::CreateFileMappingA(file, nullptr, protect, 0, 0, nullptr);
+        ::CloseHandle(file);
+        if (! mapping)
+            return false;
+        // view keeps the mapping object alive
+        auto const view = ::MapViewOfFile(mapping, desired, 0, 0, 0);
+        ::CloseHandle(mapping);
+        if (! view)
+            return false;
+        m_data = view;
+        m_size = static_cast<std::size_t>(size.QuadPart);
+# else
+        int const fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st = {};
+        if (0 != ::fstat(fd, &st) || st.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        auto const size     = static_cast<std::size_t>(st.st_size);
+        auto const protect  = (access::copy_on_write == mode) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        auto const view     = ::mmap(nullptr, size, protect, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (MAP_FAILED == view)
+            return false;
+        m_data = view;
+        m_size = size;
+# endif
+        return true;
+    }
+
+    void mapped_file::close(void) noexcept
+    {
+        if (! m_data)
+            return;
+# if defined IDASCM_PLATFORM_WINDOWS
+        ::UnmapViewOfFile(m_data);
+# else
+        ::munmap(m_data, m_size);
+# endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    auto mapped_file::slack(void) const noexcept -> std::size_t
+    {
+        if (! m_data)
+            return 0;
+        auto const page = page_size();
+        return (page - m_size % page) % page;
+    }
+
+    auto mapped_file::operator = (mapped_file && other) noexcept -> mapped_file &
+    {
+        if (this != &other)
+        {
+            close();
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+        }
+        return *this;
+    }
+}
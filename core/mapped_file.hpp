@@ -0,0 +1,67 @@
+# pragma once
+# include <core/core.hpp>
+# include <cstddef>
+
+namespace idascm
+{
+    // whole file memory mapping
+    class mapped_file
+    {
+        public:
+            enum class access
+            {
+                read,           // read-only view
+                copy_on_write,  // private writable view, writes never reach the file
+            };
+
+        public:
+            auto open(char const * path, access mode = access::read) -> bool;
+            void close(void) noexcept;
+
+            auto is_open(void) const noexcept -> bool
+            {
+                return nullptr != m_data;
+            }
+
+            auto data(void) const noexcept -> void *
+            {
+                return m_data;
+            }
+
+            auto size(void) const noexcept -> std::size_t
+            {
+                return m_size;
+            }
+
+            // zero filled bytes addressable past the end of file (rest of the last page)
+            auto slack(void) const noexcept -> std::size_t;
+
+        public:
+            auto operator = (mapped_file && other) noexcept -> mapped_file &;
+
+        public:
+            mapped_file(void)
+                : m_data(nullptr)
+                , m_size(0)
+            {}
+
+            mapped_file(mapped_file && other) noexcept
+                : mapped_file()
+            {
+                *this = static_cast<mapped_file &&>(other);
+            }
+
+            ~mapped_file(void) noexcept
+            {
+                close();
+            }
+
+        private:
+            mapped_file(mapped_file const &) = delete;
+            auto operator = (mapped_file const &) -> mapped_file & = delete;
+
+        private:
+            void *          m_data;
+            std::size_t     m_size;
+    };
+}
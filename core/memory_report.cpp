@@ -0,0 +1,87 @@
+# include <core/memory_report.hpp>
+# include <core/json_writer.hpp>
+# include <algorithm>
+# include <cstdio>
+
+namespace idascm
+{
+    void memory_report::add(std::string_view name, std::size_t bytes, bool shared)
+    {
+        for (auto & entry : m_entries)
+        {
+            if (entry.shared == shared && entry.name == name)
+            {
+                entry.bytes += bytes;
+                return;
+            }
+        }
+        m_entries.push_back({ std::string(name), bytes, shared });
+    }
+
+    void memory_report::add(std::string_view prefix, memory_report const & other, bool shared)
+    {
+        std::string name;
+        for (auto const & entry : other.m_entries)
+        {
+            name.assign(prefix.data(), prefix.size());
+            name += '/';
+            name += entry.name;
+            add(name, entry.bytes, shared || entry.shared);
+        }
+    }
+
+    auto memory_report::get(std::string_view name) const noexcept -> std::size_t
+    {
+        std::size_t bytes = 0;
+        for (auto const & entry : m_entries)
+            if (entry.name == name)
+                bytes += entry.bytes;
+        return bytes;
+    }
+
+    auto memory_report::total(void) const noexcept -> std::size_t
+    {
+        std::size_t bytes = 0;
+        for (auto const & entry : m_entries)
+            if (! entry.shared)
+                bytes += entry.bytes;
+        return bytes;
+    }
+
+    void memory_report::write_text(std::string & text) const
+    {
+        std::size_t width = 5;
+        for (auto const & entry : m_entries)
+            width = std::max(width, entry.name.size());
+        char line[512];
+        for (auto const & entry : m_entries)
+        {
+            std::snprintf(line, sizeof(line), "%-*s %12.1f KiB%s\n", static_cast<int>(width), entry.name.c_str(),
+                entry.bytes / 1024.0, entry.shared ? " (shared)" : "");
+            text += line;
+        }
+        std::snprintf(line, sizeof(line), "%-*s %12.1f KiB\n", static_cast<int>(width), "total", total() / 1024.0);
+        text += line;
+    }
+
+    void memory_report::write_json(std::string & json) const
+    {
+        json_writer writer(2);
+        writer.begin_object();
+        writer.key("total");
+        writer.value_uint64(total());
+        writer.key("entries");
+        writer.begin_object();
+        for (auto const & entry : m_entries)
+        {
+            writer.key(entry.name);
+            writer.begin_object();
+            writer.key("bytes");    writer.value_uint64(entry.bytes);
+            writer.key("shared");   writer.value_bool(entry.shared);
+            writer.end_object();
+        }
+        writer.end_object();
+        writer.end_object();
+        json.append(writer.buffer().data(), writer.buffer().size());
+    }
+}
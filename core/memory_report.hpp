@@ -0,0 +1,45 @@
+# pragma once
+# include <core/core.hpp>
+# include <string>
+# include <string_view>
+# include <vector>
+
+namespace idascm
+{
+    // bytes held by an object, broken down by category
+    // shared entries (storage owned elsewhere, interned strings for one) are listed
+    // but left out of total()
+    class memory_report
+    {
+        public:
+            struct entry
+            {
+                std::string     name;
+                std::size_t     bytes;
+                bool            shared;
+            };
+
+        public:
+            // adds to an entry of the same name and sharing
+            void add(std::string_view name, std::size_t bytes, bool shared = false);
+            // entries of 'other' as "<prefix>/<name>", all shared if 'shared'
+            void add(std::string_view prefix, memory_report const & other, bool shared = false);
+
+            // 0 if there is no such entry
+            auto get(std::string_view name) const noexcept -> std::size_t;
+            auto total(void) const noexcept -> std::size_t;
+
+            auto entries(void) const noexcept -> std::vector<entry> const &
+            {
+                return m_entries;
+            }
+
+            // one line per entry and a total, sizes in KiB
+            void write_text(std::string & text) const;
+            // { "total": ..., "entries": { "<name>": { "bytes": ..., "shared": ... } } }
+            void write_json(std::string & json) const;
+
+        private:
+            std::vector<entry>  m_entries;
+    };
+}
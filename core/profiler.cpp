@@ -0,0 +1,300 @@
+# include <core/profiler.hpp>
+# include <core/json_writer.hpp>
+# include <algorithm>
+# include <chrono>
+# include <cstdio>
+# include <map>
+# include <string_view>
+
+namespace idascm
+{
+    // fixed size event block, chunks are chained and never move
+    struct profiler_chunk
+    {
+        enum : std::size_t
+        {
+            capacity = 4096,
+        };
+
+        profiler::event     events[capacity];
+        profiler_chunk *    next = nullptr;
+    };
+
+    // single writer (the owning thread), readers see events up to 'count'
+    struct profiler_thread
+    {
+        std::uint32_t               index;
+        std::uint32_t               depth   = 0;    // owner only
+        std::size_t                 used    = 0;    // owner only, events in 'last'
+        profiler_chunk *            first   = nullptr;
+        profiler_chunk *            last    = nullptr;
+        std::atomic<std::size_t>    count   = { 0 };
+
+        void append(profiler::event const & event) noexcept
+        {
+            if (profiler_chunk::capacity == used)
+            {
+                auto const chunk = new (std::nothrow) profiler_chunk;
+                if (! chunk)
+                    return;
+                last->next  = chunk;
+                last        = chunk;
+                used        = 0;
+            }
+            last->events[used ++] = event;
+            // publishes the event (and a new chunk link) to readers
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        explicit profiler_thread(std::uint32_t index)
+            : index(index)
+            , first(new profiler_chunk)
+            , last(first)
+        {}
+
+        ~profiler_thread(void)
+        {
+            while (first)
+            {
+                auto const next = first->next;
+                delete first;
+                first = next;
+            }
+        }
+    };
+
+    namespace
+    {
+        thread_local profiler_thread * t_thread = nullptr;
+
+        auto steady_ns(void) noexcept -> std::int64_t
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // nearest rank percentile of sorted samples
+        auto percentile(std::vector<std::uint64_t> const & sorted, unsigned percent) noexcept -> std::uint64_t
+        {
+            auto const rank = (sorted.size() * percent + 99) / 100;
+            return sorted[rank ? rank - 1 : 0];
+        }
+    }
+
+    void profiler::scope::enter(site const & site) noexcept
+    {
+        m_thread = instance().current_thread();
+        if (! m_thread)
+            return;
+        m_site  = &site;
+        ++ m_thread->depth;
+        m_start = instance().now();
+    }
+
+    void profiler::scope::leave(void) noexcept
+    {
+        auto const end = instance().now();
+        -- m_thread->depth;
+        m_thread->append({ m_site, m_start, end - m_start, m_thread->index, m_thread->depth });
+    }
+
+    auto profiler::instance(void) -> profiler &
+    {
+        static profiler instance;
+        return instance;
+    }
+
+    profiler::profiler(void)
+        : m_recording(false)
+        , m_epoch(steady_ns())
+    {}
+
+    profiler::~profiler(void)
+    {}
+
+    void profiler::start(void) noexcept
+    {
+        m_recording.store(true, std::memory_order_relaxed);
+    }
+
+    void profiler::stop(void) noexcept
+    {
+        m_recording.store(false, std::memory_order_relaxed);
+    }
+
+    void profiler::reset(void)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto & thread : m_threads)
+        {
+            auto chunk = thread->first->next;
+            while (chunk)
+            {
+                auto const next = chunk->next;
+                delete chunk;
+                chunk = next;
+            }
+            thread->first->next = nullptr;
+            thread->last        = thread->first;
+            thread->used        = 0;
+            thread->count.store(0, std::memory_order_release);
+        }
+    }
+
+    auto profiler::events(void) const -> std::vector<event>
+    {
+        std::vector<event> result;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto const & thread : m_threads)
+        {
+            auto remaining = thread->count.load(std::memory_order_acquire);
+            auto const first = result.size();
+            for (auto chunk = thread->first; chunk && remaining; chunk = chunk->next)
+            {
+                auto const count = std::min<std::size_t>(remaining, profiler_chunk::capacity);
+                result.insert(result.end(), chunk->events, chunk->events + count);
+                remaining -= count;
+            }
+            // events are appended as zones close, inner zones come first
+            std::stable_sort(result.begin() + first, result.end(), [](event const & lhs, event const & rhs)
+            {
+                return lhs.start < rhs.start;
+            });
+        }
+        return result;
+    }
+
+    auto profiler::summarize(void) const -> std::vector<statistics>
+    {
+        std::map<std::string_view, std::vector<std::uint64_t>> durations;
+        std::map<std::string_view, char const *> names;
+        for (auto const & event : events())
+        {
+            durations[event.zone->name].push_back(event.duration);
+            names[event.zone->name] = event.zone->name;
+        }
+        std::vector<statistics> result;
+        for (auto & zone : durations)
+        {
+            auto & samples = zone.second;
+            std::sort(samples.begin(), samples.end());
+            statistics stats = {};
+            stats.name  = names[zone.first];
+            stats.count = samples.size();
+            for (auto const sample : samples)
+                stats.total += sample;
+            stats.min   = samples.front();
+            stats.max   = samples.back();
+            stats.p50   = percentile(samples, 50);
+            stats.p90   = percentile(samples, 90);
+            stats.p99   = percentile(samples, 99);
+            result.push_back(stats);
+        }
+        std::stable_sort(result.begin(), result.end(), [](statistics const & lhs, statistics const & rhs)
+        {
+            return lhs.total > rhs.total;
+        });
+        return result;
+    }
+
+    void profiler::write_summary(std::string & text) const
+    {
+        char line[512];
+        std::snprintf(line, sizeof(line), "%-32s %10s %12s %10s %10s %10s %10s %10s %10s\n",
+            "zone", "count", "total ms", "mean us", "min us", "p50 us", "p90 us", "p99 us", "max us");
+        text += line;
+        for (auto const & stats : summarize())
+        {
+            std::snprintf(line, sizeof(line), "%-32s %10zu %12.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+                stats.name, stats.count, stats.total / 1e6, stats.total / 1e3 / stats.count,
+                stats.min / 1e3, stats.p50 / 1e3, stats.p90 / 1e3, stats.p99 / 1e3, stats.max / 1e3);
+            text += line;
+        }
+    }
+
+    namespace
+    {
+        void write_trace(json_writer & writer, std::vector<profiler::event> const & events)
+        {
+            writer.begin_object();
+            writer.key("displayTimeUnit");
+            writer.value_string("ns");
+            writer.key("traceEvents");
+            writer.begin_array();
+            std::uint32_t thread = 0;
+            for (auto const & event : events)
+            {
+                if (event.thread != thread)
+                {
+                    thread = event.thread;
+                    char name[32];
+                    std::snprintf(name, sizeof(name), "thread %u", thread);
+                    writer.begin_object();
+                    writer.key("name");     writer.value_string("thread_name");
+                    writer.key("ph");       writer.value_string("M");
+                    writer.key("pid");      writer.value_uint64(1);
+                    writer.key("tid");      writer.value_uint64(thread);
+                    writer.key("args");
+                    writer.begin_object();
+                    writer.key("name");     writer.value_string(name);
+                    writer.end_object();
+                    writer.end_object();
+                }
+                writer.begin_object();
+                writer.key("name");     writer.value_string(event.zone->name);
+                writer.key("cat");      writer.value_string("idascm");
+                writer.key("ph");       writer.value_string("X");
+                writer.key("ts");       writer.value_double(event.start / 1e3);
+                writer.key("dur");      writer.value_double(event.duration / 1e3);
+                writer.key("pid");      writer.value_uint64(1);
+                writer.key("tid");      writer.value_uint64(event.thread);
+                writer.key("args");
+                writer.begin_object();
+                writer.key("file");     writer.value_string(event.zone->file);
+                writer.key("line");     writer.value_int64(event.zone->line);
+                writer.end_object();
+                writer.end_object();
+            }
+            writer.end_array();
+            writer.end_object();
+        }
+    }
+
+    void profiler::write_chrome_trace(std::string & json) const
+    {
+        json_writer writer;
+        write_trace(writer, events());
+        json.append(writer.buffer().data(), writer.buffer().size());
+    }
+
+    auto profiler::write_chrome_trace(char const * path) const -> bool
+    {
+        auto const file = std::fopen(path, "wb");
+        if (! file)
+            return false;
+        bool result = false;
+        {
+            json_writer writer(file);
+            write_trace(writer, events());
+            result = writer.flush() && writer.good();
+        }
+        return 0 == std::fclose(file) && result;
+    }
+
+    auto profiler::now(void) const noexcept -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>(steady_ns() - m_epoch);
+    }
+
+    auto profiler::current_thread(void) -> profiler_thread *
+    {
+        if (t_thread)
+            return t_thread;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto thread = std::unique_ptr<profiler_thread>(new (std::nothrow) profiler_thread(static_cast<std::uint32_t>(m_threads.size() + 1)));
+        if (! thread)
+            return nullptr;
+        m_threads.push_back(std::move(thread));
+        t_thread = m_threads.back().get();
+        return t_thread;
+    }
+}
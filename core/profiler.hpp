@@ -0,0 +1,146 @@
+# pragma once
+# include <core/core.hpp>
+# include <atomic>
+# include <cstdint>
+# include <memory>
+# include <mutex>
+# include <string>
+# include <vector>
+
+// profiling zones compiled in (IDASCM_PROFILE=0 removes every zone)
+# if ! defined IDASCM_PROFILE
+#   define IDASCM_PROFILE 1
+# endif
+
+# define IDASCM_PROFILE_CONCAT_(A, B)  A##B
+# define IDASCM_PROFILE_CONCAT(A, B)   IDASCM_PROFILE_CONCAT_(A, B)
+
+// times the rest of the enclosing block, 'name' must be a string literal
+# if IDASCM_PROFILE
+#   define IDASCM_PROFILE_ZONE(name) \
+        static ::idascm::profiler::site const IDASCM_PROFILE_CONCAT(idascm_profile_site_, __LINE__) = { name, __FILE__, __LINE__ }; \
+        ::idascm::profiler::scope const IDASCM_PROFILE_CONCAT(idascm_profile_scope_, __LINE__)(IDASCM_PROFILE_CONCAT(idascm_profile_site_, __LINE__))
+# else
+#   define IDASCM_PROFILE_ZONE(name) ((void) 0)
+# endif
+
+namespace idascm
+{
+    struct profiler_thread;
+
+    // scoped timing zones
+    // every thread records into its own buffer, nothing is shared on the hot path
+    // zones cost a relaxed load while recording is off
+    class profiler
+    {
+        public:
+            // zone definition, one static instance per IDASCM_PROFILE_ZONE expansion
+            struct site
+            {
+                char const *    name;
+                char const *    file;
+                int             line;
+            };
+
+            // single recorded zone
+            struct event
+            {
+                site const *    zone;
+                std::uint64_t   start;      // ns since the profiler was created
+                std::uint64_t   duration;   // ns
+                std::uint32_t   thread;     // profiler thread index, starting at 1
+                std::uint32_t   depth;      // open zones of the thread at entry
+            };
+
+            // per zone aggregate (durations in ns)
+            struct statistics
+            {
+                char const *    name;
+                std::size_t     count;
+                std::uint64_t   total;
+                std::uint64_t   min;
+                std::uint64_t   max;
+                std::uint64_t   p50;
+                std::uint64_t   p90;
+                std::uint64_t   p99;
+            };
+
+            // RAII zone marker
+            class scope
+            {
+                public:
+                    explicit scope(site const & site) noexcept
+                        : m_site(nullptr)
+                    {
+                        if (instance().is_recording())
+                            enter(site);
+                    }
+
+                    ~scope(void) noexcept
+                    {
+                        if (m_site)
+                            leave();
+                    }
+
+                private:
+                    scope(scope const &) = delete;
+                    auto operator = (scope const &) -> scope & = delete;
+
+                    void enter(site const & site) noexcept;
+                    void leave(void) noexcept;
+
+                private:
+                    site const *        m_site;
+                    std::uint64_t       m_start;
+                    profiler_thread *   m_thread;
+            };
+
+        public:
+            static auto instance(void) -> profiler &;
+
+        public:
+            void start(void) noexcept;
+            // zones still open keep recording until they close
+            void stop(void) noexcept;
+
+            auto is_recording(void) const noexcept -> bool
+            {
+                return m_recording.load(std::memory_order_relaxed);
+            }
+
+            // drops everything recorded, no zone may be open on any thread
+            void reset(void);
+
+            // events of every thread, ordered by thread then start time
+            auto events(void) const -> std::vector<event>;
+
+            // per zone name, the largest total first
+            auto summarize(void) const -> std::vector<statistics>;
+
+            // fixed width table of summarize()
+            void write_summary(std::string & text) const;
+
+            // Chrome trace_event JSON (chrome://tracing, Perfetto), complete events in microseconds
+            void write_chrome_trace(std::string & json) const;
+            auto write_chrome_trace(char const * path) const -> bool;
+
+            // ns since the profiler was created
+            auto now(void) const noexcept -> std::uint64_t;
+
+        protected:
+            profiler(void);
+            ~profiler(void);
+
+        private:
+            profiler(profiler const &) = delete;
+            auto operator = (profiler const &) -> profiler & = delete;
+
+            auto current_thread(void) -> profiler_thread *;
+
+        private:
+            std::atomic<bool>                               m_recording;
+            mutable std::mutex                              m_mutex;    // thread list
+            std::vector<std::unique_ptr<profiler_thread>>   m_threads;  // outlive their threads
+            std::int64_t                                    m_epoch;    // steady clock ns
+    };
+}
@@ -0,0 +1,84 @@
+# include <core/string_table.hpp>
+# include <core/memory_report.hpp>
+# include <algorithm>
+
+namespace idascm
+{
+    auto string_table::instance(void) -> string_table &
+    {
+        static string_table instance;
+        return instance;
+    }
+
+    string_table::string_table(void)
+        : m_arena(64 * 1024)
+        , m_count(0)
+    {
+        for (auto & chunk : m_chunks)
+            chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    string_table::~string_table(void) noexcept
+    {}
+
+    auto string_table::intern(std::string_view string) -> interned_string
+    {
+        if (string.empty() || string.size() > 0xffffffffu)
+            return interned_string();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto const found = m_index.find(string);
+        if (found != m_index.end())
+            return interned_string(found->second);
+        auto const count = m_count.load(std::memory_order_relaxed);
+        if (count + 1 >= chunk_size * chunk_count)
+            return interned_string();
+        // ids start at 1, slot 0 of the first chunk stays empty
+        auto const id = static_cast<string_id>(count + 1);
+        auto chunk = m_chunks[id / chunk_size].load(std::memory_order_relaxed);
+        if (! chunk)
+        {
+            chunk = m_arena.make_array<string_table_entry const *>(chunk_size);
+            if (! chunk)
+                return interned_string();
+            std::fill(chunk, chunk + chunk_size, nullptr);
+            m_chunks[id / chunk_size].store(chunk, std::memory_order_release);
+        }
+        auto const text = m_arena.store(string);
+        auto const entry = m_arena.make<string_table_entry>(id, static_cast<std::uint32_t>(string.size()), text.data());
+        if (! text.data() || ! entry)
+            return interned_string();
+        m_index.emplace(text, entry);
+        chunk[id % chunk_size] = entry;
+        m_count.store(count + 1, std::memory_order_release);
+        return interned_string(entry);
+    }
+
+    auto string_table::find(std::string_view string) const -> interned_string
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto const found = m_index.find(string);
+        if (found != m_index.end())
+            return interned_string(found->second);
+        return interned_string();
+    }
+
+    // 'id' must come from this table, its publication orders the entry
+    auto string_table::get(string_id id) const noexcept -> interned_string
+    {
+        if (! id || id > m_count.load(std::memory_order_acquire))
+            return interned_string();
+        auto const chunk = m_chunks[id / chunk_size].load(std::memory_order_acquire);
+        return interned_string(chunk[id % chunk_size]);
+    }
+
+    auto string_table::memory_usage(void) const -> memory_report
+    {
+        memory_report report;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        report.add("arena", m_arena.capacity());
+        // unordered_map node: the pair, a next pointer and the cached hash
+        auto const node = sizeof(index::value_type) + 2 * sizeof(void *);
+        report.add("index", m_index.bucket_count() * sizeof(void *) + m_index.size() * node);
+        return report;
+    }
+}
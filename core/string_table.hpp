@@ -0,0 +1,138 @@
+# pragma once
+# include <core/core.hpp>
+# include <core/arena.hpp>
+# include <atomic>
+# include <cstdint>
+# include <mutex>
+# include <string_view>
+# include <unordered_map>
+
+namespace idascm
+{
+    class memory_report;
+
+    // small stable string identifier, 0 - empty string
+    using string_id = std::uint32_t;
+
+    struct string_table_entry
+    {
+        string_id       id;
+        std::uint32_t   length;
+        char const *    text;   // zero terminated
+    };
+
+    // handle to a string stored once in a string_table
+    // equal strings share their entry, so comparing handles is a pointer compare
+    class interned_string
+    {
+        public:
+            auto id(void) const noexcept -> string_id
+            {
+                return m_entry ? m_entry->id : 0;
+            }
+
+            auto view(void) const noexcept -> std::string_view
+            {
+                return m_entry ? std::string_view(m_entry->text, m_entry->length) : std::string_view();
+            }
+
+            auto c_str(void) const noexcept -> char const *
+            {
+                return m_entry ? m_entry->text : "";
+            }
+
+            auto size(void) const noexcept -> std::size_t
+            {
+                return m_entry ? m_entry->length : 0;
+            }
+
+            auto empty(void) const noexcept -> bool
+            {
+                return ! m_entry;
+            }
+
+        public:
+            interned_string(void) noexcept
+                : m_entry(nullptr)
+            {}
+
+            friend auto operator == (interned_string const & lhs, interned_string const & rhs) noexcept -> bool
+            {
+                return lhs.m_entry == rhs.m_entry;
+            }
+
+            friend auto operator != (interned_string const & lhs, interned_string const & rhs) noexcept -> bool
+            {
+                return lhs.m_entry != rhs.m_entry;
+            }
+
+        private:
+            friend class string_table;
+            explicit interned_string(string_table_entry const * entry) noexcept
+                : m_entry(entry)
+            {}
+
+        private:
+            string_table_entry const * m_entry;
+    };
+
+    inline auto operator == (interned_string const & lhs, std::string_view rhs) noexcept -> bool
+    {
+        return lhs.view() == rhs;
+    }
+
+    inline auto operator != (interned_string const & lhs, std::string_view rhs) noexcept -> bool
+    {
+        return lhs.view() != rhs;
+    }
+
+    // append-only string pool, strings live as long as the table
+    // interning is serialized, id lookups are lock-free
+    class string_table
+    {
+        public:
+            // process wide table (command text of every version)
+            static auto instance(void) -> string_table &;
+
+        public:
+            // empty handle for empty strings and when the table is full
+            auto intern(std::string_view string) -> interned_string;
+            // empty handle if 'string' was never interned
+            auto find(std::string_view string) const -> interned_string;
+            auto get(string_id id) const noexcept -> interned_string;
+
+            // distinct non-empty strings
+            auto size(void) const noexcept -> std::size_t
+            {
+                return m_count.load(std::memory_order_acquire);
+            }
+
+            // arena (text, entries, id chunks) and index, the index is estimated from its node count
+            auto memory_usage(void) const -> memory_report;
+
+        public:
+            string_table(void);
+            ~string_table(void) noexcept;
+
+        private:
+            string_table(string_table const &) = delete;
+            auto operator = (string_table const &) -> string_table & = delete;
+
+        private:
+            enum : std::size_t
+            {
+                chunk_size  = 4096,
+                chunk_count = 1024,
+            };
+
+        private:
+            using index = std::unordered_map<std::string_view, string_table_entry const *>;
+
+        private:
+            mutable std::mutex                          m_mutex;                // arena and index
+            arena                                       m_arena;                // entries, text and chunks
+            index                                       m_index;
+            std::atomic<string_table_entry const **>    m_chunks[chunk_count];  // id to entry
+            std::atomic<std::size_t>                    m_count;
+    };
+}
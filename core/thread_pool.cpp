@@ -0,0 +1,197 @@
+# include <core/thread_pool.hpp>
+# include <chrono>
+# include <cstdlib>
+
+namespace idascm
+{
+    namespace
+    {
+        // worker identity of the current thread
+        thread_local thread_pool const *    t_pool  = nullptr;
+        thread_local std::size_t            t_index = 0;
+    }
+
+    auto thread_pool::instance(void) -> thread_pool &
+    {
+        static thread_pool instance;
+        return instance;
+    }
+
+    auto thread_pool::default_thread_count(void) noexcept -> std::size_t
+    {
+        if (auto const value = std::getenv("IDASCM_THREADS"))
+        {
+            auto const count = std::strtoul(value, nullptr, 10);
+            if (count > 0)
+                return count;
+        }
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    thread_pool::thread_pool(std::size_t thread_count)
+        : m_queued(0)
+        , m_sleeping(0)
+        , m_stop(false)
+    {
+        if (! thread_count)
+            thread_count = default_thread_count();
+        m_workers.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++ i)
+            m_workers.emplace_back(new worker);
+        for (std::size_t i = 0; i < thread_count; ++ i)
+            m_workers[i]->thread = std::thread([this, i] { run(i); });
+    }
+
+    // pending tasks are still executed
+    thread_pool::~thread_pool(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto & worker : m_workers)
+            worker->thread.join();
+    }
+
+    void thread_pool::submit(task && task)
+    {
+        auto const index = self();
+        if (index < m_workers.size())
+        {
+            std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+            m_workers[index]->tasks.push_back(std::move(task));
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_injection.push_back(std::move(task));
+        }
+        // pairs with the sleeper's increment and re-check in run()
+        m_queued.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_seq_cst))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wake.notify_one();
+        }
+    }
+
+    auto thread_pool::try_run_one(void) -> bool
+    {
+        task task;
+        if (! take(self(), task))
+            return false;
+        task();
+        return true;
+    }
+
+    void thread_pool::run(std::size_t index)
+    {
+        t_pool  = this;
+        t_index = index;
+        for (;;)
+        {
+            task task;
+            if (take(index, task))
+            {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stop && ! m_queued.load(std::memory_order_seq_cst))
+                break;
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            m_wake.wait(lock, [this] { return m_stop || m_queued.load(std::memory_order_seq_cst); });
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // own deque (newest first), then the injection queue, then the other workers (oldest first)
+    auto thread_pool::take(std::size_t index, task & task) -> bool
+    {
+        if (! m_queued.load(std::memory_order_acquire))
+            return false;
+        auto const count = m_workers.size();
+        if (index < count)
+        {
+            auto & own = *m_workers[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (! own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (! m_injection.empty())
+            {
+                task = std::move(m_injection.front());
+                m_injection.pop_front();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (std::size_t i = 1; i <= count; ++ i)
+        {
+            auto const other = (index + i) % count;
+            if (other == index)
+                continue;
+            auto & victim = *m_workers[other];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (! victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // worker index of the calling thread, thread_count() for foreign threads
+    auto thread_pool::self(void) const noexcept -> std::size_t
+    {
+        return t_pool == this ? t_index : m_workers.size();
+    }
+
+    void task_group::wait(void)
+    {
+        while (! is_done())
+            help();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(error, m_error);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // the group may be destroyed as soon as a waiter sees no pending task,
+    // decrement and notify under the mutex the waiters check it with
+    void task_group::finish(void)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (1 == m_pending.fetch_sub(1, std::memory_order_acq_rel))
+            m_done.notify_all();
+    }
+
+    auto task_group::is_done(void) -> bool
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return ! m_pending.load(std::memory_order_acquire);
+    }
+
+    // runs someone's task, or sleeps briefly when the remaining ones are already running elsewhere
+    void task_group::help(void)
+    {
+        if (m_pool.try_run_one())
+            return;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait_for(lock, std::chrono::microseconds(200), [this] { return ! m_pending.load(std::memory_order_acquire); });
+    }
+}
@@ -0,0 +1,192 @@
+# pragma once
+# include <core/core.hpp>
+# include <algorithm>
+# include <atomic>
+# include <condition_variable>
+# include <cstddef>
+# include <deque>
+# include <exception>
+# include <functional>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <utility>
+# include <vector>
+
+namespace idascm
+{
+    // work-stealing pool
+    // each worker owns a deque: it pushes and pops at the back, idle workers steal from the front
+    // tasks submitted from outside the pool go through a shared injection queue
+    // threads waiting on a task_group run pending tasks instead of blocking, so nesting is safe
+    class thread_pool
+    {
+        public:
+            using task = std::function<void(void)>;
+
+        public:
+            static auto instance(void) -> thread_pool &;
+
+            // IDASCM_THREADS environment variable if set, otherwise hardware concurrency
+            static auto default_thread_count(void) noexcept -> std::size_t;
+
+        public:
+            void submit(task && task);
+
+            // runs one pending task on the calling thread, false if there was none
+            auto try_run_one(void) -> bool;
+
+            auto thread_count(void) const noexcept -> std::size_t
+            {
+                return m_workers.size();
+            }
+
+        public:
+            // 0 - default_thread_count()
+            explicit thread_pool(std::size_t thread_count = 0);
+            ~thread_pool(void);
+
+        private:
+            thread_pool(thread_pool const &) = delete;
+            auto operator = (thread_pool const &) -> thread_pool & = delete;
+
+        private:
+            struct worker
+            {
+                std::mutex          mutex;
+                std::deque<task>    tasks;
+                std::thread         thread;
+            };
+
+            void run(std::size_t index);
+            auto take(std::size_t index, task & task) -> bool;
+            auto self(void) const noexcept -> std::size_t;
+
+        private:
+            std::vector<std::unique_ptr<worker>>    m_workers;
+            std::mutex                              m_mutex;        // injection queue and sleeping
+            std::deque<task>                        m_injection;
+            std::condition_variable                 m_wake;
+            std::atomic<std::size_t>                m_queued;       // tasks not yet taken
+            std::atomic<std::size_t>                m_sleeping;
+            bool                                    m_stop;
+    };
+
+    // set of tasks that can be waited for together
+    // the first exception thrown by a task is rethrown by wait()
+    class task_group
+    {
+        public:
+            template <typename function>
+            void run(function && fn)
+            {
+                m_pending.fetch_add(1, std::memory_order_relaxed);
+                m_pool.submit([this, fn = std::forward<function>(fn)](void) mutable
+                {
+                    try
+                    {
+                        fn();
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        if (! m_error)
+                            m_error = std::current_exception();
+                    }
+                    finish();
+                });
+            }
+
+            // helps running pool tasks until every task of the group is done
+            void wait(void);
+
+        public:
+            explicit task_group(thread_pool & pool = thread_pool::instance())
+                : m_pool(pool)
+                , m_pending(0)
+            {}
+
+            ~task_group(void) noexcept
+            {
+                while (! is_done())
+                    help();
+            }
+
+        private:
+            task_group(task_group const &) = delete;
+            auto operator = (task_group const &) -> task_group & = delete;
+
+        private:
+            void finish(void);
+            void help(void);
+            auto is_done(void) -> bool;
+
+        private:
+            thread_pool &               m_pool;
+            std::atomic<std::size_t>    m_pending;      // the last decrement is made under m_mutex
+            std::mutex                  m_mutex;
+            std::condition_variable     m_done;
+            std::exception_ptr          m_error;
+    };
+
+    // fn(begin, end) over [first, last) split into 'grain' sized chunks
+    // chunks are handed out dynamically, the calling thread takes part
+    template <typename function>
+    void parallel_for(thread_pool & pool, std::size_t first, std::size_t last, std::size_t grain, function && fn)
+    {
+        if (first >= last)
+            return;
+        grain = std::max<std::size_t>(grain, 1);
+        auto const count = (last - first + grain - 1) / grain;
+        if (1 == count)
+        {
+            fn(first, last);
+            return;
+        }
+        std::atomic<std::size_t> next(0);
+        auto body = [&](void)
+        {
+            for (std::size_t chunk; (chunk = next.fetch_add(1, std::memory_order_relaxed)) < count; )
+            {
+                auto const begin = first + chunk * grain;
+                fn(begin, std::min(begin + grain, last));
+            }
+        };
+        task_group group(pool);
+        auto const helpers = std::min(count - 1, pool.thread_count());
+        for (std::size_t i = 0; i < helpers; ++ i)
+            group.run(body);
+        body();
+        group.wait();
+    }
+
+    template <typename function>
+    void parallel_for(std::size_t first, std::size_t last, std::size_t grain, function && fn)
+    {
+        parallel_for(thread_pool::instance(), first, last, grain, std::forward<function>(fn));
+    }
+
+    // map(begin, end) -> type per 'grain' sized chunk, then reduce(accumulator, chunk result) in chunk order
+    // chunking depends on 'grain' only, so the result does not depend on the thread count or scheduling
+    template <typename type, typename map_function, typename reduce_function>
+    auto parallel_reduce(thread_pool & pool, std::size_t first, std::size_t last, std::size_t grain, type identity, map_function && map, reduce_function && reduce) -> type
+    {
+        if (first >= last)
+            return identity;
+        grain = std::max<std::size_t>(grain, 1);
+        auto const count = (last - first + grain - 1) / grain;
+        std::vector<type> partial(count, identity);
+        parallel_for(pool, 0, count, 1, [&](std::size_t begin, std::size_t end)
+        {
+            for (auto chunk = begin; chunk < end; ++ chunk)
+            {
+                auto const chunk_first = first + chunk * grain;
+                partial[chunk] = map(chunk_first, std::min(chunk_first + grain, last));
+            }
+        });
+        type result = identity;
+        for (auto & value : partial)
+            result = reduce(std::move(result), std::move(value));
+        return result;
+    }
+}
@@ -33,12 +33,19 @@ namespace idascm
 
     auto argument_type_from_string(char const * string) noexcept -> argument_type
     {
-        if (string && string[0])
+        if (string)
+            return argument_type_from_string(std::string_view(string));
+        return argument_type::unknown;
+    }
+
+    auto argument_type_from_string(std::string_view string) noexcept -> argument_type
+    {
+        if (! string.empty())
         {
             for (auto const & row : g_argument_type_table)
             {
                 for (auto s : row.strings)
-                    if (s && s[0] && 0 == std::strcmp(string, s))
+                    if (s && s[0] && string == s)
                         return row.type;
             }
         }
@@ -58,7 +65,7 @@ namespace idascm
             return false;
         if (first.argument_count != second.argument_count)
             return false;
-        if (0 != std::strncmp(first.name, second.name, std::size(first.name) - 1))
+        if (first.name != second.name)
             return false;
         for (std::size_t i = 0; i < std::min<std::size_t>(first.argument_count, std::size(first.argument_list)); ++ i)
             if (first.argument_list[i] != second.argument_list[i])
@@ -109,7 +116,7 @@ namespace idascm
         auto const name = object["name"].to_primitive();
         if (name.is_valid())
         {
-            std::strncpy(command.name, name.c_str(), std::size(command.name) - 1);
+            command.name = string_table::instance().intern(name.to_string());
         }
 
         auto const flags = object["flags"].to_array();
@@ -129,7 +136,9 @@ namespace idascm
         auto const arguments = object["args"];
         if (arguments.type() == json_type::primitive)
         {
-            command.argument_count = std::atoi(arguments.to_primitive().c_str());
+            std::uint64_t count = 0;
+            arguments.to_primitive().to_uint64(count);
+            command.argument_count = static_cast<std::uint8_t>(std::min<std::uint64_t>(count, std::size(command.argument_list)));
             for (std::size_t i = 0; i < command.argument_count; ++ i)
             {
                 command.argument_list[i] = argument_type::any;
@@ -154,7 +163,7 @@ namespace idascm
         auto comment = object["comment"].to_primitive();
         if (comment.is_valid())
         {
-            command.comment = comment.to_string();
+            command.comment = string_table::instance().intern(comment.to_string());
         }
 
         return command;
@@ -1,6 +1,7 @@
 # pragma once
 # include <engine/engine.hpp>
-# include <string>
+# include <core/string_table.hpp>
+# include <string_view>
 
 namespace idascm
 {
@@ -30,6 +31,7 @@ namespace idascm
         string64    = character | 8, // 8-byte string
     };
     auto argument_type_from_string(char const * string) noexcept -> argument_type;
+    auto argument_type_from_string(std::string_view string) noexcept -> argument_type;
     auto argument_type_from_json(json_value const & value) noexcept -> argument_type;
 
     enum command_flag : std::uint8_t
@@ -49,14 +51,25 @@ namespace idascm
     // TODO: move out opcode field
     struct command
     {
-        char            name[64];
-        std::uint8_t    flags;
-        std::uint8_t    argument_count;
-        argument_type   argument_list[24];
-        std::string     comment;
+        interned_string     name;
+        std::uint8_t        flags;
+        std::uint8_t        argument_count;
+        argument_type       argument_list[24];
+        interned_string     comment;
     };
 
     auto operator == (command const & first, command const & second) noexcept -> bool;
 
+    // text of a command rendered once, when it is added to its command_set
+    // views live as long as the set, non-empty ones are zero terminated
+    struct command_text
+    {
+        std::string_view    annotation;     // "0x004f - comment (flags: call)", the comment part only if there is one
+        std::string_view    mnemonic;       // name, UNKNOWN_0x%04x if it has none
+        std::string_view    mnemonic_not;   // "NOT " + mnemonic
+        std::string_view    flags;          // "call, condition", empty without flags
+    };
+
+    // text is interned in string_table::instance()
     auto command_from_json(json_object const & object) -> command;
 }
@@ -1,7 +1,9 @@
+# define IDASCM_LOG_SUBSYSTEM isa
 # include <engine/command_manager.hpp>
 # include <engine/command_set.hpp>
-# include <core/json.hpp>
 # include <core/logger.hpp>
+# include <core/memory_report.hpp>
+# include <core/profiler.hpp>
 # include <algorithm>
 # include <string>
 # if defined _WIN32
@@ -10,27 +12,9 @@
 
 namespace idascm
 {
-    namespace
-    {
-        auto load_json_object(std::string root, version ver) -> json_object
-        {
-            std::string const path = root + "/" + std::string(to_string(ver)) + ".json";
-            IDASCM_LOG_I("Loading commands from '%s'", path.c_str());
-            auto const json = json_value::from_file(path.c_str());
-            if (json.is_valid())
-            {
-                auto const object = json.to_object();
-                if (object.is_valid())
-                {
-                    return object;
-                }
-            }
-            return {};
-        }
-    }
-
     command_manager::command_manager(char const * root_path)
         : m_uuid_count(0)
+        , m_stale(false)
     {
         std::strncpy(m_root_path, root_path ? root_path : "", sizeof(m_root_path) - 1);
         std::memset(m_set_map, 0, sizeof(m_set_map));
@@ -38,7 +22,42 @@ namespace idascm
         std::memset(m_cmd_to_uuid_map, 0x00, sizeof(m_cmd_to_uuid_map));
     }
 
+    command_manager::~command_manager(void)
+    {
+        for (auto & set : m_set_map)
+        {
+            delete set;
+            set = nullptr;
+        }
+    }
+
     auto command_manager::get_set(version ver) noexcept -> command_set const *
+    {
+        auto const set = load_missing(ver);
+        rebuild_uuids();
+        return set;
+    }
+
+    auto command_manager::load_sets(version const * versions, std::size_t count, bool rebuild) noexcept -> std::size_t
+    {
+        std::size_t available = 0;
+        for (std::size_t i = 0; i < count; ++ i)
+        {
+            if (load_missing(versions[i]))
+                ++ available;
+        }
+        if (rebuild)
+            rebuild_uuids();
+        return available;
+    }
+
+    void command_manager::rebuild_uuids(void)
+    {
+        if (m_stale)
+            reload();
+    }
+
+    auto command_manager::load_missing(version ver) -> command_set const *
     {
         auto const index = to_uint(ver);
         if (index >= std::size(m_set_map))
@@ -46,39 +65,32 @@ namespace idascm
         if (! m_set_map[index])
         {
             m_set_map[index] = load_set(ver);
-            reload();
+            m_stale |= nullptr != m_set_map[index];
         }
         return m_set_map[index];
     }
 
     auto command_manager::load_set(version ver) -> command_set *
     {
-        auto object = load_json_object(m_root_path, ver);
-        if (! object.is_valid())
-            return nullptr;
-        if (to_version(object["version"].to_primitive().c_str()) != ver)
-            return false;
-        command_set const * parent_set = nullptr;
-        auto parent = object["parent"].to_primitive();
-        if (parent.is_valid())
-        {
-            parent_set = get_set(to_version(parent.c_str()));
-            if (! parent_set)
-                return nullptr;
-        }
-        auto commands = object["commands"].to_object();
-        if (commands.is_valid())
+        IDASCM_PROFILE_ZONE("command_manager::load_set");
+        std::string const path = std::string(m_root_path) + "/" + std::string(to_string(ver)) + ".json";
+        IDASCM_LOG_I("Loading commands from '%s'", path.c_str());
+        auto set = new command_set(ver);
+        version parent = version::unknown;
+        if (set->load_file(path.c_str(), parent))
         {
-            auto set = new command_set(ver);
-            if (set->set_parent(parent_set))
+            command_set const * parent_set = nullptr;
+            if (version::unknown != parent)
+                parent_set = load_missing(parent);
+            if (version::unknown == parent || parent_set)
             {
-                if (set->load(commands))
+                if (set->set_parent(parent_set))
                 {
                     return set;
                 }
             }
-            delete set;
         }
+        delete set;
         return nullptr;
     }
 
@@ -87,6 +99,7 @@ namespace idascm
         std::memset(m_uuid_to_cmd_map, 0x00, sizeof(m_uuid_to_cmd_map));
         std::memset(m_cmd_to_uuid_map, 0x00, sizeof(m_cmd_to_uuid_map));
         m_uuid_count = 1; // uuid 0 is reserved as invalid value
+        m_stale = false;
         for (std::size_t ver = 0; ver < std::size(m_set_map); ++ ver)
         {
             if (! m_set_map[ver])
@@ -119,4 +132,21 @@ namespace idascm
             }
         }
     }
+
+    auto command_manager::memory_usage(void) const -> memory_report
+    {
+        memory_report report;
+        report.add("object", sizeof(*this) - sizeof(m_set_map) - sizeof(m_cmd_to_uuid_map) - sizeof(m_uuid_to_cmd_map));
+        report.add("set map", sizeof(m_set_map));
+        report.add("uuid maps", sizeof(m_cmd_to_uuid_map) + sizeof(m_uuid_to_cmd_map));
+        for (std::size_t ver = 0; ver < std::size(m_set_map); ++ ver)
+        {
+            if (auto const set = m_set_map[ver])
+            {
+                auto const name = to_string(set->get_version());
+                report.add(name ? name : "unknown", set->memory_usage());
+            }
+        }
+        return report;
+    }
 }
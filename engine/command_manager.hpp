@@ -1,18 +1,29 @@
 # pragma once
 # include <engine/version.hpp>
 # include <algorithm>
+# include <iterator>
 
 namespace idascm
 {
     struct command;
     class command_set;
+    class memory_report;
 
     // packed command set manager
     class command_manager
     {
         public:
+            // loads the set (and its parent) if it is missing, then rebuilds the uuid maps
             auto get_set(version impl) noexcept -> command_set const *;
 
+            // loads the missing sets of 'versions' with a single uuid rebuild, returns how many are available
+            // 'rebuild' false leaves the uuid maps stale (get_command_uuid, get_command(ver, opcode)
+            // do not see the new sets) until rebuild_uuids(), so loads spread over several calls
+            // pay for one rebuild
+            auto load_sets(version const * versions, std::size_t count, bool rebuild = true) noexcept -> std::size_t;
+            // rebuilds the uuid maps if sets were loaded since the last rebuild
+            void rebuild_uuids(void);
+
             // opcode to uuid
             auto get_command_uuid(version ver, std::uint16_t opcode) const noexcept -> std::uint16_t
             {
@@ -36,12 +47,23 @@ namespace idascm
                 return nullptr;
             }
 
+            // uuid maps and every loaded set, as "<version>/<entry>"
+            auto memory_usage(void) const -> memory_report;
+
         public:
             explicit command_manager(char const * root_path);
+            // frees every loaded set
+            ~command_manager(void);
+
+        private:
+            command_manager(command_manager const &) = delete;
+            auto operator = (command_manager const &) -> command_manager & = delete;
 
         protected:
             void reload(void);
             auto load_set(version ver) -> command_set *;
+            // m_set_map entry of 'ver', loaded if missing, the uuid maps are left stale
+            auto load_missing(version ver) -> command_set const *;
 
         private:
             char                m_root_path[1024];
@@ -49,5 +71,6 @@ namespace idascm
             std::uint16_t       m_cmd_to_uuid_map[0x100][0x1000];   // version:opcode to uuid
             command const *     m_uuid_to_cmd_map[0x10000];         // uuid to command
             std::uint16_t       m_uuid_count;
+            bool                m_stale;                            // sets loaded since the last reload()
     };
 }
@@ -0,0 +1,87 @@
+# define IDASCM_LOG_SUBSYSTEM isa
+# include <engine/command_preloader.hpp>
+# include <engine/command_manager.hpp>
+# include <core/logger.hpp>
+# include <core/profiler.hpp>
+# include <core/thread_pool.hpp>
+# include <chrono>
+# include <memory>
+
+namespace idascm
+{
+    // the pool is created first, so it outlives static preloaders
+    command_preloader::command_preloader(command_manager & manager)
+        : command_preloader(manager, thread_pool::instance())
+    {}
+
+    command_preloader::command_preloader(command_manager & manager, thread_pool & pool)
+        : m_manager(manager)
+        , m_pool(pool)
+    {}
+
+    command_preloader::~command_preloader(void)
+    {
+        wait();
+    }
+
+    auto command_preloader::start(std::vector<version> versions) -> bool
+    {
+        if (m_loaded.valid())
+            return false;
+        auto const promise = std::make_shared<std::promise<std::size_t>>();
+        m_loaded = promise->get_future().share();
+        m_pool.submit([this, promise, versions = std::move(versions)](void)
+        {
+            IDASCM_PROFILE_ZONE("command_preloader::load");
+            try
+            {
+                // a set at a time so get_set() gets in between, the uuid maps are rebuilt once
+                std::size_t count = 0;
+                for (auto const ver : versions)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    count += m_manager.load_sets(&ver, 1, false);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_manager.rebuild_uuids();
+                }
+                IDASCM_LOG_I("Preloaded %zu of %zu command sets", count, versions.size());
+                promise->set_value(count);
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return true;
+    }
+
+    auto command_preloader::is_ready(void) const -> bool
+    {
+        return ! m_loaded.valid() || std::future_status::ready == m_loaded.wait_for(std::chrono::seconds(0));
+    }
+
+    void command_preloader::wait(void) const
+    {
+        if (is_ready())
+            return;
+        IDASCM_PROFILE_ZONE("command_preloader::wait");
+        // a queued load may be stuck behind other tasks, help instead of sleeping
+        while (! is_ready())
+        {
+            if (! m_pool.try_run_one())
+            {
+                m_loaded.wait();
+                break;
+            }
+        }
+    }
+
+    auto command_preloader::get_set(version ver) -> command_set const *
+    {
+        IDASCM_PROFILE_ZONE("command_preloader::get_set");
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_manager.get_set(ver);
+    }
+}
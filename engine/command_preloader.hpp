@@ -0,0 +1,63 @@
+# pragma once
+# include <engine/version.hpp>
+# include <future>
+# include <mutex>
+# include <vector>
+
+namespace idascm
+{
+    class command_manager;
+    class command_set;
+    class thread_pool;
+
+    // loads command sets into a command_manager on a thread pool, so a processor module can
+    // start reading ISA files at init time and only wait if a set is needed before they are in
+    // sets are loaded one at a time, get_set() shares the manager with the load between them;
+    // the uuid maps are rebuilt once at the end, anything else touching the manager waits for
+    // the whole load (wait())
+    // start(), get_set() and wait() are meant for a single (UI) thread
+    class command_preloader
+    {
+        public:
+            // queues the load of 'versions', missing ones are skipped
+            // false if a load was already started
+            auto start(std::vector<version> versions) -> bool;
+
+            // completion handle (sets available once loaded), invalid before start()
+            auto handle(void) const -> std::shared_future<std::size_t>
+            {
+                return m_loaded;
+            }
+
+            auto is_started(void) const noexcept -> bool
+            {
+                return m_loaded.valid();
+            }
+
+            // true when nothing was started
+            auto is_ready(void) const -> bool;
+
+            // runs pending pool tasks while the load is queued, then blocks until it is over
+            void wait(void) const;
+
+            // the set as soon as it is loaded, at most after the set being loaded right now;
+            // a set the load has not reached yet is loaded synchronously
+            auto get_set(version ver) -> command_set const *;
+
+        public:
+            explicit command_preloader(command_manager & manager);
+            command_preloader(command_manager & manager, thread_pool & pool);
+            // waits for the load
+            ~command_preloader(void);
+
+        private:
+            command_preloader(command_preloader const &) = delete;
+            auto operator = (command_preloader const &) -> command_preloader & = delete;
+
+        private:
+            command_manager &               m_manager;
+            thread_pool &                   m_pool;
+            std::mutex                      m_mutex;    // manager access until the load is over
+            std::shared_future<std::size_t> m_loaded;
+    };
+}
@@ -1,6 +1,13 @@
+# define IDASCM_LOG_SUBSYSTEM isa
 # include <engine/command_set.hpp>
 # include <core/logger.hpp>
 # include <core/json.hpp>
+# include <core/json_reader.hpp>
+# include <core/memory_report.hpp>
+# include <core/profiler.hpp>
+# include <cstdio>
+# include <cstring>
+# include <string>
 
 namespace idascm
 {
@@ -8,8 +15,10 @@ namespace idascm
         : m_parent(nullptr)
         , m_version(ver)
         , m_count(0)
+        , m_text_arena(64 * 1024)
     {
         std::memset(m_lookup, 0, sizeof(m_lookup));
+        std::memset(m_text, 0, sizeof(m_text));
     }
 
     command_set::~command_set(void)
@@ -17,21 +26,295 @@ namespace idascm
 
     namespace
     {
-        auto opcode_from_string(char const * string) -> std::uint16_t
+        auto opcode_from_json(json_value const & value, std::uint16_t & opcode) -> bool
         {
-            if (string[0] == '0' && string[1] == 'x')
-                return static_cast<std::uint16_t>(std::strtoul(string, nullptr, 16));
-            return static_cast<std::uint16_t>(std::strtoul(string, nullptr, 10));
+            std::uint64_t number = 0;
+            if (! value.to_primitive().to_uint64(number) || number > 0xffff)
+                return false;
+            opcode = static_cast<std::uint16_t>(number);
+            return true;
         }
 
-        auto opcode_from_json(json_value const & value) -> std::uint16_t
+        // ISA document event consumer, fills the set as commands close
+        // nesting: 1 - root, 2 - "commands", 3 - command, 4 - "args" / "flags", 5 - argument object
+        // containers of no interest are skipped as a whole
+        class command_set_builder final : public json_handler
         {
-            return opcode_from_string(value.to_primitive().c_str());
+            public:
+                enum class field
+                {
+                    other,
+                    version,
+                    parent,
+                    commands,
+                    name,
+                    args,
+                    flags,
+                    comment,
+                    type,
+                };
+
+            public:
+                auto start_object(void) -> bool override
+                {
+                    ++ m_depth;
+                    if (m_skip)
+                        return true;
+                    switch (m_depth)
+                    {
+                        case 1:
+                            break;
+                        case 2:
+                            if (field::commands == m_root_field)
+                                m_has_commands = true;
+                            else
+                                m_skip = m_depth;
+                            break;
+                        case 3:
+                            m_command = command {};
+                            break;
+                        case 5:
+                            if (field::args == m_field)
+                                add_argument(argument_type::unknown);
+                            else
+                                m_skip = m_depth;
+                            m_argument_field = field::other;
+                            break;
+                        default:
+                            m_skip = m_depth;
+                            break;
+                    }
+                    return true;
+                }
+
+                auto end_object(void) -> bool override
+                {
+                    if (! m_skip && 3 == m_depth && m_opcode_valid)
+                    {
+                        if (! m_set->add_command(m_opcode, m_command))
+                            IDASCM_LOG_W("unable to add command");
+                    }
+                    return leave();
+                }
+
+                auto start_array(void) -> bool override
+                {
+                    ++ m_depth;
+                    if (! m_skip && ! (4 == m_depth && (field::args == m_field || field::flags == m_field)))
+                        m_skip = m_depth;
+                    return true;
+                }
+
+                auto end_array(void) -> bool override
+                {
+                    return leave();
+                }
+
+                auto key(std::string_view key) -> bool override
+                {
+                    if (m_skip)
+                        return true;
+                    switch (m_depth)
+                    {
+                        case 1:
+                            m_root_field = key == "version" ? field::version
+                                         : key == "parent"  ? field::parent
+                                         : key == "commands"? field::commands
+                                         :                    field::other;
+                            break;
+                        case 2:
+                        {
+                            std::uint64_t number = 0;
+                            m_opcode_valid = json_parse_uint64(key, number) && number <= 0xffff;
+                            m_opcode = static_cast<std::uint16_t>(number);
+                            if (! m_opcode_valid)
+                                IDASCM_LOG_W("invalid opcode '%.*s'", static_cast<int>(key.size()), key.data());
+                            break;
+                        }
+                        case 3:
+                            m_field = key == "name"    ? field::name
+                                    : key == "args"    ? field::args
+                                    : key == "flags"   ? field::flags
+                                    : key == "comment" ? field::comment
+                                    :                    field::other;
+                            break;
+                        case 5:
+                            m_argument_field = key == "type" ? field::type : field::other;
+                            break;
+                    }
+                    return true;
+                }
+
+                auto value_string(std::string_view string) -> bool override
+                {
+                    return value(string);
+                }
+
+                auto value_primitive(std::string_view text) -> bool override
+                {
+                    return value(text);
+                }
+
+            public:
+                auto version_name(void) const noexcept -> char const *
+                {
+                    return m_version;
+                }
+
+                auto parent_name(void) const noexcept -> char const *
+                {
+                    return m_parent;
+                }
+
+                auto has_commands(void) const noexcept -> bool
+                {
+                    return m_has_commands;
+                }
+
+            public:
+                explicit command_set_builder(command_set * set)
+                    : m_set(set)
+                    , m_depth(0)
+                    , m_skip(0)
+                    , m_root_field(field::other)
+                    , m_field(field::other)
+                    , m_argument_field(field::other)
+                    , m_opcode(0)
+                    , m_opcode_valid(false)
+                    , m_has_commands(false)
+                    , m_command {}
+                    , m_version {}
+                    , m_parent {}
+                {}
+
+            private:
+                auto leave(void) -> bool
+                {
+                    if (m_skip == m_depth)
+                        m_skip = 0;
+                    -- m_depth;
+                    return true;
+                }
+
+                auto value(std::string_view string) -> bool
+                {
+                    if (m_skip)
+                        return true;
+                    switch (m_depth)
+                    {
+                        case 1:
+                            if (field::version == m_root_field)
+                                copy(m_version, string);
+                            else if (field::parent == m_root_field)
+                                copy(m_parent, string);
+                            break;
+                        case 3:
+                            value_field(string);
+                            break;
+                        case 4:
+                            if (field::args == m_field)
+                            {
+                                add_argument(argument_type_from_string(string));
+                            }
+                            else
+                            {
+                                for (std::uint8_t flag = 1; flag < 0x80; flag <<= 1)
+                                {
+                                    auto const name = to_string(command_flag(flag));
+                                    if (name && string == name)
+                                        m_command.flags |= flag;
+                                }
+                            }
+                            break;
+                        case 5:
+                            if (field::type == m_argument_field && m_command.argument_count)
+                                m_command.argument_list[m_command.argument_count - 1] = argument_type_from_string(string);
+                            break;
+                    }
+                    return true;
+                }
+
+                void value_field(std::string_view string)
+                {
+                    switch (m_field)
+                    {
+                        case field::name:
+                            m_command.name = string_table::instance().intern(string);
+                            break;
+                        case field::comment:
+                            m_command.comment = string_table::instance().intern(string);
+                            break;
+                        case field::args:
+                        {
+                            std::uint64_t count = 0;
+                            json_parse_uint64(string, count);
+                            m_command.argument_count = static_cast<std::uint8_t>(std::min<std::uint64_t>(count, std::size(m_command.argument_list)));
+                            for (std::size_t i = 0; i < m_command.argument_count; ++ i)
+                                m_command.argument_list[i] = argument_type::any;
+                            break;
+                        }
+                        default:
+                            break;
+                    }
+                }
+
+                void add_argument(argument_type type)
+                {
+                    if (m_command.argument_count < std::size(m_command.argument_list))
+                        m_command.argument_list[m_command.argument_count ++] = type;
+                }
+
+                template <std::size_t size>
+                static void copy(char (&dst)[size], std::string_view string)
+                {
+                    auto const length = std::min(string.size(), size - 1);
+                    std::memcpy(dst, string.data(), length);
+                    dst[length] = '\0';
+                }
+
+            private:
+                command_set *   m_set;
+                unsigned        m_depth;
+                unsigned        m_skip;             // depth of the container being skipped, 0 - none
+                field           m_root_field;
+                field           m_field;            // current command member
+                field           m_argument_field;   // current argument object member
+                std::uint16_t   m_opcode;
+                bool            m_opcode_valid;
+                bool            m_has_commands;
+                command         m_command;
+                char            m_version[64];
+                char            m_parent[64];
+        };
+
+        auto finish_document(command_set_builder const & builder, int status, std::size_t position, version ver, version & parent) -> bool
+        {
+            if (json_read_ok != status)
+            {
+                IDASCM_LOG_W("json error %d at offset %zu", status, position);
+                return false;
+            }
+            if (! builder.has_commands())
+                return false;
+            if (to_version(builder.version_name()) != ver)
+                return false;
+            parent = version::unknown;
+            if (builder.parent_name()[0])
+            {
+                parent = to_version(builder.parent_name());
+                if (version::unknown == parent)
+                {
+                    IDASCM_LOG_W("unknown parent '%s'", builder.parent_name());
+                    return false;
+                }
+            }
+            return true;
         }
     }
 
     auto command_set::load(json_object const & commands) -> bool
     {
+        IDASCM_PROFILE_ZONE("command_set::load");
         if (! commands.is_valid())
             return false;
         for (std::size_t i = 0; i < commands.size(); ++ i)
@@ -39,7 +322,12 @@ namespace idascm
             auto const cmd = commands.at(i).to_object();
             if (! cmd.is_valid())
                 continue;
-            std::uint16_t const opcode = opcode_from_json(commands.key_at(i));
+            std::uint16_t opcode = 0;
+            if (! opcode_from_json(commands.key_at(i), opcode))
+            {
+                IDASCM_LOG_W("invalid opcode '%s'", commands.key_at(i).to_primitive().c_str());
+                continue;
+            }
             if (! add_command(opcode, command_from_json(cmd)))
             {
                 IDASCM_LOG_W("unable to add command");
@@ -48,6 +336,24 @@ namespace idascm
         return true;
     }
 
+    auto command_set::load_document(char const * source, std::size_t length, version & parent) -> bool
+    {
+        IDASCM_PROFILE_ZONE("command_set::load_document");
+        command_set_builder builder(this);
+        json_reader reader;
+        auto const status = reader.read(source, length, builder);
+        return finish_document(builder, status, reader.position(), m_version, parent);
+    }
+
+    auto command_set::load_file(char const * path, version & parent) -> bool
+    {
+        IDASCM_PROFILE_ZONE("command_set::load_file");
+        command_set_builder builder(this);
+        json_reader reader;
+        auto const status = reader.read_file(path, builder);
+        return finish_document(builder, status, reader.position(), m_version, parent);
+    }
+
     auto command_set::add_command(std::uint16_t opcode, command const & command) -> bool
     {
         if (m_count >= std::size(m_pool))
@@ -56,12 +362,70 @@ namespace idascm
             return false;
         if (m_lookup[opcode])
             return false;
+        auto const text = render_text(opcode, command);
+        if (! text)
+            return false;
         m_pool[m_count] = command;
+        m_text[m_count] = text;
         m_lookup[opcode] = &m_pool[m_count];
         ++ m_count;
         return true;
     }
 
+    auto command_set::render_text(std::uint16_t opcode, command const & command) -> command_text *
+    {
+        auto const text = m_text_arena.make<command_text>();
+        if (! text)
+            return nullptr;
+
+        std::string flags;
+        for (std::uint8_t i = 0; i < 8; ++ i)
+        {
+            std::uint8_t const flag = 1 << i;
+            if (command.flags & flag)
+            {
+                if (! flags.empty())
+                    flags.append(", ");
+                flags.append(to_string(command_flag(flag)));
+            }
+        }
+
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "0x%04x", opcode);
+        std::string annotation = buffer;
+        if (! command.comment.empty())
+        {
+            annotation.append(" - ");
+            annotation.append(command.comment.view());
+        }
+        if (! flags.empty())
+        {
+            annotation.append(" (flags: ");
+            annotation.append(flags);
+            annotation.append(")");
+        }
+
+        // a single copy, the mnemonic is the tail of the negated one
+        std::string mnemonic = "NOT ";
+        if (! command.name.empty())
+        {
+            mnemonic.append(command.name.view());
+        }
+        else
+        {
+            std::snprintf(buffer, sizeof(buffer), "UNKNOWN_0x%04x", opcode);
+            mnemonic.append(buffer);
+        }
+
+        text->annotation    = m_text_arena.store(annotation);
+        text->mnemonic_not  = m_text_arena.store(mnemonic);
+        text->mnemonic      = text->mnemonic_not.substr(4);
+        text->flags         = m_text_arena.store(flags);
+        if (text->annotation.empty() || text->mnemonic_not.empty() || text->flags.size() != flags.size())
+            return nullptr;
+        return text;
+    }
+
     auto command_set::set_parent(command_set const * parent) -> bool
     {
         if (parent == this)
@@ -69,4 +433,23 @@ namespace idascm
         m_parent = parent;
         return true;
     }
+
+    auto command_set::memory_usage(void) const -> memory_report
+    {
+        memory_report report;
+        report.add("object", sizeof(*this) - sizeof(m_lookup) - sizeof(m_pool) - sizeof(m_text));
+        report.add("text lookup", sizeof(m_text));
+        report.add("lookup", sizeof(m_lookup));
+        report.add("commands", sizeof(m_pool));
+        report.add("text", m_text_arena.capacity());
+        std::size_t strings = 0;
+        for (std::size_t i = 0; i < m_count; ++ i)
+        {
+            // zero terminated, empty strings take no space
+            strings += m_pool[i].name.size() + ! m_pool[i].name.empty();
+            strings += m_pool[i].comment.size() + ! m_pool[i].comment.empty();
+        }
+        report.add("strings", strings, true);
+        return report;
+    }
 }
@@ -2,11 +2,13 @@
 # include <engine/engine.hpp>
 # include <engine/command.hpp>
 # include <engine/version.hpp>
+# include <core/arena.hpp>
 # include <algorithm>
 
 namespace idascm
 {
     class json_object;
+    class memory_report;
 
     // single game implementation
     // opcode database - set of commands
@@ -14,6 +16,13 @@ namespace idascm
     {
         public:
             auto load(json_object const & object) -> bool;
+
+            // single pass load of a whole ISA document ({ "version", "parent", "commands" })
+            // straight from reader events, no token tree is built
+            // fails if the document names another version; 'parent' receives the parent
+            // version (version::unknown if there is none), the caller resolves and sets it
+            auto load_document(char const * source, std::size_t length, version & parent) -> bool;
+            auto load_file(char const * path, version & parent) -> bool;
             auto add_command(std::uint16_t opcode, command const & command) -> bool;
             auto set_parent(command_set const * parent) -> bool;
 
@@ -31,11 +40,35 @@ namespace idascm
                 return nullptr;
             }
 
+            // rendered text of the command get_command() returns
+            auto get_text(std::uint16_t opcode) const noexcept -> command_text const *
+            {
+                if (opcode < std::size(m_lookup))
+                {
+                    if (auto cmd = m_lookup[opcode])
+                        return m_text[cmd - m_pool];
+                }
+                if (m_parent)
+                {
+                    return m_parent->get_text(opcode);
+                }
+                return nullptr;
+            }
+
             auto get_version(void) const noexcept -> version
             {
                 return m_version;
             }
 
+            // commands defined by this set (the parent's not included)
+            auto size(void) const noexcept -> std::size_t
+            {
+                return m_count;
+            }
+
+            // lookup table, command pool and rendered text, names and comments are shared through the string table
+            auto memory_usage(void) const -> memory_report;
+
         public:
             command_set(version ver);
             ~command_set(void);
@@ -44,11 +77,15 @@ namespace idascm
             command_set(command_set const &) = delete;
             auto operator = (command_set const &) -> command_set & = delete;
 
+            auto render_text(std::uint16_t opcode, command const & command) -> command_text *;
+
         private:
             command_set const * m_parent;
             version             m_version;
             command *           m_lookup[0x1000];
             command             m_pool[0x1000];
+            command_text *      m_text[0x1000];     // per pool entry
             std::size_t         m_count;
+            arena               m_text_arena;
     };
 }
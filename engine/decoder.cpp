@@ -1,14 +1,33 @@
 # include <engine/decoder.hpp>
 # include <engine/instruction.hpp>
 # include <engine/command_set.hpp>
-# include <core/logger.hpp>
+# include <engine/decoder_statistics.hpp>
+# include <core/memory_report.hpp>
+# include <core/profiler.hpp>
 # include <cassert>
 
 namespace idascm
 {
+    auto to_string(decode_error error) noexcept -> char const *
+    {
+        switch (error)
+        {
+            case decode_error::none:
+                return "none";
+            case decode_error::unknown_opcode:
+                return "unknown_opcode";
+            case decode_error::bad_operand_type:
+                return "bad_operand_type";
+            case decode_error::truncated:
+                return "truncated";
+        }
+        return nullptr;
+    }
+
     decoder::decoder(void)
         : m_isa(nullptr)
         , m_memory(nullptr)
+        , m_statistics(nullptr)
     {}
 
     decoder::~decoder(void)
@@ -16,11 +35,38 @@ namespace idascm
     }
 
     auto decoder::decode_instruction(std::uint32_t address, instruction & in) const -> std::uint32_t
+    {
+        decode_result result;
+        return decode_instruction(address, in, result);
+    }
+
+    auto decoder::decode_instruction(std::uint32_t address, instruction & in, decode_result & result) const -> std::uint32_t
+    {
+        IDASCM_PROFILE_ZONE("decoder::decode_instruction");
+        auto const size = decode(address, in, result);
+        if (m_statistics)
+        {
+            if (size)
+                m_statistics->record_instruction(in);
+            else
+                m_statistics->record_failure(in.opcode, result.error);
+        }
+        return size;
+    }
+
+    auto decoder::decode(std::uint32_t address, instruction & in, decode_result & result) const -> std::uint32_t
     {
         assert(m_memory && m_isa);
         std::uint32_t ptr    = address;
         std::uint16_t opcode = 0;
-        ptr += m_memory->read(ptr, &opcode);
+        auto const fail = [&](decode_error error, std::uint8_t operand) -> std::uint32_t
+        {
+            result = { error, operand, ptr - address };
+            return 0;
+        };
+        in.opcode  = 0;
+        if (! read_value(ptr, &opcode))
+            return fail(decode_error::truncated, decode_operand_none);
         in.opcode  = opcode & ~0x8000;
         in.flags   = (opcode & 0x8000) ? instruction_flag_not : 0;
         in.address = address;
@@ -28,7 +74,8 @@ namespace idascm
         if (! in.command)
         {
             // no command - no decoding
-            return 0;
+            ptr = address;
+            return fail(decode_error::unknown_opcode, decode_operand_none);
         }
         in.operand_count = 0;
 
@@ -37,27 +84,34 @@ namespace idascm
         {
             if (in.command->argument_list[op] == argument_type::variadic)
                 break;
-            in.operand_list[op].offset  = static_cast<std::uint8_t>(ptr - address);
+            auto & dst = in.operand_list[op];
+            dst.offset  = static_cast<std::uint8_t>(ptr - address);
+            bool complete = true;
             switch (in.command->argument_list[op])
             {
                 case argument_type::string64:
-                    in.operand_list[op].type = operand_type::string64;
-                    in.operand_list[op].size = m_memory->read(ptr, in.operand_list[op].value_string64, 8);
+                    dst.type = operand_type::string64;
+                    dst.size = sizeof(dst.value_string64);
+                    complete = sizeof(dst.value_string64) == m_memory->read(ptr, dst.value_string64, sizeof(dst.value_string64));
                     break;
                 case argument_type::int8:
-                    in.operand_list[op].type = operand_type::int8;
-                    in.operand_list[op].size = m_memory->read(ptr, &in.operand_list[op].value_int8);
+                    dst.type = operand_type::int8;
+                    dst.size = sizeof(dst.value_int8);
+                    complete = sizeof(dst.value_int8) == m_memory->read(ptr, &dst.value_int8);
                     break;
                 case argument_type::int32:
-                    in.operand_list[op].type = operand_type::int32;
-                    in.operand_list[op].size = m_memory->read(ptr, &in.operand_list[op].value_int32);
+                    dst.type = operand_type::int32;
+                    dst.size = sizeof(dst.value_int32);
+                    complete = sizeof(dst.value_int32) == m_memory->read(ptr, &dst.value_int32);
                     break;
                 default:
-                    if (! decode_operand(ptr, in.operand_list[op]))
-                        return 0;
+                    if (! decode_operand(ptr, dst))
+                        return fail(operand_error(ptr, dst.type), op);
                     break;
             }
-            ptr += in.operand_list[op].size;
+            if (! complete)
+                return fail(decode_error::truncated, op);
+            ptr += dst.size;
             ++ op;
         }
         if (in.command->argument_list[op] == argument_type::variadic)
@@ -72,10 +126,7 @@ namespace idascm
                 auto type = operand_type::unknown;
                 auto size = decode_operand_type(ptr, type);
                 if (! size)
-                {
-                    IDASCM_LOG_W("decode_operand_type failed at 0x%08x", ptr);
-                    return 0;
-                }
+                    return fail(operand_error(ptr, operand_type::unknown), op);
                 if (operand_type::none == type)
                 {
                     ptr += size;
@@ -83,16 +134,64 @@ namespace idascm
                 }
                 in.operand_list[op].offset = static_cast<std::uint8_t>(ptr - address);
                 if (! decode_operand(ptr, in.operand_list[op]))
-                    return 0;
+                    return fail(operand_error(ptr, in.operand_list[op].type), op);
                 ptr += in.operand_list[op].size;
                 ++ op;
             }
         }
         in.operand_count = op;
         in.size = (ptr - address);
+        result = { decode_error::none, decode_operand_none, ptr - address };
         return ptr - address;
     }
 
+    auto decoder::operand_error(std::uint32_t address, operand_type type) const -> decode_error
+    {
+        // operand decoders leave the type unknown when the type byte itself was rejected
+        if (operand_type::unknown != type)
+            return decode_error::truncated;
+        std::uint8_t byte = 0;
+        if (sizeof(byte) != m_memory->read(address, &byte))
+            return decode_error::truncated;
+        return decode_error::bad_operand_type;
+    }
+
+    auto decoder::memory_usage(void) const -> memory_report
+    {
+        memory_report report;
+        report.add("object", sizeof(*this));
+        if (m_statistics)
+            report.add("statistics", m_statistics->memory_usage(), true);
+        return report;
+    }
+
+    auto decoder::read_value(std::uint32_t & ptr, void * value, std::uint32_t size) const -> bool
+    {
+        if (size != m_memory->read(ptr, value, size))
+            return false;
+        ptr += size;
+        return true;
+    }
+
+    auto decoder::decode_batch(std::uint32_t address, std::uint32_t end, instruction_batch & batch, decode_result * result) const -> std::uint32_t
+    {
+        decode_result last = { decode_error::none, decode_operand_none, 0 };
+        while (address < end)
+        {
+            batch.emplace_back();
+            auto const size = decode_instruction(address, batch.back(), last);
+            if (! size)
+            {
+                batch.pop_back();
+                break;
+            }
+            address += size;
+        }
+        if (result)
+            *result = last;
+        return address;
+    }
+
     auto decoder::decode_operand(std::uint32_t address, operand & op) const -> std::uint32_t
     {
         assert(m_memory && m_isa);
@@ -103,33 +202,37 @@ namespace idascm
         }
         else
         {
+            op.type = operand_type::unknown;
             return 0;
         }
+        bool complete = false;
         switch (op.type)
         {
             case operand_type::int8:
-                ptr += m_memory->read(ptr, &op.value_int8);
+                complete = read_value(ptr, &op.value_int8);
                 break;
             case operand_type::int16:
-                ptr += m_memory->read(ptr, &op.value_int16);
+                complete = read_value(ptr, &op.value_int16);
                 break;
             case operand_type::int32:
-                ptr += m_memory->read(ptr, &op.value_int32);
+                complete = read_value(ptr, &op.value_int32);
                 break;
             case operand_type::float32:
-                ptr += m_memory->read(ptr, &op.value_float32);
+                complete = read_value(ptr, &op.value_float32);
                 break;
             case operand_type::float16i:
-                ptr += m_memory->read(ptr, &op.value_int16);
+                complete = read_value(ptr, &op.value_int16);
                 break;
             case operand_type::global:
             case operand_type::local:
-                ptr += m_memory->read(ptr, &op.value_int16);
+                complete = read_value(ptr, &op.value_int16);
                 break;
             default:
-                IDASCM_LOG_W("unsupported operand type: %d", op.type);
+                op.type = operand_type::unknown;
                 return 0;
         }
+        if (! complete)
+            return 0;
         op.size = (ptr - address);
         return op.size;
     }
@@ -1,24 +1,52 @@
 # pragma once
 # include <engine/engine.hpp>
+# include <engine/instruction.hpp>
 
 namespace idascm
 {
     class command_set;
+    class decoder_statistics;
+    class memory_report;
     class memory_api;
 
-    struct instruction;
-    struct operand;
+    // why an instruction could not be decoded
+    enum class decode_error : std::uint8_t
+    {
+        none,
+        unknown_opcode,     // no command for the opcode
+        bad_operand_type,   // type byte not valid where it was read
+        truncated,          // instruction runs past the readable memory
+    };
+
+    constexpr std::size_t decode_error_count = 4;
 
-    enum class operand_type : std::uint8_t;
+    auto to_string(decode_error error) noexcept -> char const *;
+
+    // operand index of failures in the opcode itself
+    constexpr std::uint8_t decode_operand_none = 0xff;
+
+    // outcome of a single instruction decode
+    struct decode_result
+    {
+        decode_error    error;
+        std::uint8_t    operand;    // failing operand index or decode_operand_none
+        std::uint32_t   offset;     // failure offset from the instruction address (the size on success)
+    };
 
     // decoder?
     class decoder
     {
         public:
             virtual auto decode_instruction(std::uint32_t address, instruction & in) const -> std::uint32_t;
+            // 0 on failure, the reason is left in 'result', nothing is logged
+            auto decode_instruction(std::uint32_t address, instruction & in, decode_result & result) const -> std::uint32_t;
             virtual auto decode_operand_type(std::uint32_t address, operand_type & type) const -> std::uint32_t = 0;
             virtual auto decode_operand(std::uint32_t address, operand & op) const -> std::uint32_t;
 
+            // decodes [address, end) linearly up to the first failure, appending to 'batch'
+            // returns the address decoding stopped at, 'result' tells why (error none - end reached)
+            auto decode_batch(std::uint32_t address, std::uint32_t end, instruction_batch & batch, decode_result * result = nullptr) const -> std::uint32_t;
+
         public:
             decoder(void);
             virtual ~decoder(void) noexcept;
@@ -33,8 +61,33 @@ namespace idascm
                 m_memory = api;
             }
 
+            // every decode_instruction call is counted into 'stats' (nullptr - off)
+            void set_statistics(decoder_statistics * stats)
+            {
+                m_statistics = stats;
+            }
+
+            // the decoder itself, the attached statistics as shared "statistics/<entry>"
+            auto memory_usage(void) const -> memory_report;
+
+        protected:
+            // reads a whole value or nothing, 'ptr' only advances on success
+            auto read_value(std::uint32_t & ptr, void * value, std::uint32_t size) const -> bool;
+
+            template <typename type>
+            auto read_value(std::uint32_t & ptr, type * value) const -> bool
+            {
+                return read_value(ptr, value, sizeof(type));
+            }
+
+        private:
+            auto decode(std::uint32_t address, instruction & in, decode_result & result) const -> std::uint32_t;
+            // reason of a failed operand decode at 'address', 'type' as left by the operand decoder
+            auto operand_error(std::uint32_t address, operand_type type) const -> decode_error;
+
         protected:
-            command_set const * m_isa;
-            memory_api *        m_memory;
+            command_set const *     m_isa;
+            memory_api *            m_memory;
+            decoder_statistics *    m_statistics;
     };
 }
@@ -0,0 +1,291 @@
+# include <engine/decoder_statistics.hpp>
+# include <engine/command.hpp>
+# include <core/json_writer.hpp>
+# include <core/memory_report.hpp>
+# include <algorithm>
+# include <cstdio>
+# include <thread>
+
+namespace idascm
+{
+    // counters of a single thread
+    // only the owner writes, so increments are a relaxed load and store instead of a locked add
+    struct decoder_counters
+    {
+        using counter = std::atomic<std::uint64_t>;
+
+        std::thread::id     owner;
+        counter             instructions;
+        counter             bytes;
+        counter             failures[decode_error_count];
+        counter             operand_types[decoder_statistics::operand_type_count];
+        counter             variadic_lengths[decoder_statistics::variadic_count];
+        counter             opcodes[decoder_statistics::opcode_count];
+        counter             opcode_failures[decoder_statistics::opcode_count];
+
+        static void increment(counter & value, std::uint64_t amount = 1) noexcept
+        {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        explicit decoder_counters(std::thread::id owner) noexcept
+            : owner(owner)
+            , instructions(0)
+            , bytes(0)
+            , failures {}
+            , operand_types {}
+            , variadic_lengths {}
+            , opcodes {}
+            , opcode_failures {}
+        {}
+    };
+
+    namespace
+    {
+        std::atomic<std::uint64_t> gs_serial(0);
+
+        // counters the thread used last
+        struct counters_cache
+        {
+            std::uint64_t       serial;
+            decoder_counters *  counters;
+        };
+
+        thread_local counters_cache t_cache = {};
+
+        template <std::size_t size>
+        void merge(std::uint64_t (& dst)[size], std::atomic<std::uint64_t> const (& src)[size]) noexcept
+        {
+            for (std::size_t i = 0; i < size; ++ i)
+                dst[i] += src[i].load(std::memory_order_relaxed);
+        }
+
+        void clear(std::atomic<std::uint64_t> * counters, std::size_t size) noexcept
+        {
+            for (std::size_t i = 0; i < size; ++ i)
+                counters[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    decoder_statistics::decoder_statistics(version ver)
+        : m_version(ver)
+        , m_serial(gs_serial.fetch_add(1, std::memory_order_relaxed) + 1)
+    {}
+
+    decoder_statistics::~decoder_statistics(void) noexcept
+    {}
+
+    auto decoder_statistics::counters(void) noexcept -> decoder_counters *
+    {
+        if (m_serial == t_cache.serial)
+            return t_cache.counters;
+        auto const owner = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        decoder_counters * counters = nullptr;
+        for (auto const & block : m_counters)
+        {
+            if (owner == block->owner)
+            {
+                counters = block.get();
+                break;
+            }
+        }
+        if (! counters)
+        {
+            auto block = std::unique_ptr<decoder_counters>(new (std::nothrow) decoder_counters(owner));
+            if (! block)
+                return nullptr;
+            counters = block.get();
+            m_counters.push_back(std::move(block));
+        }
+        t_cache = { m_serial, counters };
+        return counters;
+    }
+
+    void decoder_statistics::record_instruction(instruction const & in) noexcept
+    {
+        auto const counters = this->counters();
+        if (! counters)
+            return;
+        decoder_counters::increment(counters->instructions);
+        decoder_counters::increment(counters->bytes, in.size);
+        decoder_counters::increment(counters->opcodes[in.opcode % opcode_count]);
+        for (std::uint8_t i = 0; i < in.operand_count; ++ i)
+            decoder_counters::increment(counters->operand_types[to_uint(in.operand_list[i].type)]);
+        if (auto const command = in.command)
+        {
+            for (std::uint8_t i = 0; i < command->argument_count; ++ i)
+            {
+                if (argument_type::variadic == command->argument_list[i])
+                {
+                    if (in.operand_count >= i)
+                        decoder_counters::increment(counters->variadic_lengths[in.operand_count - i]);
+                    break;
+                }
+            }
+        }
+    }
+
+    void decoder_statistics::record_failure(std::uint16_t opcode, decode_error error) noexcept
+    {
+        auto const counters = this->counters();
+        if (! counters)
+            return;
+        auto const reason = static_cast<std::size_t>(error);
+        if (reason < decode_error_count)
+            decoder_counters::increment(counters->failures[reason]);
+        decoder_counters::increment(counters->opcode_failures[opcode % opcode_count]);
+    }
+
+    auto decoder_statistics::collect(void) const -> totals
+    {
+        totals result = {};
+        result.opcodes.resize(opcode_count);
+        result.opcode_failures.resize(opcode_count);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto const & counters : m_counters)
+        {
+            result.instructions += counters->instructions.load(std::memory_order_relaxed);
+            result.bytes        += counters->bytes.load(std::memory_order_relaxed);
+            merge(result.failures,          counters->failures);
+            merge(result.operand_types,     counters->operand_types);
+            merge(result.variadic_lengths,  counters->variadic_lengths);
+            for (std::size_t i = 0; i < opcode_count; ++ i)
+            {
+                result.opcodes[i]           += counters->opcodes[i].load(std::memory_order_relaxed);
+                result.opcode_failures[i]   += counters->opcode_failures[i].load(std::memory_order_relaxed);
+            }
+        }
+        return result;
+    }
+
+    void decoder_statistics::reset(void) noexcept
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto const & counters : m_counters)
+        {
+            counters->instructions.store(0, std::memory_order_relaxed);
+            counters->bytes.store(0, std::memory_order_relaxed);
+            clear(counters->failures,           decode_error_count);
+            clear(counters->operand_types,      operand_type_count);
+            clear(counters->variadic_lengths,   variadic_count);
+            clear(counters->opcodes,            opcode_count);
+            clear(counters->opcode_failures,    opcode_count);
+        }
+    }
+
+    auto decoder_statistics::memory_usage(void) const -> memory_report
+    {
+        memory_report report;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        report.add("object", sizeof(*this));
+        report.add("counters", m_counters.size() * sizeof(decoder_counters) + m_counters.capacity() * sizeof(m_counters[0]));
+        return report;
+    }
+
+    void decoder_statistics::write_json(std::string & json) const
+    {
+        auto const totals = collect();
+        char key[16];
+        json_writer writer(2);
+        writer.begin_object();
+        writer.key("version");          writer.value_string(to_string(m_version) ? to_string(m_version) : "unknown");
+        writer.key("instructions");     writer.value_uint64(totals.instructions);
+        writer.key("bytes");            writer.value_uint64(totals.bytes);
+        writer.key("failures");
+        writer.begin_object();
+        for (std::size_t i = 1; i < decode_error_count; ++ i)
+        {
+            writer.key(to_string(decode_error(i)));
+            writer.value_uint64(totals.failures[i]);
+        }
+        writer.end_object();
+        writer.key("operand_types");
+        writer.begin_object();
+        for (std::size_t i = 0; i < operand_type_count; ++ i)
+        {
+            auto const name = to_string(to_operand_type(static_cast<std::uint8_t>(i)));
+            if (! name || ! totals.operand_types[i])
+                continue;
+            writer.key(name);
+            writer.value_uint64(totals.operand_types[i]);
+        }
+        writer.end_object();
+        writer.key("variadic_lengths");
+        writer.begin_array();
+        for (auto const count : totals.variadic_lengths)
+            writer.value_uint64(count);
+        writer.end_array();
+        writer.key("opcodes");
+        writer.begin_object();
+        for (std::size_t i = 0; i < opcode_count; ++ i)
+        {
+            if (! totals.opcodes[i] && ! totals.opcode_failures[i])
+                continue;
+            std::snprintf(key, sizeof(key), "0x%04zx", i);
+            writer.key(key);
+            writer.begin_object();
+            writer.key("decoded");  writer.value_uint64(totals.opcodes[i]);
+            writer.key("failed");   writer.value_uint64(totals.opcode_failures[i]);
+            writer.end_object();
+        }
+        writer.end_object();
+        writer.end_object();
+        json.append(writer.buffer().data(), writer.buffer().size());
+    }
+
+    void decoder_statistics::write_text(std::string & text, std::size_t top) const
+    {
+        auto const totals = collect();
+        char line[256];
+        auto const failures = totals.failures[1] + totals.failures[2] + totals.failures[3];
+        std::snprintf(line, sizeof(line), "%s: %llu instructions, %llu bytes, %llu failures\n",
+            to_string(m_version) ? to_string(m_version) : "unknown",
+            static_cast<unsigned long long>(totals.instructions),
+            static_cast<unsigned long long>(totals.bytes),
+            static_cast<unsigned long long>(failures));
+        text += line;
+        for (std::size_t i = 1; i < decode_error_count; ++ i)
+        {
+            if (! totals.failures[i])
+                continue;
+            std::snprintf(line, sizeof(line), "  %-20s %12llu\n", to_string(decode_error(i)), static_cast<unsigned long long>(totals.failures[i]));
+            text += line;
+        }
+        text += "operand types:\n";
+        for (std::size_t i = 0; i < operand_type_count; ++ i)
+        {
+            auto const name = to_string(to_operand_type(static_cast<std::uint8_t>(i)));
+            if (! name || ! totals.operand_types[i])
+                continue;
+            std::snprintf(line, sizeof(line), "  %-20s %12llu\n", name, static_cast<unsigned long long>(totals.operand_types[i]));
+            text += line;
+        }
+        text += "variadic lengths:\n";
+        for (std::size_t i = 0; i < variadic_count; ++ i)
+        {
+            if (! totals.variadic_lengths[i])
+                continue;
+            std::snprintf(line, sizeof(line), "  %-20zu %12llu\n", i, static_cast<unsigned long long>(totals.variadic_lengths[i]));
+            text += line;
+        }
+        std::vector<std::uint16_t> order;
+        for (std::size_t i = 0; i < opcode_count; ++ i)
+            if (totals.opcodes[i] || totals.opcode_failures[i])
+                order.push_back(static_cast<std::uint16_t>(i));
+        std::stable_sort(order.begin(), order.end(), [&](std::uint16_t lhs, std::uint16_t rhs)
+        {
+            return totals.opcodes[lhs] > totals.opcodes[rhs];
+        });
+        if (order.size() > top)
+            order.resize(top);
+        text += "opcodes:                    decoded       failed\n";
+        for (auto const opcode : order)
+        {
+            std::snprintf(line, sizeof(line), "  0x%04x               %12llu %12llu\n", opcode,
+                static_cast<unsigned long long>(totals.opcodes[opcode]),
+                static_cast<unsigned long long>(totals.opcode_failures[opcode]));
+            text += line;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+# pragma once
+# include <engine/engine.hpp>
+# include <engine/decoder.hpp>
+# include <engine/instruction.hpp>
+# include <engine/version.hpp>
+# include <atomic>
+# include <memory>
+# include <mutex>
+# include <string>
+# include <type_traits>
+# include <vector>
+
+namespace idascm
+{
+    struct decoder_counters;
+    class memory_report;
+
+    // decode counters fed by decoder::decode_instruction (see decoder::set_statistics)
+    // every thread counts into its own block, blocks are merged when read
+    // one instance per game decoder gives the per game operand type histogram
+    class decoder_statistics
+    {
+        public:
+            enum : std::size_t
+            {
+                opcode_count        = 0x8000,
+                operand_type_count  = 0x100,
+                variadic_count      = std::extent<decltype(instruction::operand_list)>::value + 1,
+            };
+
+            // merged counters
+            struct totals
+            {
+                std::uint64_t               instructions;                       // decoded
+                std::uint64_t               bytes;                              // consumed by decoded instructions
+                std::uint64_t               failures[decode_error_count];       // by reason
+                std::uint64_t               operand_types[operand_type_count];  // by operand_type
+                std::uint64_t               variadic_lengths[variadic_count];   // operands in variadic lists
+                std::vector<std::uint64_t>  opcodes;                            // decoded, by opcode
+                std::vector<std::uint64_t>  opcode_failures;                    // failed, by opcode
+            };
+
+        public:
+            void record_instruction(instruction const & in) noexcept;
+            void record_failure(std::uint16_t opcode, decode_error error) noexcept;
+
+            auto collect(void) const -> totals;
+            // counters of threads decoding concurrently may survive
+            void reset(void) noexcept;
+
+            auto get_version(void) const noexcept -> version
+            {
+                return m_version;
+            }
+
+            // counter blocks of every thread that decoded
+            auto memory_usage(void) const -> memory_report;
+
+            // totals, non-zero opcode counters only
+            void write_json(std::string & json) const;
+            // totals and the 'top' most decoded opcodes
+            void write_text(std::string & text, std::size_t top = 32) const;
+
+        public:
+            explicit decoder_statistics(version ver = version::unknown);
+            ~decoder_statistics(void) noexcept;
+
+        private:
+            decoder_statistics(decoder_statistics const &) = delete;
+            auto operator = (decoder_statistics const &) -> decoder_statistics & = delete;
+
+            auto counters(void) noexcept -> decoder_counters *;
+
+        private:
+            version                                         m_version;
+            std::uint64_t                                   m_serial;   // tells instances apart in the thread cache
+            mutable std::mutex                              m_mutex;    // counter list
+            std::vector<std::unique_ptr<decoder_counters>>  m_counters;
+    };
+}
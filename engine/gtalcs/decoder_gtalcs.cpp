@@ -1,6 +1,5 @@
 # include <engine/gtalcs/decoder_gtalcs.hpp>
 # include <engine/instruction.hpp>
-# include <core/logger.hpp>
 # include <cassert>
 
 namespace idascm
@@ -61,10 +60,11 @@ namespace idascm
     {
         auto ptr = address;
         value_type value_type;
-        if (sizeof(value_type) != m_memory->read(address, &value_type))
+        op.type = operand_type::unknown;
+        if (! read_value(ptr, &value_type))
             return 0;
-        ptr += sizeof(value_type);
         op.type = to_operand_type(value_type);
+        bool complete = true;
         switch (op.type)
         {
             case operand_type::int0:
@@ -73,58 +73,56 @@ namespace idascm
                 op.value_uint64 = 0;
                 break;
             case operand_type::int8:
-                ptr += m_memory->read(ptr, &op.value_int8);
+                complete = read_value(ptr, &op.value_int8);
                 break;
             case operand_type::int16:
-                ptr += m_memory->read(ptr, &op.value_int16);
+                complete = read_value(ptr, &op.value_int16);
                 break;
             case operand_type::int32:
-                ptr += m_memory->read(ptr, &op.value_int32);
+                complete = read_value(ptr, &op.value_int32);
                 break;
             case operand_type::float32:
-                ptr += m_memory->read(ptr, &op.value_float32);
+                complete = read_value(ptr, &op.value_float32);
                 break;
             case operand_type::float8:
             {
-                std::uint8_t value;
-                ptr += m_memory->read(ptr, &value);
+                std::uint8_t value = 0;
+                complete = read_value(ptr, &value);
                 op.value_uint32 = value << 24;
                 break;
             }
             case operand_type::float16:
             {
-                std::uint16_t value;
-                ptr += m_memory->read(ptr, &value);
+                std::uint16_t value = 0;
+                complete = read_value(ptr, &value);
                 op.value_uint32 = value << 16;
                 break;
             }
             case operand_type::float24:
             {
-                std::uint8_t value[3];
-                ptr += m_memory->read(ptr, value, sizeof(value));
+                std::uint8_t value[3] = {};
+                complete = read_value(ptr, value, sizeof(value));
                 op.value_uint32 = (value[0] << 8) | (value[1] << 16) | (value[2] << 24);
                 break;
             }
             case operand_type::float16i:
             {
-                ptr += m_memory->read(ptr, &op.value_int16);
+                complete = read_value(ptr, &op.value_int16);
                 break;
             }
             case operand_type::global:
             {
                 std::uint8_t block = to_uint(value_type) - to_uint(value_type::global_first);
-                std::uint8_t slot;
-                ptr += m_memory->read(ptr, &slot);
+                std::uint8_t slot = 0;
+                complete = read_value(ptr, &slot);
                 op.value_address = 4 * ((block << 8) + slot);
                 break;
             }
             case operand_type::global_array:
             {
                 std::uint8_t block = to_uint(value_type) - to_uint(value_type::global_array_first);
-                std::uint8_t slot;
-                ptr += m_memory->read(ptr, &slot);
-                ptr += m_memory->read(ptr, &op.array_index);
-                ptr += m_memory->read(ptr, &op.array_size);
+                std::uint8_t slot = 0;
+                complete = read_value(ptr, &slot) && read_value(ptr, &op.array_index) && read_value(ptr, &op.array_size);
                 op.array_address    = 4 * ((block << 8) + slot);
                 break;
             }
@@ -136,8 +134,7 @@ namespace idascm
             case operand_type::local_array:
             {
                 std::uint8_t base = to_uint(value_type) - to_uint(value_type::local_array_first);
-                ptr += m_memory->read(ptr, &op.array_index);
-                ptr += m_memory->read(ptr, &op.array_size);
+                complete = read_value(ptr, &op.array_index) && read_value(ptr, &op.array_size);
                 op.array_address = base;
                 break;
             }
@@ -148,10 +145,12 @@ namespace idascm
             }
             default:
             {
-                IDASCM_LOG_W("unsupported operand type: %d (%d)", op.type, value_type);
+                op.type = operand_type::unknown;
                 return 0;
             }
         }
+        if (! complete)
+            return 0;
         op.size = (ptr - address);
         return op.size;
     }
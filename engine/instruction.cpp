@@ -3,6 +3,52 @@
 
 namespace idascm
 {
+    auto to_string(operand_type type) noexcept -> char const *
+    {
+        switch (type)
+        {
+            case operand_type::unknown:
+                return "unknown";
+            case operand_type::none:
+                return "none";
+            case operand_type::local:
+                return "local";
+            case operand_type::global:
+                return "global";
+            case operand_type::timer:
+                return "timer";
+            case operand_type::local_array:
+                return "local_array";
+            case operand_type::global_array:
+                return "global_array";
+            case operand_type::int0:
+                return "int0";
+            case operand_type::int8:
+                return "int8";
+            case operand_type::int16:
+                return "int16";
+            case operand_type::int32:
+                return "int32";
+            case operand_type::int64:
+                return "int64";
+            case operand_type::float0:
+                return "float0";
+            case operand_type::float8:
+                return "float8";
+            case operand_type::float16:
+                return "float16";
+            case operand_type::float16i:
+                return "float16i";
+            case operand_type::float24:
+                return "float24";
+            case operand_type::float32:
+                return "float32";
+            case operand_type::string64:
+                return "string64";
+        }
+        return nullptr;
+    }
+
     auto to_int(operand const & op, std::int32_t & value) noexcept -> bool
     {
         switch (op.type)
@@ -39,6 +85,6 @@ namespace idascm
 
     auto name(instruction const & ins) noexcept -> char const *
     {
-        return ins.command ? ins.command->name : nullptr;
+        return ins.command ? ins.command->name.c_str() : nullptr;
     }
 }
@@ -1,5 +1,7 @@
 # pragma once
 # include <engine/engine.hpp>
+# include <core/arena.hpp>
+# include <vector>
 
 namespace idascm
 {
@@ -40,6 +42,8 @@ namespace idascm
         return static_cast<operand_type>(type);
     }
 
+    auto to_string(operand_type type) noexcept -> char const *;
+
     struct operand
     {
         operand_type    type;
@@ -78,14 +82,17 @@ namespace idascm
     // instruction is a command instance with actual runtime values
     struct instruction
     {
-        command const *     command;
-        std::uint32_t       address;
-        std::uint16_t       opcode;
-        std::uint8_t        flags;
-        std::uint8_t        size;
-        std::uint8_t        operand_count;
-        operand             operand_list[24];
+        idascm::command const * command;    // qualified, the member hides the type
+        std::uint32_t           address;
+        std::uint16_t           opcode;
+        std::uint8_t            flags;
+        std::uint8_t            size;
+        std::uint8_t            operand_count;
+        operand                 operand_list[24];
     };
 
+    // instructions decoded together, storage is given back with the arena
+    using instruction_batch = std::vector<instruction, arena_allocator<instruction>>;
+
     auto name(instruction const & ins) noexcept -> char const *;
 }
@@ -0,0 +1,202 @@
+# include <engine/listing.hpp>
+# include <engine/command.hpp>
+# include <engine/command_set.hpp>
+# include <engine/decoder.hpp>
+# include <engine/renderer.hpp>
+# include <core/arena.hpp>
+# include <core/thread_pool.hpp>
+# include <algorithm>
+
+namespace idascm
+{
+    namespace
+    {
+        constexpr std::uint32_t gs_slice_size   = 16 * 1024;    // bytes decoded into one batch
+        constexpr std::size_t   gs_line_size    = 4096;         // longer than any rendered instruction
+
+        // linear sweep over [address, end): on_instruction(in) for every decoded instruction,
+        // on_byte(address) for bytes nothing decodes at, the sweep goes on with the next byte
+        // returns the address it stopped at
+        template <typename instruction_function, typename byte_function>
+        auto sweep(decoder const & dec, arena & memory, std::uint32_t address, std::uint32_t end, instruction_function && on_instruction, byte_function && on_byte) -> std::uint32_t
+        {
+            while (address < end)
+            {
+                arena::scope scope(memory);
+                instruction_batch batch(memory);
+                decode_result result = { decode_error::none, decode_operand_none, 0 };
+                auto const slice = end - address > gs_slice_size ? address + gs_slice_size : end;
+                address = dec.decode_batch(address, slice, batch, &result);
+                for (auto const & in : batch)
+                    on_instruction(in);
+                if (decode_error::none != result.error)
+                {
+                    on_byte(address);
+                    address += 1;
+                }
+            }
+            return address;
+        }
+
+        // address arguments, the analyzer makes code references of them
+        // negative (mission relative) ones are left out
+        template <typename function>
+        void for_each_target(instruction const & in, function && fn)
+        {
+            for (std::uint8_t i = 0; i < in.operand_count && i < in.command->argument_count; ++ i)
+            {
+                std::int32_t value = 0;
+                if (argument_type::address == in.command->argument_list[i] && to_int(in.operand_list[i], value) && value >= 0)
+                    fn(static_cast<std::uint32_t>(value));
+            }
+        }
+
+        auto render_address(char * first, std::uint32_t address) noexcept -> char *
+        {
+            static char const digits[] = "0123456789ABCDEF";
+            for (int i = 0; i < 8; ++ i)
+                first[i] = digits[(address >> (28 - 4 * i)) & 0xf];
+            return first + 8;
+        }
+    }
+
+    // variable length code falls back in step within a few instructions, so a sweep
+    // again is rare
+    void listing::analyze(thread_pool & pool)
+    {
+        auto const size = m_end;
+        m_chunks.clear();
+        for (std::uint32_t begin = 0; begin < size; begin += std::min(m_chunk_size, size - begin))
+            m_chunks.push_back({ begin, begin + std::min(m_chunk_size, size - begin), begin, begin, {} });
+
+        dynamic_bitset starts(size);
+        parallel_for(pool, 0, m_chunks.size(), 1, [&](std::size_t first, std::size_t last)
+        {
+            arena memory(1024 * 1024);
+            for (auto i = first; i < last; ++ i)
+                analyze_chunk(m_chunks[i], m_chunks[i].begin, memory, &starts);
+        });
+
+        arena memory(1024 * 1024);
+        std::uint32_t entry = 0;
+        m_resweep_count = 0;
+        for (auto & chunk : m_chunks)
+        {
+            if (entry >= chunk.end)
+            {
+                chunk.targets.clear();
+                chunk.entry = chunk.exit = entry;
+                continue;
+            }
+            if (! starts.test(entry))
+            {
+                chunk.targets.clear();
+                analyze_chunk(chunk, entry, memory, nullptr);
+                ++ m_resweep_count;
+            }
+            chunk.entry = entry;
+            entry = chunk.exit;
+        }
+
+        m_labels = dynamic_bitset(size);
+        for (auto & chunk : m_chunks)
+        {
+            for (auto const & target : chunk.targets)
+            {
+                if (target.first >= chunk.entry && target.second < size)
+                    m_labels.set(target.second);
+            }
+            chunk.targets = {};
+        }
+    }
+
+    // the next window renders while the current one is written
+    auto listing::write(thread_pool & pool, std::FILE * file) -> bool
+    {
+        auto const count = m_chunks.size();
+        auto const window = pool.thread_count() * 2 + 1;
+        std::vector<std::string> text(2 * window);
+        auto render_window = [&](std::size_t first)
+        {
+            parallel_for(pool, first, std::min(first + window, count), 1, [&](std::size_t begin, std::size_t end)
+            {
+                arena memory(1024 * 1024);
+                for (auto i = begin; i < end; ++ i)
+                    render_chunk(m_chunks[i], memory, text[i % text.size()]);
+            });
+        };
+        render_window(0);
+        bool complete = true;
+        for (std::size_t first = 0; first < count; first += window)
+        {
+            task_group group(pool);
+            if (first + window < count)
+                group.run([&render_window, first, window](void) { render_window(first + window); });
+            for (auto i = first; i < std::min(first + window, count); ++ i)
+            {
+                auto const & chunk_text = text[i % text.size()];
+                complete &= chunk_text.size() == std::fwrite(chunk_text.data(), 1, chunk_text.size(), file);
+            }
+            group.wait();
+        }
+        return complete;
+    }
+
+    listing::listing(decoder const & dec, command_set const & isa, void const * memory, std::uint32_t size, std::uint32_t chunk_size)
+        : m_decoder(dec)
+        , m_isa(isa)
+        , m_memory(static_cast<std::uint8_t const *>(memory))
+        , m_end(size)
+        , m_chunk_size(std::max<std::uint32_t>(64, (std::min<std::uint32_t>(chunk_size, 0x80000000) + 63) & ~std::uint32_t(63)))
+        , m_resweep_count(0)
+    {}
+
+    void listing::analyze_chunk(chunk & chunk, std::uint32_t entry, arena & memory, dynamic_bitset * starts) const
+    {
+        chunk.exit = sweep(m_decoder, memory, entry, chunk.end,
+            [&](instruction const & in)
+            {
+                if (starts)
+                    starts->set(in.address);
+                for_each_target(in, [&](std::uint32_t target) { chunk.targets.emplace_back(in.address, target); });
+            },
+            [&](std::uint32_t address)
+            {
+                if (starts)
+                    starts->set(address);
+            });
+    }
+
+    void listing::render_chunk(chunk const & chunk, arena & memory, std::string & text) const
+    {
+        text.clear();
+        char line[gs_line_size];
+        auto const last = line + sizeof(line);
+        render_options options;
+        options.relative = false;
+        sweep(m_decoder, memory, chunk.entry, chunk.end,
+            [&](instruction const & in)
+            {
+                if (m_labels.test(in.address))
+                {
+                    auto const end = render_name(line, last - 2, in.address, true, options);
+                    end[0] = ':';
+                    end[1] = '\n';
+                    text.append(line, end + 2);
+                }
+                auto end = render_address(line, in.address);
+                *end ++ = ' ';
+                *end ++ = ' ';
+                end = render_instruction(end, last - 1, in, *m_isa.get_text(in.opcode), options);
+                if (! end)
+                    end = line + std::snprintf(line, sizeof(line), "%08X  %s ...", in.address, m_isa.get_text(in.opcode)->mnemonic.data());
+                *end ++ = '\n';
+                text.append(line, end);
+            },
+            [&](std::uint32_t address)
+            {
+                auto const end = line + std::snprintf(line, sizeof(line), "%08X  db      0x%02X\n", address, m_memory[address]);
+                text.append(line, end);
+            });
+    }
+}
@@ -0,0 +1,76 @@
+# pragma once
+# include <engine/engine.hpp>
+# include <core/bitset.hpp>
+# include <cstdint>
+# include <cstdio>
+# include <string>
+# include <utility>
+# include <vector>
+
+namespace idascm
+{
+    class arena;
+    class command_set;
+    class decoder;
+    class thread_pool;
+
+    // text listing of a whole script (idascm-dis): a linear sweep from the start, loc_ labels
+    // at the code addresses referred to, 'db' lines for bytes nothing decodes at
+    // the header is not parsed, so mission relative (negative) addresses have no base to
+    // resolve against: they get no label and render as the raw integer
+    // the output does not depend on the thread count or the chunk size
+    class listing
+    {
+        public:
+            enum : std::uint32_t
+            {
+                default_chunk_size = 256 * 1024,
+            };
+
+        public:
+            // speculative sweep of every chunk in parallel, then chunks are stitched in order:
+            // a chunk whose sweep did not pass through the previous chunk's exit is swept again
+            void analyze(thread_pool & pool);
+            // chunks rendered in parallel a window at a time, written in address order
+            // false if the file did not take the whole listing
+            auto write(thread_pool & pool, std::FILE * file) -> bool;
+
+            // chunks analyze() had to sweep again
+            auto resweep_count(void) const noexcept -> std::size_t
+            {
+                return m_resweep_count;
+            }
+
+        public:
+            // 'dec' has its command set and memory API set, both are only read
+            // 'chunk_size' is the unit of parallel work, rounded up to a multiple of 64 so chunks
+            // never share a bitset word
+            listing(decoder const & dec, command_set const & isa, void const * memory, std::uint32_t size, std::uint32_t chunk_size = default_chunk_size);
+
+        private:
+            listing(listing const &) = delete;
+            auto operator = (listing const &) -> listing & = delete;
+
+            struct chunk
+            {
+                std::uint32_t   begin;
+                std::uint32_t   end;
+                std::uint32_t   entry;      // first instruction (or byte) of the listing in the chunk, at or past 'begin'
+                std::uint32_t   exit;       // past the last one, the last instruction may end past 'end'
+                std::vector<std::pair<std::uint32_t, std::uint32_t>> targets;  // instruction, code address it refers to
+            };
+
+            void analyze_chunk(chunk & chunk, std::uint32_t entry, arena & memory, dynamic_bitset * starts) const;
+            void render_chunk(chunk const & chunk, arena & memory, std::string & text) const;
+
+        private:
+            decoder const &         m_decoder;
+            command_set const &     m_isa;
+            std::uint8_t const *    m_memory;
+            std::uint32_t           m_end;
+            std::uint32_t           m_chunk_size;
+            std::vector<chunk>      m_chunks;
+            dynamic_bitset          m_labels;   // code addresses referred to
+            std::size_t             m_resweep_count;
+    };
+}
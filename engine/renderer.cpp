@@ -0,0 +1,242 @@
+# include <engine/renderer.hpp>
+# include <engine/command.hpp>
+# include <charconv>
+# include <cstring>
+
+namespace idascm
+{
+    namespace
+    {
+        auto append(char * first, char * last, char const * text, std::size_t size) noexcept -> char *
+        {
+            if (! first || static_cast<std::size_t>(last - first) < size)
+                return nullptr;
+            std::memcpy(first, text, size);
+            return first + size;
+        }
+
+        auto append(char * first, char * last, std::string_view text) noexcept -> char *
+        {
+            return append(first, last, text.data(), text.size());
+        }
+
+        auto append(char * first, char * last, char c) noexcept -> char *
+        {
+            if (! first || first == last)
+                return nullptr;
+            *first = c;
+            return first + 1;
+        }
+
+        // printf %g: 6 significant digits, the same text as qsnprintf used to give
+        auto append_general(char * first, char * last, float value) noexcept -> char *
+        {
+            if (! first)
+                return nullptr;
+            auto const result = std::to_chars(first, last, value, std::chars_format::general, 6);
+            return std::errc() == result.ec ? result.ptr : nullptr;
+        }
+
+        auto append_hex(char * first, char * last, std::uint32_t value) noexcept -> char *
+        {
+            if (! first)
+                return nullptr;
+            auto const result = std::to_chars(first, last, value, 16);
+            if (std::errc() != result.ec)
+                return nullptr;
+            for (auto c = first; c != result.ptr; ++ c)
+                if (*c >= 'a' && *c <= 'f')
+                    *c = static_cast<char>(*c - 'a' + 'A');
+            return result.ptr;
+        }
+
+        // analyzer::handle_operand: code references from integer address arguments
+        auto code_address(instruction const & in, std::uint8_t index, render_options const & options, std::uint32_t & address) noexcept -> bool
+        {
+            if (! in.command || index >= in.command->argument_count || argument_type::address != in.command->argument_list[index])
+                return false;
+            std::int32_t value = 0;
+            if (! to_int(in.operand_list[index], value) || (value < 0 && ! options.relative))
+                return false;
+            address = value >= 0 ? static_cast<std::uint32_t>(value) : options.base + static_cast<std::uint32_t>(-static_cast<std::int64_t>(value));
+            return true;
+        }
+    }
+
+    auto float_suffix(operand_type type) noexcept -> char const *
+    {
+        switch (type)
+        {
+            case operand_type::float0:
+                return "f0";
+            case operand_type::float8:
+                return "f8";
+            case operand_type::float16:
+                return "f16";
+            case operand_type::float24:
+                return "f24";
+            case operand_type::float32:
+                return "f";
+            default:
+                return nullptr;
+        }
+    }
+
+    auto render_float(char * first, char * last, float value, operand_type type) noexcept -> char *
+    {
+        auto const begin = first;
+        first = append_general(first, last, value);
+        if (! first)
+            return nullptr;
+        if (! std::memchr(begin, '.', first - begin))
+            first = append(first, last, '.');
+        if (auto const suffix = float_suffix(type))
+            first = append(first, last, suffix, std::strlen(suffix));
+        return first;
+    }
+
+    auto render_float16i(char * first, char * last, std::int16_t value) noexcept -> char *
+    {
+        return append_general(first, last, value / 16.f);
+    }
+
+    auto render_integer(char * first, char * last, std::int32_t value) noexcept -> char *
+    {
+        if (! first)
+            return nullptr;
+        auto const result = std::to_chars(first, last, value);
+        return std::errc() == result.ec ? result.ptr : nullptr;
+    }
+
+    auto render_local(char * first, char * last, std::int32_t index) noexcept -> char *
+    {
+        return render_integer(append(first, last, '@'), last, index);
+    }
+
+    auto render_array_index(char * first, char * last, std::int32_t index, std::int32_t size) noexcept -> char *
+    {
+        first = render_local(append(first, last, '['), last, index);
+        first = render_integer(append(first, last, ','), last, size);
+        return append(first, last, ']');
+    }
+
+    auto render_string64(char * first, char * last, char const (& value)[8]) noexcept -> char *
+    {
+        std::size_t length = 0;
+        while (length < sizeof(value) && value[length])
+            ++ length;
+        first = append(first, last, '\'');
+        first = append(first, last, value, length);
+        return append(first, last, '\'');
+    }
+
+    auto render_name(char * first, char * last, std::uint32_t address, bool code, render_options const & options) noexcept -> char *
+    {
+        if (options.name)
+        {
+            auto const name = options.name(options.context, address, code);
+            if (! name.empty())
+                return append(first, last, name);
+        }
+        first = code ? append(first, last, "loc_", 4) : append(first, last, "dword_", 6);
+        return append_hex(first, last, address);
+    }
+
+    auto is_rendered(operand const & op) noexcept -> bool
+    {
+        switch (op.type)
+        {
+            case operand_type::string64:
+            case operand_type::int0:
+            case operand_type::int8:
+            case operand_type::int16:
+            case operand_type::int32:
+            case operand_type::float0:
+            case operand_type::float8:
+            case operand_type::float16:
+            case operand_type::float24:
+            case operand_type::float32:
+            case operand_type::float16i:
+            case operand_type::global:
+            case operand_type::global_array:
+            case operand_type::local_array:
+            case operand_type::local:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    auto render_operand(char * first, char * last, instruction const & in, std::uint8_t index, render_options const & options) noexcept -> char *
+    {
+        auto const & op = in.operand_list[index];
+        std::uint32_t address = 0;
+        if (code_address(in, index, options, address))
+            return render_name(first, last, address, true, options);
+        switch (op.type)
+        {
+            case operand_type::string64:
+                return render_string64(first, last, op.value_string64);
+            case operand_type::int0:
+                return render_integer(first, last, 0);
+            case operand_type::int8:
+                return render_integer(first, last, op.value_int8);
+            case operand_type::int16:
+                return render_integer(first, last, op.value_int16);
+            case operand_type::int32:
+                return render_integer(first, last, op.value_int32);
+            case operand_type::float0:
+                return render_float(first, last, 0.f, op.type);
+            case operand_type::float8:
+            case operand_type::float16:
+            case operand_type::float24:
+            case operand_type::float32:
+                return render_float(first, last, op.value_float32, op.type);
+            case operand_type::float16i:
+                return render_float16i(first, last, op.value_int16);
+            case operand_type::global:
+                return render_name(first, last, op.value_address, false, options);
+            case operand_type::global_array:
+                first = render_name(first, last, op.array_address, false, options);
+                return render_array_index(first, last, op.array_index, op.array_size);
+            case operand_type::local_array:
+                first = render_local(first, last, op.array_address);
+                return render_array_index(first, last, op.array_index, op.array_size);
+            case operand_type::local:
+                return render_local(first, last, op.value_address);
+            default:
+                return first;
+        }
+    }
+
+    auto render_operands(char * first, char * last, instruction const & in, render_options const & options) noexcept -> char *
+    {
+        bool separate = false;
+        for (std::uint8_t i = 0; i < in.operand_count && first; ++ i)
+        {
+            if (! is_rendered(in.operand_list[i]))
+                continue;
+            if (separate)
+                first = append(first, last, ", ", 2);
+            first = render_operand(first, last, in, i, options);
+            separate = true;
+        }
+        return first;
+    }
+
+    auto render_instruction(char * first, char * last, instruction const & in, command_text const & text, render_options const & options) noexcept -> char *
+    {
+        auto const mnemonic = (in.flags & instruction_flag_not) ? text.mnemonic_not : text.mnemonic;
+        first = append(first, last, mnemonic);
+        bool operands = false;
+        for (std::uint8_t i = 0; i < in.operand_count; ++ i)
+            operands |= is_rendered(in.operand_list[i]);
+        if (! operands || ! first)
+            return first;
+        auto pad = options.mnemonic_width > mnemonic.size() ? options.mnemonic_width - mnemonic.size() : 1;
+        if (static_cast<std::size_t>(last - first) < pad)
+            return nullptr;
+        std::memset(first, ' ', pad);
+        return render_operands(first + pad, last, in, options);
+    }
+}
@@ -0,0 +1,54 @@
+# pragma once
+# include <engine/engine.hpp>
+# include <engine/instruction.hpp>
+# include <cstdint>
+# include <string_view>
+
+namespace idascm
+{
+    struct command_text;
+
+    // text of a code (label) or data (global) address, an empty view falls back to
+    // IDA's dummy names (loc_%X, dword_%X)
+    using render_name_function = std::string_view (*)(void * context, std::uint32_t address, bool code);
+
+    struct render_options
+    {
+        std::uint32_t           base            = 0;        // start of the instruction's segment, negative (mission relative) addresses are based on it
+        bool                    relative        = true;     // off - negative addresses render as the raw integer, not as a name
+        std::uint8_t            mnemonic_width  = 8;        // operands start past it, at least a space after the mnemonic
+        render_name_function    name            = nullptr;
+        void *                  context         = nullptr;  // passed to 'name'
+    };
+
+    // text as the IDA module prints it, written into [first, last)
+    // every function returns the end of the text, nullptr if it did not fit
+    // nothing is zero terminated and nothing allocates
+    // integers are decimal, IDA prints them in the database radix
+
+    // "f0", "f8", "f16", "f24", "f" (float32), nullptr for other types
+    auto float_suffix(operand_type type) noexcept -> char const *;
+
+    // %g, '.' appended if there is none, then the type's suffix
+    auto render_float(char * first, char * last, float value, operand_type type) noexcept -> char *;
+    // %g of value / 16, nothing appended
+    auto render_float16i(char * first, char * last, std::int16_t value) noexcept -> char *;
+    auto render_integer(char * first, char * last, std::int32_t value) noexcept -> char *;
+    // @N
+    auto render_local(char * first, char * last, std::int32_t index) noexcept -> char *;
+    // [@index,size]
+    auto render_array_index(char * first, char * last, std::int32_t index, std::int32_t size) noexcept -> char *;
+    // 'text' up to the first zero, 8 characters at most
+    auto render_string64(char * first, char * last, char const (& value)[8]) noexcept -> char *;
+    auto render_name(char * first, char * last, std::uint32_t address, bool code, render_options const & options) noexcept -> char *;
+
+    // operands the IDA module does not show (timers, unknown types) render as nothing
+    auto is_rendered(operand const & op) noexcept -> bool;
+
+    // operand 'index', 'in.command' decides whether it is an address
+    auto render_operand(char * first, char * last, instruction const & in, std::uint8_t index, render_options const & options) noexcept -> char *;
+    // rendered operands separated by ", "
+    auto render_operands(char * first, char * last, instruction const & in, render_options const & options) noexcept -> char *;
+    // [NOT ]MNEMONIC padded to options.mnemonic_width, then the operands
+    auto render_instruction(char * first, char * last, instruction const & in, command_text const & text, render_options const & options) noexcept -> char *;
+}
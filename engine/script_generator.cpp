@@ -0,0 +1,465 @@
+# include <engine/script_generator.hpp>
+# include <engine/command_set.hpp>
+# include <engine/gtalcs/decoder_gtalcs.hpp>
+# include <engine/instruction.hpp>
+# include <algorithm>
+# include <cstring>
+# include <iterator>
+# include <queue>
+
+namespace idascm
+{
+    namespace
+    {
+        using lcs_value_type = decoder_gtalcs::value_type;
+
+        // GTA III / VC operand type bytes
+        std::uint8_t const gs_type_end      = 0;
+        std::uint8_t const gs_type_int32    = 1;
+        std::uint8_t const gs_type_global   = 2;
+        std::uint8_t const gs_type_local    = 3;
+        std::uint8_t const gs_type_int8     = 4;
+        std::uint8_t const gs_type_int16    = 5;
+        std::uint8_t const gs_type_float    = 6;    // float16i (III), float32 (VC)
+
+        // largest script, absolute addresses are positive int32
+        std::uint64_t const gs_size_max = 0x7f000000;
+
+        // splitmix64, std distributions differ between standard libraries
+        class script_random
+        {
+            public:
+                auto next(void) noexcept -> std::uint64_t
+                {
+                    auto z = (m_state += 0x9e3779b97f4a7c15ull);
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                    return z ^ (z >> 31);
+                }
+
+                // [0, bound)
+                auto below(std::uint64_t bound) noexcept -> std::uint64_t
+                {
+                    return next() % bound;
+                }
+
+                auto chance(std::uint32_t per_mille) noexcept -> bool
+                {
+                    return below(1000) < per_mille;
+                }
+
+            public:
+                explicit script_random(std::uint64_t seed) noexcept
+                    : m_state(seed)
+                {}
+
+            private:
+                std::uint64_t   m_state;
+        };
+
+        // address operand waiting for the instruction it points at
+        struct pending_address
+        {
+            std::uint64_t   target;     // instruction index within the section
+            std::size_t     position;   // int32 to patch
+        };
+
+        struct pending_address_order
+        {
+            auto operator () (pending_address const & lhs, pending_address const & rhs) const noexcept -> bool
+            {
+                return lhs.target > rhs.target;
+            }
+        };
+
+        auto is_generated(command const & cmd) noexcept -> bool
+        {
+            return ! (cmd.flags & command_flag_function_call);
+        }
+
+        auto has_address(command const & cmd) noexcept -> bool
+        {
+            for (std::uint8_t i = 0; i < cmd.argument_count; ++ i)
+                if (argument_type::address == cmd.argument_list[i])
+                    return true;
+            return false;
+        }
+
+        class script_writer
+        {
+            public:
+                auto prepare(void) -> bool;
+                void write_section(std::uint64_t size, bool mission);
+
+            public:
+                script_writer(command_set const & isa, game game, script_generator_options const & options, generated_script & script)
+                    : m_isa(isa)
+                    , m_game(game)
+                    , m_options(options)
+                    , m_random(options.seed)
+                    , m_script(script)
+                    , m_code(script.code)
+                    , m_start(0)
+                    , m_mission(false)
+                    , m_index(0)
+                    , m_jump_count(0)
+                    , m_recent {}
+                {}
+
+            private:
+                enum : std::uint64_t
+                {
+                    recent_count    = 256,  // backward jumps reach that many instructions
+                    forward_max     = 256,
+                };
+
+            private:
+                void u8(std::uint8_t value)
+                {
+                    m_code.push_back(value);
+                }
+
+                void u16(std::uint16_t value)
+                {
+                    u8(value & 0xff);
+                    u8(value >> 8);
+                }
+
+                void u32(std::uint32_t value)
+                {
+                    u16(value & 0xffff);
+                    u16(value >> 16);
+                }
+
+                void f32(float value)
+                {
+                    std::uint32_t bits;
+                    std::memcpy(&bits, &value, sizeof(bits));
+                    u32(bits);
+                }
+
+                void patch(std::size_t position, std::int32_t value)
+                {
+                    auto const bits = static_cast<std::uint32_t>(value);
+                    for (int i = 0; i < 4; ++ i)
+                        m_code[position + i] = static_cast<std::uint8_t>(bits >> (8 * i));
+                }
+
+                auto is_lcs(void) const noexcept -> bool
+                {
+                    return game::gtalcs == m_game;
+                }
+
+                // absolute in main, negative offset from the section in missions
+                auto address_of(std::uint64_t index) const noexcept -> std::int32_t
+                {
+                    auto const position = static_cast<std::int32_t>(m_recent[index % recent_count]);
+                    return m_mission ? -(position - static_cast<std::int32_t>(m_start)) : position;
+                }
+
+                void write_instruction(std::uint16_t opcode);
+                void write_operand(argument_type type);
+                void write_address(void);
+                void write_integer(void);
+                void write_real(void);
+                void write_global(void);
+                void write_local(void);
+                void write_string64(void);
+
+            private:
+                command_set const &                 m_isa;
+                game                                m_game;
+                script_generator_options const &    m_options;
+                script_random                       m_random;
+                generated_script &                  m_script;
+                std::vector<std::uint8_t> &         m_code;
+                std::vector<std::uint16_t>          m_mix;
+                std::vector<std::uint16_t>          m_jumps;    // jump / call commands with an address argument
+                // current section
+                std::size_t                         m_start;
+                bool                                m_mission;
+                std::uint64_t                       m_index;
+                std::uint64_t                       m_jump_count;
+                std::uint32_t                       m_recent[recent_count];  // starts of the last instructions
+                std::priority_queue<pending_address, std::vector<pending_address>, pending_address_order> m_pending;
+        };
+
+        auto script_writer::prepare(void) -> bool
+        {
+            for (std::uint32_t opcode = 0; opcode < 0x8000; ++ opcode)
+            {
+                auto const cmd = m_isa.get_command(static_cast<std::uint16_t>(opcode));
+                if (! cmd || ! is_generated(*cmd))
+                    continue;
+                if (m_options.opcodes.empty())
+                    m_mix.push_back(static_cast<std::uint16_t>(opcode));
+                if ((cmd->flags & (command_flag_jump | command_flag_call)) && has_address(*cmd))
+                    m_jumps.push_back(static_cast<std::uint16_t>(opcode));
+            }
+            for (auto const opcode : m_options.opcodes)
+            {
+                auto const cmd = m_isa.get_command(opcode);
+                if (cmd && is_generated(*cmd))
+                    m_mix.push_back(opcode);
+            }
+            return ! m_mix.empty();
+        }
+
+        void script_writer::write_section(std::uint64_t size, bool mission)
+        {
+            m_start         = m_code.size();
+            m_mission       = mission;
+            m_index         = 0;
+            m_jump_count    = 0;
+            while (m_code.size() - m_start < size)
+            {
+                auto const position = static_cast<std::uint32_t>(m_code.size());
+                m_recent[m_index % recent_count] = position;
+                while (! m_pending.empty() && m_pending.top().target <= m_index)
+                {
+                    patch(m_pending.top().position, address_of(m_index));
+                    m_pending.pop();
+                }
+                std::uint16_t opcode;
+                if (! m_jumps.empty() && m_random.chance(m_options.jump_density))
+                    opcode = m_jumps[m_random.below(m_jumps.size())];
+                else
+                    opcode = m_mix[m_random.below(m_mix.size())];
+                write_instruction(opcode);
+                ++ m_index;
+            }
+            // targets past the end go to the last instruction
+            for (; ! m_pending.empty(); m_pending.pop())
+                patch(m_pending.top().position, address_of(m_index - 1));
+
+            script_section section;
+            section.offset              = static_cast<std::uint32_t>(m_start);
+            section.size                = static_cast<std::uint32_t>(m_code.size() - m_start);
+            section.instruction_count   = m_index;
+            section.jump_count          = m_jump_count;
+            m_script.sections.push_back(section);
+            m_script.instruction_count += m_index;
+        }
+
+        // mirrors decoder::decode: fixed arguments up to the first variadic one, then a terminated list
+        void script_writer::write_instruction(std::uint16_t opcode)
+        {
+            auto const & cmd = *m_isa.get_command(opcode);
+            if ((cmd.flags & command_flag_condition) && m_random.chance(250))
+                opcode |= 0x8000;
+            u16(opcode);
+            std::uint8_t op = 0;
+            for (; op < cmd.argument_count; ++ op)
+            {
+                if (argument_type::variadic == cmd.argument_list[op])
+                    break;
+                write_operand(cmd.argument_list[op]);
+            }
+            if (op < std::size(cmd.argument_list) && argument_type::variadic == cmd.argument_list[op])
+            {
+                // the decoder reads the terminator only below a full operand list
+                auto const room = std::size(instruction {}.operand_list) - 1 - op;
+                auto const count = m_random.below(std::min<std::uint64_t>(m_options.variadic_max, room) + 1);
+                for (std::uint64_t i = 0; i < count; ++ i)
+                    write_operand(argument_type::any);
+                u8(gs_type_end);
+            }
+        }
+
+        void script_writer::write_operand(argument_type type)
+        {
+            switch (type)
+            {
+                case argument_type::string64:
+                    write_string64();
+                    break;
+                case argument_type::int8:
+                    u8(static_cast<std::uint8_t>(m_random.next()));
+                    break;
+                case argument_type::int32:
+                    u32(static_cast<std::uint32_t>(m_random.next()));
+                    break;
+                case argument_type::address:
+                    write_address();
+                    break;
+                case argument_type::integer:
+                case argument_type::int16:
+                case argument_type::character:
+                    switch (m_random.below(8))
+                    {
+                        case 0:  write_global();    break;
+                        case 1:  write_local();     break;
+                        default: write_integer();   break;
+                    }
+                    break;
+                case argument_type::real:
+                case argument_type::float32:
+                    switch (m_random.below(8))
+                    {
+                        case 0:  write_global();    break;
+                        case 1:  write_local();     break;
+                        default: write_real();      break;
+                    }
+                    break;
+                case argument_type::global:
+                    write_global();
+                    break;
+                case argument_type::local:
+                    write_local();
+                    break;
+                default:
+                    switch (m_random.below(4))
+                    {
+                        case 0: write_integer();    break;
+                        case 1: write_real();       break;
+                        case 2: write_global();     break;
+                        case 3: write_local();      break;
+                    }
+                    break;
+            }
+        }
+
+        // half backward within the last recent_count instructions (the current one included), half forward
+        // mission addresses never point at the section start, its offset 0 would read as absolute
+        void script_writer::write_address(void)
+        {
+            u8(is_lcs() ? decoder_gtalcs::to_uint(lcs_value_type::int32) : gs_type_int32);
+            auto const position = m_code.size();
+            ++ m_jump_count;
+            std::uint64_t first = m_index + 1 > recent_count ? m_index + 1 - recent_count : 0;
+            if (m_mission)
+                first = std::max<std::uint64_t>(first, 1);
+            if (first <= m_index && m_random.below(2))
+            {
+                auto const target = first + m_random.below(m_index - first + 1);
+                u32(static_cast<std::uint32_t>(address_of(target)));
+                return;
+            }
+            m_pending.push({ m_index + 1 + m_random.below(forward_max), position });
+            u32(0);
+        }
+
+        void script_writer::write_integer(void)
+        {
+            auto const value = m_random.next();
+            if (is_lcs())
+            {
+                switch (m_random.below(4))
+                {
+                    case 0: u8(decoder_gtalcs::to_uint(lcs_value_type::int0));                                                  break;
+                    case 1: u8(decoder_gtalcs::to_uint(lcs_value_type::int8));  u8(static_cast<std::uint8_t>(value));           break;
+                    case 2: u8(decoder_gtalcs::to_uint(lcs_value_type::int16)); u16(static_cast<std::uint16_t>(value));         break;
+                    case 3: u8(decoder_gtalcs::to_uint(lcs_value_type::int32)); u32(static_cast<std::uint32_t>(value));         break;
+                }
+                return;
+            }
+            switch (m_random.below(3))
+            {
+                case 0: u8(gs_type_int8);   u8(static_cast<std::uint8_t>(value));   break;
+                case 1: u8(gs_type_int16);  u16(static_cast<std::uint16_t>(value)); break;
+                case 2: u8(gs_type_int32);  u32(static_cast<std::uint32_t>(value)); break;
+            }
+        }
+
+        void script_writer::write_real(void)
+        {
+            // -1000.0 .. 1000.0 in 0.1 steps
+            auto const value = static_cast<float>(static_cast<std::int32_t>(m_random.below(20001)) - 10000) / 10.f;
+            if (is_lcs())
+            {
+                // packed floats keep the upper bytes of the float32 bits
+                std::uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                switch (m_random.below(5))
+                {
+                    case 0: u8(decoder_gtalcs::to_uint(lcs_value_type::float0));                                                            break;
+                    case 1: u8(decoder_gtalcs::to_uint(lcs_value_type::float8));  u8(bits >> 24);                                           break;
+                    case 2: u8(decoder_gtalcs::to_uint(lcs_value_type::float16)); u16(bits >> 16);                                          break;
+                    case 3: u8(decoder_gtalcs::to_uint(lcs_value_type::float24)); u8((bits >> 8) & 0xff); u16(bits >> 16);                  break;
+                    case 4: u8(decoder_gtalcs::to_uint(lcs_value_type::float32)); u32(bits);                                                break;
+                }
+                return;
+            }
+            u8(gs_type_float);
+            if (game::gtavc == m_game)
+                f32(value);
+            else
+                u16(static_cast<std::uint16_t>(static_cast<std::int16_t>(value * 16.f)));
+        }
+
+        void script_writer::write_global(void)
+        {
+            if (is_lcs())
+            {
+                auto const block = static_cast<std::uint8_t>(m_random.below(26));
+                auto const slot  = static_cast<std::uint8_t>(m_random.next());
+                if (m_random.below(4))
+                {
+                    u8(decoder_gtalcs::to_uint(lcs_value_type::global_first) + block);
+                    u8(slot);
+                    return;
+                }
+                u8(decoder_gtalcs::to_uint(lcs_value_type::global_array_first) + block);
+                u8(slot);
+                u8(static_cast<std::uint8_t>(m_random.below(96)));     // index variable
+                u8(static_cast<std::uint8_t>(m_random.below(32) + 1)); // size
+                return;
+            }
+            u8(gs_type_global);
+            u16(static_cast<std::uint16_t>(m_random.below(0x4000) * 4));
+        }
+
+        void script_writer::write_local(void)
+        {
+            if (is_lcs())
+            {
+                switch (m_random.below(8))
+                {
+                    case 0:
+                        u8(decoder_gtalcs::to_uint(lcs_value_type::timer_first) + static_cast<std::uint8_t>(m_random.below(2)));
+                        break;
+                    case 1:
+                        u8(decoder_gtalcs::to_uint(lcs_value_type::local_array_first) + static_cast<std::uint8_t>(m_random.below(96)));
+                        u8(static_cast<std::uint8_t>(m_random.below(96)));
+                        u8(static_cast<std::uint8_t>(m_random.below(32) + 1));
+                        break;
+                    default:
+                        u8(decoder_gtalcs::to_uint(lcs_value_type::local_first) + static_cast<std::uint8_t>(m_random.below(96)));
+                        break;
+                }
+                return;
+            }
+            u8(gs_type_local);
+            u16(static_cast<std::uint16_t>(m_random.below(32)));
+        }
+
+        // upper case name of 1 - 7 characters, zero padded
+        void script_writer::write_string64(void)
+        {
+            auto const length = 1 + m_random.below(7);
+            for (std::uint64_t i = 0; i < 8; ++ i)
+                u8(i < length ? static_cast<std::uint8_t>('A' + m_random.below(26)) : 0);
+        }
+    }
+
+    auto generate_script(command_set const & isa, game game, script_generator_options const & options, generated_script & script) -> bool
+    {
+        script.code.clear();
+        script.sections.clear();
+        script.instruction_count = 0;
+        if (game::gta3 != game && game::gtavc != game && game::gtalcs != game)
+            return false;
+        if (options.size > gs_size_max || options.mission_size > gs_size_max
+            || options.mission_count > (gs_size_max - options.size) / std::max<std::uint64_t>(options.mission_size, 1))
+            return false;
+        script_writer writer(isa, game, options, script);
+        if (! writer.prepare())
+            return false;
+        // every section may end up to an instruction (255 bytes) past its size
+        script.code.reserve(options.size + options.mission_count * options.mission_size + 256 * (1 + options.mission_count));
+        writer.write_section(options.size, false);
+        for (std::uint32_t i = 0; i < options.mission_count; ++ i)
+            writer.write_section(options.mission_size, true);
+        return true;
+    }
+}
@@ -0,0 +1,45 @@
+# pragma once
+# include <engine/engine.hpp>
+# include <engine/version.hpp>
+# include <cstdint>
+# include <vector>
+
+namespace idascm
+{
+    class command_set;
+
+    struct script_generator_options
+    {
+        std::uint64_t               seed            = 1;
+        std::uint64_t               size            = 64 * 1024;    // main section bytes, the last instruction may end past it
+        std::uint32_t               mission_count   = 0;            // sections after main, jumps inside them are mission relative (negative)
+        std::uint64_t               mission_size    = 16 * 1024;    // bytes per mission
+        std::uint32_t               jump_density    = 50;           // jump / call commands per 1000 instructions
+        std::uint32_t               variadic_max    = 16;           // longest variadic list
+        std::vector<std::uint16_t>  opcodes;                        // opcode mix, repeat an opcode to weight it
+                                                                    // empty - every command of the set
+    };
+
+    struct script_section
+    {
+        std::uint32_t   offset;
+        std::uint32_t   size;
+        std::uint64_t   instruction_count;
+        std::uint64_t   jump_count;         // address operands
+    };
+
+    struct generated_script
+    {
+        std::vector<std::uint8_t>   code;
+        std::vector<script_section> sections;           // main, then the missions
+        std::uint64_t               instruction_count;
+    };
+
+    // deterministic synthetic bytecode for benchmarks and stress tests: the same set,
+    // game and options give the same bytes on every platform
+    // operands follow the game's encoding (GTA III float16i, VC float32, LCS packed floats,
+    // arrays and timers), every address operand points at an instruction of its section
+    // commands calling functions (command_flag_function_call) are left out of the mix
+    // fails for other games, an empty mix or more than 2 GB of code
+    auto generate_script(command_set const & isa, game game, script_generator_options const & options, generated_script & script) -> bool;
+}
@@ -1,5 +1,6 @@
 # include <engine/version.hpp>
 # include <algorithm>
+# include <cstring>
 # include <string_view>
 
 namespace idascm
@@ -61,8 +62,8 @@ namespace idascm
             { version::gtalcs_psp,          "gtalcs_psp",           "GTA Librery City Stories (PlayStation Portable)"       },
             { version::gtalcs_anniversary,  "gtalcs_anniversary",   "GTA Librery City Stories (Anniversary Edition 2015)"   },
 
-            { version::gtavcs_ps2,          "gtavcs_ps2"            "GTA Vice City Stories (PlayStation 2)"                 },
-            { version::gtavcs_psp,          "gtavcs_psp"            "GTA Vice City Stories (PlayStation Portable)"          },
+            { version::gtavcs_ps2,          "gtavcs_ps2",           "GTA Vice City Stories (PlayStation 2)"                 },
+            { version::gtavcs_psp,          "gtavcs_psp",           "GTA Vice City Stories (PlayStation Portable)"          },
         };
     }
 
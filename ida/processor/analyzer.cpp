@@ -1,3 +1,4 @@
+# define IDASCM_LOG_SUBSYSTEM analyzer
 # include <ida/processor/analyzer.hpp>
 # include <engine/command.hpp>
 # include <engine/command_set.hpp>
@@ -6,6 +7,7 @@
 # include <engine/gtalcs/decoder_gtalcs.hpp>
 # include <engine/instruction.hpp>
 # include <core/logger.hpp>
+# include <core/profiler.hpp>
 # include <cassert>
 
 namespace idascm
@@ -56,9 +58,15 @@ namespace idascm
     auto analyzer::analyze_instruction(std::uint32_t address, instruction & ins) -> bool
     {
         assert(m_decoder);
-        auto const size = m_decoder->decode_instruction(address, ins);
+        decode_result result;
+        auto const size = m_decoder->decode_instruction(address, ins, result);
         if (! size)
         {
+            // unknown opcodes are data, not worth a message, the rest is routine while IDA probes
+            // data too: debug level costs a level check only and stays rate limited when enabled
+            if (decode_error::unknown_opcode != result.error)
+                IDASCM_LOG_D("decoding failed at 0x%08x+%u: %s (operand %d)", address, result.offset, to_string(result.error),
+                    decode_operand_none == result.operand ? -1 : result.operand);
             return false;
         }
         return true;
@@ -66,10 +74,11 @@ namespace idascm
 
     auto analyzer::analyze_instruction(insn_t & insn) -> bool
     {
+        IDASCM_PROFILE_ZONE("analyzer::analyze_instruction");
         instruction src = {};
         if (! analyze_instruction(insn.ea, src))
             return false;
-        IDASCM_LOG_D("analyze +0x%04x %s", insn.ea, src.command->name);
+        IDASCM_LOG_D("analyze +0x%04x %s", insn.ea, src.command->name.c_str());
         if (! handle_instruction(src, insn))
             return false;
         return true;
@@ -1,8 +1,10 @@
+# define IDASCM_LOG_SUBSYSTEM emulator
 # include <ida/processor/emulator.hpp>
 # include <ida/processor/analyzer.hpp>
 # include <engine/command_set.hpp>
 # include <engine/command.hpp>
 # include <core/logger.hpp>
+# include <core/profiler.hpp>
 
 namespace idascm
 {
@@ -94,6 +96,7 @@ namespace idascm
 
     auto emulator::emulate_instruction(insn_t const & insn) -> bool
     {
+        IDASCM_PROFILE_ZONE("emulator::emulate_instruction");
         assert(m_isa);
         auto const command = m_isa->get_command(insn.itype);
         assert(command);
@@ -101,7 +104,7 @@ namespace idascm
         {
             return false;
         }
-        IDASCM_LOG_D("emulate +0x%04x %s flags=0x%02x", insn.ea, command->name, command->flags);
+        IDASCM_LOG_D("emulate +0x%04x %s flags=0x%02x", insn.ea, command->name.c_str(), command->flags);
         for (std::uint8_t i = 0; i < std::size(insn.ops); ++ i)
         {
             emulate_operand(insn, insn.ops[i]);
@@ -130,41 +133,14 @@ namespace idascm
     auto emulator::get_autocomment(insn_t const & insn) const -> qstring
     {
         assert(m_isa);
-        auto const command = m_isa->get_command(insn.itype);
-        assert(command);
+        // rendered when the ISA was loaded
+        auto const text = m_isa->get_text(insn.itype);
+        assert(text);
 
         qstring comment;
-        comment.reserve(128);
-        if (command)
+        if (text)
         {
-            char buffer[32];
-            qsnprintf(buffer, sizeof(buffer) - 1, "0x%04x", insn.itype);
-            comment.append(buffer);
-
-            if (command->comment[0])
-            {
-                comment.append(" - ");
-                comment.append(command->comment.c_str());
-            }
-
-            qstring flags;
-            flags.reserve(128);
-            for (std::uint8_t i = 0; i < 8; ++ i)
-            {
-                std::uint8_t const flag = 1 << i;
-                if (command->flags & flag)
-                {
-                    if (! flags.empty())
-                        flags.append(", ");
-                    flags.append(to_string(command_flag(flag)));
-                }
-            }
-            if (! flags.empty())
-            {
-                comment.append(" (flags: ");
-                comment.append(flags);
-                comment.append(")");
-            }
+            comment.append(text->annotation.data(), text->annotation.size());
         }
 
         return comment;
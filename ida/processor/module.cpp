@@ -1,3 +1,4 @@
+# define IDASCM_LOG_SUBSYSTEM module
 # include <ida/processor/module.hpp>
 # include <ida/processor/analyzer.hpp>
 # include <ida/processor/emulator.hpp>
@@ -7,9 +8,30 @@
 # include <engine/command_set.hpp>
 # include <core/json.hpp>
 # include <core/logger.hpp>
+# include <core/profiler.hpp>
+# include <cstdlib>
+# include <string>
 
 namespace idascm
 {
+    namespace
+    {
+        // profiler summary to the log, trace to the IDASCM_PROFILE path
+        void write_profile(void)
+        {
+            auto & profiler = profiler::instance();
+            auto const path = std::getenv("IDASCM_PROFILE");
+            if (! path || ! profiler.is_recording())
+                return;
+            // one message, a line per message would run into the call site rate limit
+            std::string summary;
+            profiler.write_summary(summary);
+            IDASCM_LOG_I("profile:\n%s", summary.c_str());
+            if (! profiler.write_chrome_trace(path))
+                IDASCM_LOG_W("unable to write profile '%s'", path);
+        }
+    }
+
     module::module(void)
         : m_data_id(-1)
         , m_isa(nullptr)
@@ -86,6 +108,8 @@ namespace idascm
         {
             case processor_t::ev_init: // 0
             {
+                // ev_newprc follows shortly, by then most sets are in
+                processor_preload();
 # if IDA_SDK_VERSION >= 730
                 inf_set_be(false);
                 inf_set_gen_lzero(true);
@@ -94,6 +118,9 @@ namespace idascm
             }
             case processor_t::ev_term: // 1
             {
+                write_profile();
+                // the output window handler is still there
+                logger::instance().flush_suppressed();
 # if IDA_SDK_VERSION >= 750
                 clr_module_data(m_data_id);
 # endif
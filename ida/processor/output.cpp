@@ -1,14 +1,18 @@
+# define IDASCM_LOG_SUBSYSTEM output
 # include <ida/processor/output.hpp>
 # include <ida/processor/analyzer.hpp>
 # include <ida/processor/module.hpp>
 # include <engine/command_set.hpp>
 # include <engine/instruction.hpp>
+# include <engine/renderer.hpp>
 # include <core/logger.hpp>
+# include <core/profiler.hpp>
 
 namespace idascm
 {
     auto output::output_instruction(outctx_t & ctx) -> bool
     {
+        IDASCM_PROFILE_ZONE("output::output_instruction");
         assert(m_isa);
         auto command = m_isa->get_command(ctx.insn.itype);
         assert(command);
@@ -16,7 +20,7 @@ namespace idascm
         {
             return false;
         }
-        IDASCM_LOG_T("output: %s", command->name);
+        IDASCM_LOG_T("output: %s", command->name.c_str());
 
         output_mnemonics(ctx);
 
@@ -72,49 +76,48 @@ namespace idascm
 
     void output::output_mnemonics(outctx_t & ctx)
     {
-        auto command = m_isa->get_command(ctx.insn.itype);
-        assert(command);
+        auto const text = m_isa->get_text(ctx.insn.itype);
+        assert(text);
         // ctx.out_mnemonic();
         if (insn_inversion_flag(ctx.insn))
         {
             ctx.out_keyword("NOT");
             ctx.out_char(' ');
         }
-        if (command->name[0])
-        {
-            ctx.out_custom_mnem(command->name);
-        }
-        else
+        if (text)
         {
-            char name[32];
-            qsnprintf(name, sizeof(name) - 1, "UNKNOWN_0x%04x", ctx.insn.itype);
-            ctx.out_custom_mnem(name);
+            // zero terminated, UNKNOWN_0x%04x for unnamed commands
+            ctx.out_custom_mnem(text->mnemonic.data());
         }
     }
 
     namespace
     {
-        auto float_suffix(operand_type type) noexcept -> char const *
+        // zero terminated engine rendering, see engine/renderer.hpp
+        class rendered
         {
-            switch (type)
-            {
-                case operand_type::float0:
-                    return "f0";
-                case operand_type::float8:
-                    return "f8";
-                case operand_type::float16:
-                    return "f16";
-                case operand_type::float24:
-                    return "f24";
-                case operand_type::float32:
-                    return "f";
-            }
-            return nullptr;
-        }
+            public:
+                auto c_str(void) const noexcept -> char const *
+                {
+                    return m_text;
+                }
+
+            public:
+                template <typename function>
+                explicit rendered(function && fn) noexcept
+                {
+                    auto const end = fn(m_text, m_text + sizeof(m_text) - 1);
+                    *(end ? end : m_text) = '\0';
+                }
+
+            private:
+                char    m_text[64];
+        };
     }
 
     auto output::output_operand(outctx_t & ctx, op_t const & op) -> bool
     {
+        IDASCM_PROFILE_ZONE("output::output_operand");
         switch (op.type)
         {
             case o_void:
@@ -127,43 +130,32 @@ namespace idascm
                 {
                     case dt_packreal:
                     {
-                        char string[32] = { 0 };
-                        qsnprintf(string, sizeof(string) - 1, "%g", static_cast<int>(op.value) / 16.f);
-                        ctx.out_line(string, COLOR_NUMBER);
+                        rendered const text([&](char * first, char * last)
+                        {
+                            return render_float16i(first, last, static_cast<std::int16_t>(op.value));
+                        });
+                        ctx.out_line(text.c_str(), COLOR_NUMBER);
                         break;
                     }
                     case dt_float:
                     {
-                        char string[32] = { 0 };
-                        qsnprintf(string, sizeof(string) - 1, "%g", *reinterpret_cast<float const *>(&op.value));
-                        if (! strchr(string, '.'))
-                        {
-                            qstrncat(string, ".", sizeof(string) - 1);
-                        }
-                        qstrncat(string, float_suffix(op_type(op)), sizeof(string) - 1);
-                        // if (print_fpval(string, sizeof(string) - 1, &op.value, 4))
-                        if (true)
-                        {
-                            ctx.out_line(string, COLOR_NUMBER);
-                        }
-                        else
+                        rendered const text([&](char * first, char * last)
                         {
-                            ctx.out_tagon(COLOR_ERROR);
-                            ctx.out_btoa(op.value, 16);
-                            ctx.out_tagoff(COLOR_ERROR);
-                            remember_problem(PR_DISASM, ctx.insn.ea);
-                        }
+                            return render_float(first, last, *reinterpret_cast<float const *>(&op.value), op_type(op));
+                        });
+                        ctx.out_line(text.c_str(), COLOR_NUMBER);
                         break;
                     }
                     case dt_string:
                     {
-                        char string[16] = { 0 };
-                        get_bytes(string, 8, op.addr);
-                        // IDASCM_LOG_T("string: '%s'", string);
+                        char string[8] = { 0 };
+                        get_bytes(string, sizeof(string), op.addr);
+                        rendered const text([&](char * first, char * last)
+                        {
+                            return render_string64(first, last, string);
+                        });
                         ctx.out_tagon(COLOR_DSTR);
-                        ctx.out_char('\'');
-                        ctx.out_line(string);
-                        ctx.out_char('\'');
+                        ctx.out_line(text.c_str());
                         ctx.out_tagoff(COLOR_DSTR);
                         break;
                     }
@@ -178,24 +170,16 @@ namespace idascm
             // @REG
             case o_reg:
             {
-                char string[32];
-                qsnprintf(string, sizeof(string) - 1, "@%d", op.reg);
-                ctx.out_register(string);
+                rendered const text([&](char * first, char * last) { return render_local(first, last, op.reg); });
+                ctx.out_register(text.c_str());
                 return true;
             }
             // @REG[@REG, SIZE]
             case o_phrase:
             {
-                char string[32];
-                qsnprintf(string, sizeof(string) - 1, "@%d", op.addr);
-                ctx.out_register(string);
-                ctx.out_symbol('[');
-                qsnprintf(string, sizeof(string) - 1, "@%d", op.reg);
-                ctx.out_register(string);
-                ctx.out_symbol(',');
-                qsnprintf(string, sizeof(string) - 1, "%d", op_array_size(op));
-                ctx.out_line(string, COLOR_NUMBER);
-                ctx.out_symbol(']');
+                rendered const base([&](char * first, char * last) { return render_local(first, last, static_cast<std::int32_t>(op.addr)); });
+                ctx.out_register(base.c_str());
+                output_array_index(ctx, op, COLOR_NUMBER);
                 return true;
             }
             case o_displ:   // GLOBAL[@REG, SIZE]
@@ -221,19 +205,25 @@ namespace idascm
                 }
                 if (o_displ == op.type)
                 {
-                    ctx.out_symbol('[');
-                    char string[32];
-                    qsnprintf(string, sizeof(string) - 1, "@%d", op.reg);
-                    ctx.out_register(string);
-                    ctx.out_symbol(',');
-                    ctx.out_printf("%d", op_array_size(op));
-                    ctx.out_symbol(']');
+                    output_array_index(ctx, op, 0);
                 }
                 return true;
             }
         }
         return false;
     }
+
+    // [@REG,SIZE], render_array_index() in IDA colours (0 - size uncoloured)
+    void output::output_array_index(outctx_t & ctx, op_t const & op, color_t size_color)
+    {
+        ctx.out_symbol('[');
+        rendered const index([&](char * first, char * last) { return render_local(first, last, op.reg); });
+        ctx.out_register(index.c_str());
+        ctx.out_symbol(',');
+        rendered const size([&](char * first, char * last) { return render_integer(first, last, op_array_size(op)); });
+        ctx.out_line(size.c_str(), size_color);
+        ctx.out_symbol(']');
+    }
 }
 
 void idaapi out_insn(outctx_t & ctx)
@@ -31,6 +31,9 @@ namespace idascm
                 , m_analyzer(nullptr)
             {}
 
+        protected:
+            void output_array_index(outctx_t & ctx, op_t const & op, color_t size_color);
+
         protected:
             command_set const * m_isa;
             analyzer *          m_analyzer;
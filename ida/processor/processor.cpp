@@ -1,9 +1,14 @@
+# define IDASCM_LOG_SUBSYSTEM module
 # include <ida/processor/processor.hpp>
 # include <ida/processor/module.hpp>
 # include <engine/command_set.hpp>
 # include <engine/command_manager.hpp>
+# include <engine/command_preloader.hpp>
 # include <core/logger.hpp>
+# include <core/profiler.hpp>
 # include <array>
+# include <cstdlib>
+# include <vector>
 # include <windows.h>
 
 namespace idascm
@@ -55,8 +60,14 @@ namespace idascm
 # ifndef __EA64__
             static ida_logger logger;
 # endif
+            // messages repeated at every address IDA probes stay readable in the output window,
+            // the rest is summarized every 5 s and at ev_term
+            logger::instance().set_rate_limit(16, 1000, 5000);
             IDASCM_LOG_I("idascm %s", build_version());
             IDASCM_LOG_I("IDA_SDK_VERSION: %d", IDA_SDK_VERSION);
+            // IDASCM_PROFILE=<trace.json> records profiling zones, written at ev_term
+            if (std::getenv("IDASCM_PROFILE"))
+                profiler::instance().start();
         }
 
         char const * const g_register_names[] = \
@@ -148,7 +159,7 @@ namespace idascm
                 continue;
             if (auto cmd = isa->get_command(op))
             {
-                g_instruction_list[op].name    = cmd->name;
+                g_instruction_list[op].name    = cmd->name.c_str();
                 g_instruction_list[op].feature = 0;
                 for (std::size_t i = 0; i < cmd->argument_count; ++ i)
                 {
@@ -169,9 +180,16 @@ namespace idascm
         return g_isa;
     }
 
+    auto processor_preloader(void) -> command_preloader &
+    {
+        static command_preloader preloader(processor_command_manager());
+        return preloader;
+    }
+
+    // waits for the one set if processor_preload() has not loaded it yet
     auto processor_isa(version ver) -> command_set const *
     {
-        return processor_command_manager().get_set(ver);
+        return processor_preloader().get_set(ver);
     }
 
     namespace
@@ -198,6 +216,14 @@ namespace idascm
         };
     }
 
+    void processor_preload(void)
+    {
+        std::vector<version> versions(std::begin(gs_processor_table), std::end(gs_processor_table));
+        auto const count = versions.size();
+        if (processor_preloader().start(std::move(versions)))
+            IDASCM_LOG_I("Preloading %zu command sets", count);
+    }
+
     auto processor_version(int proc_id) noexcept -> version
     {
         if (proc_id >= 0 && proc_id < std::size(gs_processor_table))
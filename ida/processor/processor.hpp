@@ -16,8 +16,13 @@ namespace idascm
 {
     class command_set;
     class command_manager;
+    class command_preloader;
 
+    // use processor_isa() while a preload may be running
     auto processor_command_manager(void) -> command_manager &;
+    auto processor_preloader(void) -> command_preloader &;
+    // starts loading the ISA of every supported version in the background, once
+    void processor_preload(void);
 
     void processor_set_current_isa(command_set const * set);
     auto processor_current_isa(void) -> command_set const *;
@@ -0,0 +1,24 @@
+# pragma once
+
+namespace idascm
+{
+    // ISA with every argument kind the script generator encodes, for the tests that decode
+    // generated scripts (CALL_FUNC is there to check it is left out of the mix)
+    inline char const g_generated_isa[] = R"(
+    {
+        "version": "gtavc_pc",
+        "commands": {
+            "0x0001": { "name": "WAIT", "args": [ "integer" ] },
+            "0x0002": { "name": "GOTO", "args": [ "address" ], "flags": [ "jump", "stop" ] },
+            "0x0004": { "name": "SET_VAR_INT", "args": [ "global", "integer" ] },
+            "0x0005": { "name": "SET_VAR_FLOAT", "args": [ "global", "real" ] },
+            "0x0006": { "name": "SET_LVAR_INT", "args": [ "local", "int8", "int32" ] },
+            "0x0018": { "name": "IS_INT_VAR_GREATER_THAN_NUMBER", "args": [ "any", "any" ], "flags": [ "condition" ] },
+            "0x004d": { "name": "GOTO_IF_FALSE", "args": [ "address" ], "flags": [ "jump", "conditional" ] },
+            "0x004f": { "name": "START_NEW_SCRIPT", "args": [ "address", "..." ], "flags": [ "call" ] },
+            "0x03a4": { "name": "SCRIPT_NAME", "args": [ "string64" ] },
+            "0x0541": { "name": "CALL_FUNC", "args": [ "any", "any", "..." ], "flags": [ "function_call" ] },
+        },
+    }
+    )";
+}
@@ -0,0 +1,116 @@
+# define IDASCM_ALLOCATION_HOOKS
+# include <core/allocation_tracker.hpp>
+# include <atomic>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <cstring>
+# include <memory>
+# include <string>
+# include <thread>
+# include <vector>
+
+namespace
+{
+    // keeps the compiler from eliding new/delete pairs, written from several threads
+    std::atomic<void *> g_sink(nullptr);
+
+    template <typename type>
+    auto sink(type * pointer) -> type *
+    {
+        g_sink.store(pointer, std::memory_order_relaxed);
+        return pointer;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    auto const installed = allocation_tracker::is_installed();
+    assert(installed);
+
+    // every form of new is seen
+    {
+        auto const counters = count_allocations([]
+        {
+            delete sink(new int(1));
+            delete [] sink(new char[100]);
+            delete sink(new (std::nothrow) long(2));
+            struct alignas(64) wide { char data[64]; };
+            delete sink(new wide);
+        });
+        assert(4 == counters.allocations && 4 == counters.deallocations);
+        assert(counters.bytes >= sizeof(int) + 100 + sizeof(long) + 64);
+    }
+
+    // nested scopes both see the inner allocations
+    {
+        allocation_tracker::scope outer("outer");
+        auto const first = std::make_unique<std::vector<int>>(10);
+        {
+            allocation_tracker::scope inner("inner");
+            std::string text(1000, 'x');
+            assert(1 == inner.counters().allocations);
+            assert(0 == std::strcmp("inner", inner.name()));
+        }
+        assert(3 == outer.counters().allocations);
+        assert(1 == outer.counters().deallocations);
+    }
+
+    // named scopes add up per name across threads, anonymous ones are not reported
+    {
+        allocation_tracker::reset_scopes();
+        auto const work = []
+        {
+            for (int i = 0; i < 10; ++ i)
+            {
+                allocation_tracker::scope scope("work");
+                delete sink(new int(i));
+            }
+            allocation_tracker::scope unnamed;
+            delete sink(new int(0));
+        };
+        std::thread thread(work);
+        work();
+        thread.join();
+        auto const scopes = allocation_tracker::summarize();
+        // the scopes of the earlier blocks went away before the reset
+        assert(1 == scopes.size() && 0 == std::strcmp("work", scopes[0].name));
+        assert(20 == scopes[0].count && 20 == scopes[0].counters.allocations && 20 == scopes[0].counters.deallocations);
+        assert(20 * sizeof(int) == scopes[0].counters.bytes);
+        std::string text;
+        allocation_tracker::write_summary(text);
+        assert(text.find("\nwork ") != std::string::npos);
+        allocation_tracker::reset_scopes();
+        auto const cleared = allocation_tracker::summarize();
+        assert(cleared.empty());
+    }
+
+    // thread counters only see their own thread, process counters see everything
+    {
+        auto const process = allocation_tracker::process_counters();
+        allocation_tracker::scope scope;
+        std::thread thread([]
+        {
+            for (int i = 0; i < 100; ++ i)
+                delete sink(new int(i));
+        });
+        auto const own = scope.counters().allocations;
+        thread.join();
+        // std::thread itself allocates its state on this thread
+        assert(scope.counters().allocations == own);
+        assert((allocation_tracker::process_counters() - process).allocations >= 100);
+    }
+
+    int values[16] = {};
+    auto const free = is_allocation_free([&]
+    {
+        for (auto & value : values)
+            value += 1;
+    });
+    auto const allocating = is_allocation_free([] { std::vector<int> values(16); sink(values.data()); });
+    assert(free && ! allocating);
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+# include <core/arena.hpp>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <cstdint>
+# include <cstring>
+# include <map>
+# include <string>
+# include <vector>
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    // alignment and block reuse
+    {
+        arena memory(256);
+        assert(0 == memory.block_count() && 0 == memory.used());
+        auto const a = memory.allocate(1, 1);
+        auto const b = memory.allocate(8, 8);
+        auto const c = memory.allocate(16, 16);
+        assert(a && b && c);
+        assert(0 == reinterpret_cast<std::uintptr_t>(b) % 8);
+        assert(0 == reinterpret_cast<std::uintptr_t>(c) % 16);
+        assert(1 == memory.block_count());
+        auto const misaligned = memory.allocate(1, 3);
+        assert(! misaligned);
+
+        // oversized requests get a block of their own
+        auto const large = memory.allocate(1000);
+        assert(large && 2 == memory.block_count() && memory.capacity() >= 1256);
+        std::memset(large, 0xcc, 1000);
+
+        memory.reset();
+        assert(0 == memory.used() && 2 == memory.block_count());
+        auto const reused = memory.allocate(1, 1);
+        assert(a == reused);
+        assert(2 == memory.block_count());
+
+        memory.release();
+        assert(0 == memory.block_count() && 0 == memory.capacity());
+        auto const fresh = memory.allocate(1);
+        assert(fresh);
+    }
+
+    // scoped rewind keeps earlier allocations
+    {
+        arena memory(128);
+        auto const kept = memory.store("kept");
+        auto const used = memory.used();
+        {
+            arena::scope scope(memory);
+            for (int i = 0; i < 100; ++ i)
+            {
+                auto const block = memory.allocate(64);
+                assert(block);
+            }
+            assert(memory.block_count() > 1);
+        }
+        assert(used == memory.used());
+        assert(kept == "kept" && '\0' == kept.data()[4]);
+        auto const blocks = memory.block_count();
+        {
+            arena::scope scope(memory);
+            for (int i = 0; i < 100; ++ i)
+            {
+                auto const block = memory.allocate(64);
+                assert(block);
+            }
+        }
+        assert(blocks == memory.block_count());
+        auto const empty = memory.store("");
+        assert(empty.empty() && used == memory.used());
+    }
+
+    // typed helpers and moves
+    {
+        struct point { int x; int y; };
+        arena memory;
+        auto const p = memory.make<point>(1, 2);
+        assert(p && 1 == p->x && 2 == p->y);
+        auto const values = memory.make_array<std::uint32_t>(100);
+        assert(values && 0 == reinterpret_cast<std::uintptr_t>(values) % alignof(std::uint32_t));
+        arena other(static_cast<arena &&>(memory));
+        assert(0 == memory.block_count() && 1 == other.block_count());
+        assert(1 == p->x);
+        memory = static_cast<arena &&>(other);
+        assert(1 == memory.block_count() && 0 == other.block_count());
+    }
+
+    // STL containers
+    {
+        arena memory;
+        std::vector<int, arena_allocator<int>> vector(memory);
+        for (int i = 0; i < 1000; ++ i)
+            vector.push_back(i);
+        for (int i = 0; i < 1000; ++ i)
+            assert(i == vector[i]);
+        using string = std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+        std::map<int, string, std::less<int>, arena_allocator<std::pair<int const, string>>> map(memory);
+        for (int i = 0; i < 100; ++ i)
+            map.emplace(i, string("a fairly long value that does not fit the small buffer", memory));
+        assert(100 == map.size() && map.at(42)[0] == 'a');
+        assert(arena_allocator<int>(memory) == arena_allocator<char>(memory));
+    }
+
+    return 0;
+}
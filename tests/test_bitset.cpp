@@ -0,0 +1,103 @@
+# include <core/bitset.hpp>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <random>
+# include <vector>
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    // word helpers
+    {
+        assert(0 == bit_count(std::uint64_t(0)) && 64 == bit_count(~std::uint64_t(0)));
+        assert(0 == bit_lowest(1) && 63 == bit_lowest(std::uint64_t(1) << 63));
+        std::vector<std::uint64_t> words(1001);
+        std::size_t expected = 0;
+        for (std::size_t i = 0; i < words.size(); ++ i)
+        {
+            words[i] = i * 0x9e3779b97f4a7c15ull;
+            expected += bit_count(words[i]);
+        }
+        for (std::size_t count : { 0, 3, 16, 17, 1000, 1001 })
+        {
+            std::size_t partial = 0;
+            for (std::size_t i = 0; i < count; ++ i)
+                partial += bit_count(words[i]);
+            assert(partial == bit_count(words.data(), count));
+        }
+        assert(expected == bit_count(words.data(), words.size()));
+    }
+
+    // fixed size
+    {
+        fixed_bitset<0x1000> opcodes;
+        assert(opcodes.none() && 0x1000 == opcodes.size() && 0x1000 == opcodes.find_first());
+        opcodes.set(0x004f);
+        opcodes.set(0x0fff);
+        assert(opcodes.test(0x004f) && ! opcodes.test(0x0050) && 2 == opcodes.count());
+        assert(0x004f == opcodes.find_first() && 0x0fff == opcodes.find_next(0x0050));
+        assert(1 == opcodes.rank(0x0050) && 2 == opcodes.rank(0x1000));
+        opcodes.flip();
+        assert(0x1000 - 2 == opcodes.count() && ! opcodes.test(0x004f));
+        fixed_bitset<70> odd;
+        odd.set();
+        assert(70 == odd.count());
+        odd.flip(69);
+        assert(69 == odd.count() && 69 == odd.rank(70));
+    }
+
+    // dynamic against vector<bool>
+    {
+        std::mt19937 random(7);
+        for (std::size_t size : { 1, 63, 64, 65, 1000, 100000 })
+        {
+            dynamic_bitset bits(size);
+            std::vector<bool> expected(size);
+            for (std::size_t i = 0; i < size / 3 + 1; ++ i)
+            {
+                auto const index = random() % size;
+                bits.set(index);
+                expected[index] = true;
+            }
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < size; ++ i)
+            {
+                assert(bits.test(i) == expected[i]);
+                assert(bits.rank(i) == count);
+                count += expected[i];
+            }
+            assert(bits.count() == count);
+
+            bitset_rank_index index;
+            index.build(bits);
+            std::size_t rank = 0;
+            for (std::size_t i = 0; i <= size; ++ i)
+            {
+                assert(index.rank(i) == rank);
+                if (i < size)
+                    rank += expected[i];
+            }
+
+            std::vector<std::size_t> visited;
+            bits.for_each([&visited](std::size_t i) { visited.push_back(i); });
+            std::vector<std::size_t> found;
+            for (auto i = bits.find_first(); i < bits.size(); i = bits.find_next(i + 1))
+                found.push_back(i);
+            assert(visited == found && visited.size() == count);
+
+            auto copy = bits;
+            copy ^= bits;
+            assert(copy.none());
+            copy |= bits;
+            assert(copy == bits);
+            copy.resize(size / 2);
+            assert(copy.count() == bits.rank(size / 2));
+            copy.resize(size);
+            assert(copy.count() == bits.rank(size / 2));
+        }
+    }
+
+    return 0;
+}
@@ -1,11 +1,31 @@
+# define IDASCM_ALLOCATION_HOOKS
+# include <core/allocation_tracker.hpp>
 # include <engine/command_set.hpp>
 # include <engine/command_manager.hpp>
+# include <engine/command_preloader.hpp>
+# include <engine/decoder_statistics.hpp>
+# include <engine/gta3/decoder_gta3.hpp>
+# include <engine/gtalcs/decoder_gtalcs.hpp>
 # include <engine/gtavc/decoder_gtavc.hpp>
 # include <engine/instruction.hpp>
+# include <engine/renderer.hpp>
+# include <engine/script_generator.hpp>
 # include <engine/command_set.hpp>
 # include <core/json.hpp>
+# include <core/memory_report.hpp>
 # include <core/logger.hpp>
+# include <core/thread_pool.hpp>
+# include <tests/generated_isa.hpp>
+// checks stay on in Release builds
+# undef NDEBUG
 # include <cassert>
+# include <cstdio>
+# include <cstring>
+# include <filesystem>
+# include <future>
+# include <memory>
+# include <string>
+# include <vector>
 
 namespace idascm
 {
@@ -24,6 +44,102 @@ namespace idascm
             },
         }
         )";
+
+        char const gs_document[] = R"(
+        {
+            "version": "gtavc_pc",
+            "parent": "gtavc_ps2",
+            "meta": { "ignored": [ { "name": "x" } ] },
+            "commands": {
+                "0x0001": { "name": "WAIT", "args": 1, "flags": [ "stop", "unknown" ], "comment": "ms" },
+                "0x004f": { "name": "START_NEW_SCRIPT", "args": [ "address", { "type": "..." }, { } ], "flags": [ "call" ] },
+                "bogus": { "name": "SKIPPED" },
+            },
+        }
+        )";
+
+        char const gs_parent_document[] = R"(
+        {
+            "version": "gtavc_ps2",
+            "commands": {
+                "0x0002": { "name": "GOTO", "args": [ "address" ], "flags": [ "jump", "stop" ] },
+            },
+        }
+        )";
+
+        void write_file(std::filesystem::path const & path, char const * text)
+        {
+            auto const file = std::fopen(path.string().c_str(), "wb");
+            assert(file);
+            std::fwrite(text, 1, std::strlen(text), file);
+            std::fclose(file);
+        }
+
+        // decodes a generated script back, every address operand must land on an instruction of its section
+        template <typename decoder_type>
+        void check_generated(command_set const & isa, game game)
+        {
+            script_generator_options options;
+            options.seed            = 7;
+            options.size            = 32 * 1024;
+            options.mission_count   = 3;
+            options.mission_size    = 4 * 1024;
+            options.jump_density    = 100;
+            generated_script script;
+            auto const generated = generate_script(isa, game, options, script);
+            assert(generated);
+            assert(4 == script.sections.size() && script.instruction_count > 0);
+
+            memory_api_buffer memory(script.code.data(), script.code.size());
+            decoder_type dec;
+            dec.set_command_set(&isa);
+            dec.set_memory_api(&memory);
+            std::vector<std::uint8_t> starts(script.code.size());
+            std::vector<instruction> jumps;
+            std::uint64_t count = 0;
+            bool negated = false;
+            instruction in = {};
+            for (std::uint32_t address = 0; address < script.code.size(); ++ count)
+            {
+                decode_result result;
+                auto const size = dec.decode_instruction(address, in, result);
+                assert(size && decode_error::none == result.error);
+                assert(0x0541 != in.opcode);
+                negated |= 0 != (in.flags & instruction_flag_not);
+                starts[address] = 1;
+                for (std::uint8_t i = 0; i < in.operand_count; ++ i)
+                    if (i < in.command->argument_count && argument_type::address == in.command->argument_list[i])
+                        jumps.push_back(in);
+                address += size;
+            }
+            assert(count == script.instruction_count && negated);
+
+            std::uint64_t jump_count = 0;
+            for (auto const & section : script.sections)
+                jump_count += section.jump_count;
+            assert(jumps.size() == jump_count && jump_count > script.instruction_count / 20);
+            for (auto const & jump : jumps)
+            {
+                auto section = script.sections.begin();
+                while (jump.address >= section->offset + section->size)
+                    ++ section;
+                std::int32_t target = 0;
+                auto const is_int = to_int(jump.operand_list[0], target);
+                assert(is_int);
+                auto const first = section == script.sections.begin();
+                assert(first ? target >= 0 : target < 0);
+                auto const address = first ? target : section->offset - target;
+                assert(address >= section->offset && address < section->offset + section->size && starts[address]);
+            }
+
+            // same seed, same bytes
+            generated_script again;
+            auto const same = generate_script(isa, game, options, again);
+            assert(same && again.code == script.code);
+            options.seed = 8;
+            auto const other = generate_script(isa, game, options, again);
+            assert(other && again.code != script.code);
+        }
     }
 }
 
@@ -75,6 +191,346 @@ int main(int argc, char * argv[])
         assert(ins.operand_count == 3);
     }
     assert(ip == sizeof(buffer));
+
+    // steady state decoding and command lookup never touch the heap
+    {
+        auto const decode_free = is_allocation_free([&]
+        {
+            instruction in = {};
+            for (std::uint32_t address = 0; address < sizeof(buffer); address += dec.decode_instruction(address, in))
+                assert(in.command == isa.get_command(in.opcode));
+            decode_result result;
+            auto const size = dec.decode_instruction(sizeof(buffer), in, result);
+            assert(! size && decode_error::truncated == result.error);
+        });
+        assert(decode_free);
+        decoder_statistics stats;
+        dec.set_statistics(&stats);
+        instruction in = {};
+        dec.decode_instruction(0, in);  // first use registers the thread's counters
+        auto const counting_free = is_allocation_free([&] { dec.decode_instruction(0, in); });
+        assert(counting_free);
+        dec.set_statistics(nullptr);
+    }
+
+    // batch decoding, instruction storage comes from an arena
+    {
+        arena memory;
+        arena::scope scope(memory);
+        instruction_batch batch(memory);
+        decode_result result;
+        auto const batch_end = dec.decode_batch(0, sizeof(buffer), batch, &result);
+        assert(sizeof(buffer) == batch_end);
+        assert(decode_error::none == result.error && batch[1].size == result.offset);
+        assert(2 == batch.size());
+        assert(batch[0].opcode == 0x004f && batch[1].opcode == 0x03cb);
+        assert(batch[1].address == batch[0].size);
+        auto const first_size = batch[0].size;
+        batch.clear();
+        auto const first_end = dec.decode_batch(0, 1, batch);
+        assert(first_size == first_end && 1 == batch.size());
+    }
+
+    // decoder statistics and failure reasons
+    {
+        decoder_statistics stats(version::gtavc_pc);
+        dec.set_statistics(&stats);
+        instruction in = {};
+        auto const first_size = dec.decode_instruction(0, in);
+        auto const second_size = dec.decode_instruction(in.size, in);
+        assert(first_size && second_size);
+        std::uint8_t broken[] = \
+        {
+            0xcb, 0x03, 0x06, 0x00, 0x00, 0xa6, 0x42, 0x07,  // bad type byte in the second operand
+            0x00, 0x10,                                      // unknown opcode
+            0xcb, 0x03, 0x06, 0x00, 0x00,                    // float32 cut short
+        };
+        auto broken_memory = memory_api_buffer(broken, sizeof(broken));
+        dec.set_memory_api(&broken_memory);
+        decode_result result;
+        auto size = dec.decode_instruction(0, in, result);
+        assert(! size && decode_error::bad_operand_type == result.error && 1 == result.operand && 7 == result.offset);
+        size = dec.decode_instruction(8, in, result);
+        assert(! size && decode_error::unknown_opcode == result.error && decode_operand_none == result.operand && 0 == result.offset);
+        size = dec.decode_instruction(10, in, result);
+        assert(! size && decode_error::truncated == result.error && 0 == result.operand && 2 == result.offset);
+        size = dec.decode_instruction(sizeof(broken) - 1, in);
+        assert(! size);
+        {
+            arena memory;
+            instruction_batch batch(memory);
+            auto const end = dec.decode_batch(0, sizeof(broken), batch, &result);
+            assert(0 == end && batch.empty());
+            assert(decode_error::bad_operand_type == result.error);
+        }
+        dec.set_memory_api(&memory);
+        dec.set_statistics(nullptr);
+
+        auto const totals = stats.collect();
+        assert(2 == totals.instructions && sizeof(buffer) == totals.bytes);
+        assert(1 == totals.opcodes[0x004f] && 1 == totals.opcodes[0x03cb]);
+        assert(3 == totals.opcode_failures[0x03cb] && 1 == totals.opcode_failures[0x1000]);
+        assert(2 == totals.failures[std::size_t(decode_error::bad_operand_type)]);
+        assert(1 == totals.failures[std::size_t(decode_error::unknown_opcode)]);
+        assert(2 == totals.failures[std::size_t(decode_error::truncated)]);
+        assert(4 == totals.operand_types[to_uint(operand_type::float32)]);
+        // START_NEW_SCRIPT: address, then three variadic operands
+        assert(1 == totals.variadic_lengths[3]);
+
+        std::string json;
+        stats.write_json(json);
+        auto const root = json_value::from_string(json.c_str(), json.size()).to_object();
+        assert(root.is_valid() && 4 == root["opcodes"].to_object().size());
+        std::string text;
+        stats.write_text(text);
+        assert(std::string::npos != text.find("gtavc_pc: 2 instructions"));
+
+        stats.reset();
+        assert(0 == stats.collect().instructions);
+    }
+
+    // text rendering, same as the IDA module prints it
+    {
+        command_text const start_text = { "", "START_NEW_SCRIPT", "NOT START_NEW_SCRIPT", "call" };
+        command_text const scene_text = { "", "LOAD_SCENE", "NOT LOAD_SCENE", "" };
+        char line[256];
+        render_options options;
+        instruction first = {};
+        instruction second = {};
+        auto const size = dec.decode_instruction(0, first);
+        dec.decode_instruction(size, second);
+        auto end = render_instruction(line, line + sizeof(line), first, start_text, options);
+        assert(end && std::string(line, end) == "START_NEW_SCRIPT loc_8, -1, -21555, 0.f");
+        end = render_instruction(line, line + sizeof(line), second, scene_text, options);
+        assert(end && std::string(line, end) == "LOAD_SCENE 83.f, -849.8f, 9.3f");
+        end = render_instruction(line, line + 20, first, start_text, options);
+        assert(! end);
+        auto const render_free = is_allocation_free([&]
+        {
+            auto const first_end = render_instruction(line, line + sizeof(line), first, start_text, options);
+            auto const second_end = render_instruction(line, line + sizeof(line), second, scene_text, options);
+            assert(first_end && second_end);
+        });
+        assert(render_free);
+
+        // mission relative addresses, named globals, arrays, negation, hidden timers
+        first.flags = instruction_flag_not;
+        first.operand_count = 6;
+        first.operand_list[0].value_int32 = -0x20;
+        first.operand_list[1] = {};
+        first.operand_list[1].type = operand_type::global_array;
+        first.operand_list[1].array_address = 0x100;
+        first.operand_list[1].array_index = 5;
+        first.operand_list[1].array_size = 10;
+        first.operand_list[2] = first.operand_list[1];
+        first.operand_list[2].type = operand_type::local_array;
+        first.operand_list[2].array_address = 3;
+        first.operand_list[3] = {};
+        first.operand_list[3].type = operand_type::timer;
+        first.operand_list[4] = {};
+        first.operand_list[4].type = operand_type::float16i;
+        first.operand_list[4].value_int16 = -40;
+        first.operand_list[5] = {};
+        first.operand_list[5].type = operand_type::string64;
+        std::memcpy(first.operand_list[5].value_string64, "MAIN\0\0\0\0", 8);
+        options.base = 0x1000;
+        options.name = [](void *, std::uint32_t address, bool code) -> std::string_view
+        {
+            return code ? std::string_view() : 0x100 == address ? "$array" : "";
+        };
+        end = render_instruction(line, line + sizeof(line), first, start_text, options);
+        assert(end && std::string(line, end) == "NOT START_NEW_SCRIPT loc_1020, $array[@5,10], @3[@5,10], -2.5, 'MAIN'");
+        options.relative = false;
+        end = render_instruction(line, line + sizeof(line), first, start_text, options);
+        assert(end && std::string(line, end) == "NOT START_NEW_SCRIPT -32, $array[@5,10], @3[@5,10], -2.5, 'MAIN'");
+        options.relative = true;
+        first.operand_list[0].type = operand_type::global;
+        first.operand_list[0].value_address = 0x1abc;
+        end = render_instruction(line, line + sizeof(line), first, scene_text, options);
+        assert(end && std::string(line, end).find("NOT LOAD_SCENE dword_1ABC, ") == 0);
+        first.operand_count = 0;
+        end = render_instruction(line, line + sizeof(line), first, scene_text, options);
+        assert(end && std::string(line, end) == "NOT LOAD_SCENE");
+
+        // floats print as qsnprintf("%g") did, packed ones keep their suffix
+        std::uint32_t bits = 12345;
+        for (int i = 0; i < 100000; ++ i)
+        {
+            bits = bits * 1664525u + 1013904223u;
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            char expected[64];
+            std::snprintf(expected, sizeof(expected), "%g", value);
+            if (! std::strchr(expected, '.'))
+                std::strcat(expected, ".");
+            std::strcat(expected, "f24");
+            end = render_float(line, line + sizeof(line), value, operand_type::float24);
+            assert(end && std::string(line, end) == expected);
+            std::snprintf(expected, sizeof(expected), "%g", static_cast<std::int16_t>(bits) / 16.f);
+            end = render_float16i(line, line + sizeof(line), static_cast<std::int16_t>(bits));
+            assert(end && std::string(line, end) == expected);
+        }
+        end = render_float(line, line + sizeof(line), 0.f, operand_type::float0);
+        assert(end && std::string(line, end) == "0.f0");
+    }
+
+    // streaming document load
+    command_set streamed(version::gtavc_pc);
+    version parent = version::unknown;
+    auto const streamed_loaded = streamed.load_document(gs_document, std::strlen(gs_document), parent);
+    assert(streamed_loaded && parent == version::gtavc_ps2);
+    auto const wait = streamed.get_command(0x0001);
+    assert(wait && wait->name == "WAIT");
+    assert(wait->argument_count == 1 && wait->argument_list[0] == argument_type::any);
+    assert(wait->flags == command_flag_stop && wait->comment == "ms");
+    auto const start = streamed.get_command(0x004f);
+    assert(start && start->argument_count == 3 && start->flags == command_flag_call);
+    assert(start->argument_list[0] == argument_type::address);
+    assert(start->argument_list[1] == argument_type::variadic);
+    assert(start->argument_list[2] == argument_type::unknown);
+    // names are interned: same text, same handle across sets
+    assert(start->name == isa.get_command(0x004f)->name);
+    assert(start->name.c_str() == isa.get_command(0x004f)->name.c_str());
+    assert(start->name != wait->name && wait->comment == "ms" && start->comment.empty());
+
+    // rendered text
+    {
+        auto const wait_text = streamed.get_text(0x0001);
+        assert(wait_text && wait_text->annotation == "0x0001 - ms (flags: stop)" && wait_text->flags == "stop");
+        assert(wait_text->mnemonic == "WAIT" && wait_text->mnemonic_not == "NOT WAIT");
+        assert('\0' == wait_text->mnemonic.data()[wait_text->mnemonic.size()]);
+        assert(streamed.get_text(0x004f)->annotation == "0x004f (flags: call)");
+        assert(! streamed.get_text(0x0002));
+        command_set unnamed(version::gtavc_ps2);
+        auto const added = unnamed.add_command(0x0123, command {});
+        assert(added);
+        auto const text = unnamed.get_text(0x0123);
+        assert(text->mnemonic == "UNKNOWN_0x0123" && text->annotation == "0x0123" && text->flags.empty());
+        streamed.set_parent(&unnamed);
+        assert(streamed.get_text(0x0123) == text);
+        streamed.set_parent(nullptr);
+    }
+
+    // memory reports
+    {
+        auto const report = streamed.memory_usage();
+        assert(2 == streamed.size());
+        assert(report.get("lookup") == 0x1000 * sizeof(command *) && report.get("commands") == 0x1000 * sizeof(command));
+        assert(report.get("strings") == sizeof("WAIT") + sizeof("ms") + sizeof("START_NEW_SCRIPT"));
+        assert(report.get("text") > 0 && report.total() == sizeof(command_set) + report.get("text"));
+        // loads nothing, the uuid maps alone are over 2.5 MB
+        auto const manager = std::make_unique<command_manager>("");
+        auto const manager_report = manager->memory_usage();
+        assert(manager_report.total() == sizeof(command_manager) && manager_report.get("uuid maps") > 2500000);
+        decoder_statistics stats;
+        dec.set_statistics(&stats);
+        instruction in = {};
+        dec.decode_instruction(0, in);
+        auto const decoder_report = dec.memory_usage();
+        dec.set_statistics(nullptr);
+        assert(decoder_report.get("statistics/counters") > 0 && decoder_report.total() == decoder_report.get("object"));
+    }
+
+    // synthetic scripts in every encoding
+    {
+        command_set generated(version::gtavc_pc);
+        auto const loaded = generated.load_document(g_generated_isa, std::strlen(g_generated_isa), parent);
+        assert(loaded);
+        check_generated<decoder_gta3>(generated, game::gta3);
+        check_generated<decoder_gtavc>(generated, game::gtavc);
+        check_generated<decoder_gtalcs>(generated, game::gtalcs);
+        script_generator_options options;
+        generated_script script;
+        auto const other_game = generate_script(generated, game::gtasa, options, script);
+        assert(! other_game);
+        options.opcodes = { 0x0541, 0x7fff };
+        auto const no_opcodes = generate_script(generated, game::gtavc, options, script);
+        assert(! no_opcodes);
+        options.opcodes = { 0x0002 };
+        options.size    = 1024;
+        auto const gotos = generate_script(generated, game::gtavc, options, script);
+        assert(gotos);
+        // GOTO takes 7 bytes, the last one ends past the size
+        assert(147 * 7 == script.code.size() && 147 == script.instruction_count && 1 == script.sections.size());
+    }
+
+    // background loading
+    {
+        std::error_code error;
+        auto const root = std::filesystem::temp_directory_path(error) / "idascm-test-preload";
+        std::filesystem::create_directories(root, error);
+        write_file(root / "gtavc_pc.json", gs_document);
+        write_file(root / "gtavc_ps2.json", gs_parent_document);
+        {
+            auto const manager = std::make_unique<command_manager>(root.string().c_str());
+            command_preloader preloader(*manager);
+            assert(! preloader.is_started() && preloader.is_ready());
+            auto const started = preloader.start({ version::gtavc_pc, version::gta3_pc });
+            assert(started);
+            auto const restarted = preloader.start({ version::gtavc_ps2 });
+            assert(preloader.is_started() && ! restarted);
+            // the parent comes along, the missing file is skipped
+            auto const count = preloader.handle().get();
+            assert(1 == count && preloader.is_ready());
+            auto const set = preloader.get_set(version::gtavc_pc);
+            assert(set && set->get_command(0x0002) && set->get_command(0x0001));
+            auto const uuid = manager->get_command_uuid(version::gtavc_pc, 0x0002);
+            assert(uuid && uuid == manager->get_command_uuid(version::gtavc_ps2, 0x0002));
+            auto const missing = preloader.get_set(version::gta3_pc);
+            assert(! missing);
+        }
+        {
+            // loads without a rebuild leave the uuid maps stale until rebuild_uuids()
+            auto const manager = std::make_unique<command_manager>(root.string().c_str());
+            version const versions[] = { version::gtavc_pc, version::gta3_pc };
+            auto const count = manager->load_sets(versions, std::size(versions), false);
+            assert(1 == count && 0 == manager->get_command_uuid(version::gtavc_pc, 0x0002));
+            manager->rebuild_uuids();
+            auto const uuid = manager->get_command_uuid(version::gtavc_pc, 0x0002);
+            assert(uuid && uuid == manager->get_command_uuid(version::gtavc_ps2, 0x0002));
+        }
+        {
+            // get_set right after start shares the manager with the load
+            auto const manager = std::make_unique<command_manager>(root.string().c_str());
+            command_preloader preloader(*manager);
+            preloader.start({ version::gtavc_ps2, version::gtavc_pc });
+            auto const set = preloader.get_set(version::gtavc_pc);
+            preloader.wait();
+            auto const count = preloader.handle().get();
+            assert(set && preloader.is_ready() && 2 == count);
+        }
+        {
+            // get_set does not wait for the rest of the load: the only worker is busy,
+            // the load is still queued when the set comes back
+            auto const manager = std::make_unique<command_manager>(root.string().c_str());
+            thread_pool pool(1);
+            std::promise<void> release;
+            auto const busy = release.get_future().share();
+            pool.submit([busy] { busy.wait(); });
+            command_preloader preloader(*manager, pool);
+            preloader.start({ version::gtavc_ps2, version::gtavc_pc });
+            auto const set = preloader.get_set(version::gtavc_pc);
+            assert(set && set->get_command(0x0001));
+            assert(! preloader.is_ready());
+            release.set_value();
+            preloader.wait();
+            auto const count = preloader.handle().get();
+            auto const again = preloader.get_set(version::gtavc_pc);
+            assert(2 == count && set == again);
+        }
+        {
+            // nothing started: synchronous loading
+            auto const manager = std::make_unique<command_manager>(root.string().c_str());
+            command_preloader preloader(*manager);
+            auto const set = preloader.get_set(version::gtavc_ps2);
+            assert(set && ! preloader.is_started());
+        }
+        std::filesystem::remove_all(root, error);
+    }
+
+    command_set mismatch(version::gtavc_ps2);
+    auto const mismatch_loaded = mismatch.load_document(gs_document, std::strlen(gs_document), parent);
+    assert(! mismatch_loaded);
     
     return 0;
 }
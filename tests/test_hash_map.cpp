@@ -0,0 +1,138 @@
+# include <core/hash_map.hpp>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <cstdint>
+# include <random>
+# include <string>
+# include <unordered_map>
+
+namespace idascm
+{
+    namespace
+    {
+        // every hash lands on the same home slot, exercises long runs and backward shifts
+        struct colliding_hash
+        {
+            auto operator () (std::uint32_t) const noexcept -> std::size_t
+            {
+                return 0x1234;
+            }
+        };
+
+        template <typename map, typename reference>
+        void check_same(map const & actual, reference const & expected)
+        {
+            assert(actual.size() == expected.size());
+            for (auto const & entry : expected)
+            {
+                auto const value = actual.find(entry.first);
+                assert(value && *value == entry.second);
+            }
+            std::size_t count = 0;
+            for (auto const & entry : actual)
+            {
+                auto const found = expected.find(entry.first);
+                assert(found != expected.end() && found->second == entry.second);
+                ++ count;
+            }
+            assert(count == expected.size());
+        }
+
+        // random insert / overwrite / erase mix against std::unordered_map
+        template <typename map>
+        void check_random(std::uint32_t key_range, std::size_t steps)
+        {
+            map actual;
+            std::unordered_map<std::uint32_t, std::uint32_t> expected;
+            std::mt19937 random(key_range);
+            for (std::size_t i = 0; i < steps; ++ i)
+            {
+                auto const k = static_cast<std::uint32_t>(random() % key_range);
+                switch (random() % 4)
+                {
+                    case 0:
+                    case 1:
+                    {
+                        auto const added = actual.insert(k, static_cast<std::uint32_t>(i));
+                        assert(added == expected.emplace(k, static_cast<std::uint32_t>(i)).second);
+                        break;
+                    }
+                    case 2:
+                        actual[k] = static_cast<std::uint32_t>(i);
+                        expected[k] = static_cast<std::uint32_t>(i);
+                        break;
+                    case 3:
+                    {
+                        auto const erased = actual.erase(k);
+                        assert(erased == (1 == expected.erase(k)));
+                        break;
+                    }
+                }
+                assert(actual.contains(k) == (expected.count(k) == 1));
+            }
+            check_same(actual, expected);
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    // basics
+    {
+        flat_hash_map<std::uint32_t, int> map;
+        auto const erased_missing = map.erase(1);
+        assert(map.empty() && ! map.find(1) && ! erased_missing && 0 == map.capacity());
+        auto const inserted = map.insert(1, 10);
+        assert(inserted);
+        auto const inserted_again = map.insert(1, 11);
+        assert(! inserted_again);
+        assert(10 == *map.find(1));
+        map.insert_or_assign(1, 12);
+        auto const one = map[1];
+        auto const two = map[2];    // inserts
+        assert(12 == one && 0 == two && 2 == map.size());
+        auto const erased = map.erase(1);
+        assert(erased && ! map.contains(1) && map.contains(2));
+        map.clear();
+        assert(map.empty() && ! map.contains(2) && map.capacity());
+        map.reserve(1000);
+        auto const capacity = map.capacity();
+        for (std::uint32_t i = 0; i < 1000; ++ i)
+            map.insert(i, int(i));
+        assert(capacity == map.capacity() && 1000 == map.size());
+    }
+
+    check_random<flat_hash_map<std::uint32_t, std::uint32_t>>(64, 20000);
+    check_random<flat_hash_map<std::uint32_t, std::uint32_t>>(5000, 50000);
+    check_random<flat_hash_map<std::uint32_t, std::uint32_t, colliding_hash>>(200, 5000);
+
+    // non trivial values, copies and moves
+    {
+        flat_hash_map<std::string, std::string> map;
+        std::unordered_map<std::string, std::string> expected;
+        for (int i = 0; i < 500; ++ i)
+        {
+            auto const key = "symbol_" + std::to_string(i);
+            map.emplace(key, std::string(40, char('a' + i % 26)));
+            expected.emplace(key, std::string(40, char('a' + i % 26)));
+        }
+        for (int i = 0; i < 500; i += 3)
+        {
+            map.erase("symbol_" + std::to_string(i));
+            expected.erase("symbol_" + std::to_string(i));
+        }
+        check_same(map, expected);
+        auto copy = map;
+        check_same(copy, expected);
+        auto moved = std::move(copy);
+        check_same(moved, expected);
+        assert(copy.empty());
+        copy = moved;
+        check_same(copy, expected);
+    }
+
+    return 0;
+}
@@ -1,12 +1,158 @@
 # include <core/json.hpp>
+# include <core/json_reader.hpp>
+# include <core/json_structural.hpp>
+# include <core/json_token.hpp>
+# include <core/json_writer.hpp>
+# include <core/memory_report.hpp>
+# include <algorithm>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <cstdint>
+# include <cstdio>
+# include <cstring>
+# include <string>
+# include <thread>
+# include <vector>
 
-namespace
+namespace idascm
 {
-    char const gs_test_json[] = R"(
+    namespace
     {
-        "foo": [ 1, "bar" ],
+        char const gs_test_json[] = R"(
+        {
+            "foo": [ 1, "bar" ],
+        }
+        )";
+
+        // escapes, nesting and trailing commas straddling 64 byte blocks
+        char const gs_test_tricky_json[] = R"(
+        {
+            "escaped \"quote\"": "back\\slash\\",
+            "padding-padding-padding-padding-padding-padding": [ true, false, null, -1.5e3, ],
+            "nested": { "a": [ [ ], { }, [ "x", { "y": 0x10 } ], ], "b": "\\\"", },
+            "brackets in string": "{[:,]}",
+            "unicode": "\u0041",
+            "last": 42
+        }
+        )";
+
+        // jsmn the way json_value runs it: counting pass, then an exactly sized pool
+        auto tokenize_jsmn(std::string const & source, std::vector<jsmntok_t> & tokens) -> int
+        {
+            jsmn_parser parser;
+            jsmn_init(&parser);
+            auto const count = jsmn_parse(&parser, source.data(), source.size(), nullptr, 0);
+            if (count < 0)
+                return count;
+            tokens.assign(std::max(count, 1), jsmntok_t {});
+            jsmn_init(&parser);
+            return jsmn_parse(&parser, source.data(), source.size(), tokens.data(), static_cast<unsigned>(tokens.size()));
+        }
+
+        // the structural index either fails (jsmn takes over) or gives jsmn's tokens exactly,
+        // a whole parse gives jsmn's result and error code whichever tokenizer is set
+        // true if the index tokenized the source itself
+        auto check_tokens(std::string const & source, json_tokenizer tokenizer) -> bool
+        {
+            std::vector<jsmntok_t> expected;
+            auto const expected_count = tokenize_jsmn(source, expected);
+
+            bool structural = false;
+            json_structural_index index;
+            auto const count = index.build(source.data(), source.size(), tokenizer);
+            if (count >= 0)
+            {
+                std::vector<jsmntok_t> tokens(std::max(count, 1));
+                auto const result = index.tokenize(tokens.data(), tokens.size());
+                if (result >= 0)
+                {
+                    assert(result == expected_count && count == expected_count);
+                    for (int i = 0; i < result; ++ i)
+                    {
+                        assert(tokens[i].type == expected[i].type);
+                        assert(tokens[i].start == expected[i].start && tokens[i].end == expected[i].end);
+                        assert(tokens[i].size == expected[i].size && tokens[i].parent == expected[i].parent);
+                    }
+                    structural = true;
+                }
+            }
+
+            int expected_error = 1;
+            int error = 1;
+            json_set_tokenizer(json_tokenizer::jsmn);
+            auto const reference = json_value::from_string(source.data(), source.size(), &expected_error);
+            json_set_tokenizer(tokenizer);
+            auto const value = json_value::from_string(source.data(), source.size(), &error);
+            json_set_tokenizer(json_tokenizer::structural);
+            assert(expected_error == error && reference.is_valid() == value.is_valid());
+            // the index gives up on input jsmn accepts only when it does not model it
+            assert(structural || expected_count < 0 || json_structural_unsupported == count);
+            return structural;
+        }
+
+        // structural hash of a whole tree, touches every accessor
+        auto checksum(json_value const & value) -> std::size_t
+        {
+            switch (value.type())
+            {
+                case json_type::primitive:
+                    return std::hash<std::string_view>()(value.to_primitive().to_string());
+                case json_type::array:
+                {
+                    auto const array = value.to_array();
+                    std::size_t hash = 0xa;
+                    for (std::size_t i = 0; i < array.size(); ++ i)
+                        hash = hash * 31 + checksum(array[i]);
+                    return hash;
+                }
+                case json_type::object:
+                {
+                    auto const object = value.to_object();
+                    std::size_t hash = 0xb;
+                    for (std::size_t i = 0; i < object.size(); ++ i)
+                        hash = hash * 31 + checksum(object.key_at(i)) * 7 + checksum(object.at(i));
+                    return hash;
+                }
+                default:
+                    return 0;
+            }
+        }
+
+        // flattens reader events into a string, stops after 'limit' events
+        class json_event_log final : public json_handler
+        {
+            public:
+                auto start_object(void) -> bool override { return event("{"); }
+                auto end_object(void) -> bool override { return event("}"); }
+                auto start_array(void) -> bool override { return event("["); }
+                auto end_array(void) -> bool override { return event("]"); }
+                auto key(std::string_view key) -> bool override { return event("k(", key); }
+                auto value_string(std::string_view string) -> bool override { return event("s(", string); }
+                auto value_primitive(std::string_view text) -> bool override { return event("p(", text); }
+
+            public:
+                explicit json_event_log(std::size_t limit = SIZE_MAX)
+                    : limit(limit)
+                {}
+
+            public:
+                std::string log;
+                std::size_t limit;
+
+            private:
+                auto event(char const * tag, std::string_view text = {}) -> bool
+                {
+                    log += tag;
+                    if ('(' == log.back())
+                    {
+                        log.append(text.data(), text.size());
+                        log += ')';
+                    }
+                    return -- limit != 0;
+                }
+        };
     }
-    )";
 }
 
 int main(int argc, char * argv[])
@@ -21,7 +167,246 @@ int main(int argc, char * argv[])
    
     auto foo    = root["foo"].to_array();
     auto first  = foo.at(0).to_primitive();
+    assert(foo.size() == 2);
+    assert(first.to_string() == "1");
+
+    int error = -1;
+    auto doubling = json_value::from_string(gs_test_json, std::strlen(gs_test_json), &error, json_sizing::doubling);
+    assert(0 == error);
+    assert(doubling.to_object()["foo"].to_array()[1].to_primitive().to_string() == "bar");
+
+    // file mapped document
+    char const * const path = "test_json.tmp";
+    if (auto file = std::fopen(path, "wb"))
+    {
+        std::fwrite(gs_test_json, 1, std::strlen(gs_test_json), file);
+        std::fclose(file);
+        auto mapped = json_value::from_file(path, &error);
+        assert(0 == error);
+        assert(mapped.to_object()["foo"].to_array()[1].to_primitive().to_string() == "bar");
+        std::remove(path);
+    }
+
+    // every tokenizer against jsmn token for token: documents, their truncations,
+    // inputs jsmn reads differently from JSON and seeded random bytes
+    {
+        json_tokenizer const tokenizers[] = \
+        {
+            json_tokenizer::structural,
+            json_tokenizer::structural_scalar,
+            json_tokenizer::structural_sse2,
+            json_tokenizer::structural_avx2,
+        };
+        std::string const malformed[] = \
+        {
+            "",
+            "abc\"x\"",
+            "[ abc\"x y\" ]",
+            "[ ab{ 1 } ]",
+            "[ ab[ 1 ] ]",
+            "{ \"a\": \"\\q\" }",
+            "[ \"\\u12\" ]",
+            "[ \"\\u00zz\" ]",
+            "[ \"\\u0041\\/\\b\\f\\n\\r\\t\" ]",
+            "[ \\\"x\" ]",
+            "[ a\\b ]",
+            std::string("[ 1, \0 2 ]", 10),
+            std::string("[ \"a\0b\" ]", 10),
+            std::string("[ 12\0", 6),
+            "{ \"a\": 1 ]",
+            "[ 1, 2 } ",
+            "]",
+            "[ \"unterminated ]",
+            "[ \"a\\",
+            "{ \"a\" \"b\" : }",
+            "[ \x01 ]",
+            "[ \x7f, \xc3\xa9 ]",
+            "[ \"\xc3\xa9\" ]",
+            "a:b:c",
+        };
+        std::size_t handled = 0;
+        for (auto const tokenizer : tokenizers)
+        {
+            for (auto const source : { gs_test_json, gs_test_tricky_json })
+            {
+                std::string const text(source);
+                auto const structural = check_tokens(text, tokenizer);
+                assert(structural);
+                for (std::size_t length = 0; length < text.size(); ++ length)
+                    check_tokens(text.substr(0, length), tokenizer);
+            }
+            for (auto const & source : malformed)
+                check_tokens(source, tokenizer);
+            char const alphabet[] = "{}[]\":, \t\nabfnrtu01F\\\0\x80";
+            std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+            for (int i = 0; i < 3000; ++ i)
+            {
+                std::string source;
+                seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+                auto const length = (seed >> 33) % 160;
+                for (std::size_t j = 0; j < length; ++ j)
+                {
+                    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+                    source += alphabet[(seed >> 33) % (sizeof(alphabet) - 1)];
+                }
+                handled += check_tokens(source, tokenizer);
+            }
+        }
+        assert(handled > 0);
+    }
+    json_set_tokenizer(json_tokenizer::structural);
+    assert(! json_value::from_string("{ \"unterminated: 1 }").is_valid());
+    assert(! json_value::from_string("[ 1, 2 ").is_valid());
+
+    // typed accessors
+    auto const numbers = json_value::from_string(R"([ 42, "0x004f", -0x10, -9223372036854775808, 18446744073709551615, 1.5e3, "-0x1p4", true, false, "4x" ])").to_array();
+    std::int64_t  i64 = 0;
+    std::uint64_t u64 = 0;
+    double        f64 = 0.;
+    bool          b   = false;
+    bool ok = numbers[0].to_primitive().to_int64(i64);
+    assert(ok && i64 == 42);
+    ok = numbers[1].to_primitive().to_uint64(u64);
+    assert(ok && u64 == 0x4f);
+    ok = numbers[2].to_primitive().to_int64(i64);
+    assert(ok && i64 == -16);
+    ok = numbers[2].to_primitive().to_uint64(u64);
+    assert(! ok);
+    ok = numbers[3].to_primitive().to_int64(i64);
+    assert(ok && i64 == INT64_MIN);
+    ok = numbers[4].to_primitive().to_uint64(u64);
+    assert(ok && u64 == UINT64_MAX);
+    ok = numbers[4].to_primitive().to_int64(i64);
+    assert(! ok);
+    ok = numbers[5].to_primitive().to_double(f64);
+    assert(ok && f64 == 1500.);
+    ok = numbers[6].to_primitive().to_double(f64);
+    assert(ok && f64 == -16.);
+    ok = numbers[7].to_primitive().to_bool(b);
+    assert(ok && b);
+    ok = numbers[8].to_primitive().to_bool(b);
+    assert(ok && ! b);
+    ok = numbers[9].to_primitive().to_uint64(u64);
+    assert(! ok);
+    ok = numbers[0].to_primitive().to_bool(b);
+    assert(! ok);
+
+    // writer output reads back
+    for (unsigned const indent : { 0u, 4u })
+    {
+        json_writer writer(indent);
+        writer.begin_object();
+        writer.key("name");
+        writer.value_string("quote \" backslash \\ tab \t bell \x07 \xc3\xa9");
+        writer.key("values");
+        writer.begin_array();
+        writer.value_int64(-42);
+        writer.value_uint64(UINT64_MAX);
+        writer.value_double(0.1);
+        writer.value_bool(true);
+        writer.value_null();
+        writer.begin_object();
+        writer.end_object();
+        writer.end_array();
+        writer.end_object();
+
+        auto const text = writer.buffer();
+        auto const root = json_value::from_string(text.data(), text.size()).to_object();
+        assert(root["name"].to_primitive().to_string() == "quote \" backslash \\ tab \t bell \x07 \xc3\xa9");
+        auto const values = root["values"].to_array();
+        assert(values.size() == 6);
+        bool ok = values[0].to_primitive().to_int64(i64);
+        assert(ok && i64 == -42);
+        ok = values[1].to_primitive().to_uint64(u64);
+        assert(ok && u64 == UINT64_MAX);
+        ok = values[2].to_primitive().to_double(f64);
+        assert(ok && f64 == 0.1);
+        ok = values[3].to_primitive().to_bool(b);
+        assert(ok && b);
+        assert(values[5].type() == json_type::object && values[5].to_object().size() == 0);
+    }
+    assert(json_value::from_string(R"(["\u00e9\ud83d\ude00\/"])").to_array()[0].to_primitive().to_string() == "\xc3\xa9\xf0\x9f\x98\x80/");
+
+    // one document read and shared from many threads, the last reference drops on a worker
+    {
+        auto document = json_value::from_string(gs_test_tricky_json);
+        auto const expected = checksum(document);
+        std::vector<std::thread> workers;
+        std::vector<int> results(8, 0);
+        for (std::size_t t = 0; t < results.size(); ++ t)
+        {
+            workers.emplace_back([root = document, &result = results[t], expected]
+            {
+                int good = 1;
+                for (int i = 0; i < 2000; ++ i)
+                {
+                    json_value copy = root;
+                    auto const nested = copy.to_object()["nested"];
+                    json_value moved = static_cast<json_value &&>(copy);
+                    good &= checksum(moved) == expected;
+                    good &= nested.to_object()["a"].to_array().size() == 3;
+                }
+                result = good;
+            });
+        }
+        document = json_value();
+        for (auto & worker : workers)
+            worker.join();
+        for (auto const result : results)
+            assert(result);
+    }
+
+    // event reader
+    {
+        json_reader reader;
+        json_event_log events;
+        auto result = reader.read(gs_test_tricky_json, std::strlen(gs_test_tricky_json), events);
+        assert(json_read_ok == result);
+        assert(events.log ==
+            "{k(escaped \"quote\")s(back\\slash\\)"
+            "k(padding-padding-padding-padding-padding-padding)[p(true)p(false)p(null)p(-1.5e3)]"
+            "k(nested){k(a)[[]{}[s(x){k(y)p(0x10)}]]k(b)s(\\\")}"
+            "k(brackets in string)s({[:,]})k(unicode)s(A)k(last)p(42)}");
+
+        json_event_log limited(3);
+        result = reader.read(gs_test_json, std::strlen(gs_test_json), limited);
+        assert(json_read_aborted == result);
+        assert(limited.log == "{k(foo)[");
 
+        json_event_log ignored;
+        auto const read = [&](char const * source)
+        {
+            return reader.read(source, std::strlen(source), ignored);
+        };
+        result = read("{ \"a\": [ 1 ");
+        assert(json_read_partial == result);
+        result = read("[ \"abc");
+        assert(json_read_partial == result);
+        result = read("{ \"a\": 1 ]");
+        assert(json_read_invalid == result);
+        result = read("[ \"\\q\" ]");
+        assert(json_read_invalid == result);
+        result = read("{ { } }");
+        assert(json_read_invalid == result);
+    }
+
+    // memory report covers the token pool and the source copy
+    {
+        auto const value = json_value::from_string(gs_test_json);
+        auto const report = value.memory_usage();
+        assert(std::strlen(gs_test_json) + 1 == report.get("source"));
+        assert(report.get("tokens") > 0 && 0 == report.get("mapping"));
+        assert(report.total() >= report.get("tokens") + report.get("source"));
+        // every value of a document reports the same document
+        assert(value.to_object().at(std::size_t(0)).memory_usage().total() == report.total());
+        assert(0 == json_value().memory_usage().total());
+        std::string text;
+        report.write_text(text);
+        assert(std::string::npos != text.find("tokens") && std::string::npos != text.find("total"));
+        std::string json;
+        report.write_json(json);
+        assert(report.total() == std::size_t(std::strtoull(json_value::from_string(json.c_str()).to_object()["total"].to_primitive().c_str(), nullptr, 10)));
+    }
 
     return 0;
 }
@@ -0,0 +1,111 @@
+# include <engine/command_set.hpp>
+# include <engine/listing.hpp>
+# include <engine/script_generator.hpp>
+# include <engine/gta3/decoder_gta3.hpp>
+# include <engine/gtalcs/decoder_gtalcs.hpp>
+# include <engine/gtavc/decoder_gtavc.hpp>
+# include <core/thread_pool.hpp>
+# include <tests/generated_isa.hpp>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <cstdio>
+# include <cstring>
+# include <string>
+
+namespace idascm
+{
+    namespace
+    {
+        auto run(listing & text, thread_pool & pool) -> std::string
+        {
+            auto const file = std::tmpfile();
+            assert(file);
+            text.analyze(pool);
+            auto const written = text.write(pool, file);
+            assert(written);
+            std::string result(static_cast<std::size_t>(std::ftell(file)), '\0');
+            std::rewind(file);
+            auto const read = std::fread(&result[0], 1, result.size(), file);
+            assert(read == result.size());
+            std::fclose(file);
+            return result;
+        }
+
+        // the listing of one thread and one chunk is the reference: more threads and chunks
+        // small enough to start mid instruction give the same text
+        template <typename decoder_type>
+        void check_listing(command_set const & isa, game game, thread_pool & serial, thread_pool & parallel)
+        {
+            script_generator_options options;
+            options.seed            = 11;
+            options.size            = 48 * 1024;
+            options.mission_count   = 2;
+            options.mission_size    = 8 * 1024;
+            generated_script script;
+            auto const generated = generate_script(isa, game, options, script);
+            assert(generated && script.sections.size() == 3);
+            // bytes nothing decodes at
+            script.code.insert(script.code.end(), { 0xff, 0xff, 0x01 });
+
+            memory_api_buffer memory(script.code.data(), script.code.size());
+            decoder_type dec;
+            dec.set_command_set(&isa);
+            dec.set_memory_api(&memory);
+            auto const size = static_cast<std::uint32_t>(script.code.size());
+
+            listing reference(dec, isa, script.code.data(), size);
+            auto const expected = run(reference, serial);
+            assert(0 == reference.resweep_count());
+            assert(expected.find("db      0xFF\n") != std::string::npos);
+
+            for (std::uint32_t chunk_size : { 64u, 100u, 4096u, static_cast<std::uint32_t>(listing::default_chunk_size) })
+            {
+                listing text(dec, isa, script.code.data(), size, chunk_size);
+                auto const parallel_text = run(text, parallel);
+                assert(expected == parallel_text);
+                // some chunk start fell inside an instruction and its speculative sweep was out of phase
+                if (64 == chunk_size)
+                    assert(text.resweep_count() > 0);
+                listing again(dec, isa, script.code.data(), size, chunk_size);
+                auto const serial_text = run(again, serial);
+                assert(expected == serial_text);
+            }
+
+            // main only refers to main, mission jumps are relative: no label past main,
+            // and every label line is followed by its instruction
+            auto const missions = script.sections[1].offset;
+            std::size_t labels = 0;
+            for (std::size_t line = 0; line < expected.size(); line = expected.find('\n', line) + 1)
+            {
+                if (0 != expected.compare(line, 4, "loc_"))
+                    continue;
+                auto const address = std::strtoul(expected.c_str() + line + 4, nullptr, 16);
+                auto const next = expected.find('\n', line) + 1;
+                assert(address < missions && address == std::strtoul(expected.c_str() + next, nullptr, 16));
+                ++ labels;
+            }
+            assert(labels > 0);
+            char mission[16];
+            std::snprintf(mission, sizeof(mission), "%08X", static_cast<unsigned>(missions));
+            auto const tail = expected.substr(expected.find(mission));
+            assert(tail.find("loc_") == std::string::npos && tail.find("GOTO    -") != std::string::npos);
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    command_set isa(version::gtavc_pc);
+    version parent = version::unknown;
+    auto const loaded = isa.load_document(g_generated_isa, std::strlen(g_generated_isa), parent);
+    assert(loaded);
+    thread_pool serial(1);
+    thread_pool parallel(4);
+    check_listing<decoder_gta3>(isa, game::gta3, serial, parallel);
+    check_listing<decoder_gtavc>(isa, game::gtavc, serial, parallel);
+    check_listing<decoder_gtalcs>(isa, game::gtalcs, serial, parallel);
+    return 0;
+}
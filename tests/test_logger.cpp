@@ -0,0 +1,270 @@
+# include <core/logger.hpp>
+# include <core/logger_trace.hpp>
+# include <atomic>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <chrono>
+# include <cstdio>
+# include <string>
+# include <thread>
+# include <vector>
+
+namespace idascm
+{
+    namespace
+    {
+        std::size_t const gs_thread_count   = 4;
+        std::size_t const gs_message_count  = 20000;
+
+        // checks per-producer ordering, runs on the logger thread only
+        class recording_handler : public logger::handler
+        {
+            public:
+                virtual void message(logger::context const &, char const * message) override
+                {
+                    last = message;
+                    unsigned thread = 0;
+                    unsigned index  = 0;
+                    if (2 != std::sscanf(message, "t%u i%u", &thread, &index) || thread >= gs_thread_count)
+                        return;
+                    if (index < next[thread])
+                        ordered = false;
+                    next[thread] = index + 1;
+                    ++ count;
+                    if (slow)
+                        std::this_thread::sleep_for(std::chrono::microseconds(20));
+                }
+
+            public:
+                std::size_t count               = 0;
+                unsigned    next[gs_thread_count] = {};
+                bool        ordered             = true;
+                bool        slow                = false;
+                std::string last;
+        };
+
+        void produce(void)
+        {
+            std::vector<std::thread> producers;
+            for (unsigned t = 0; t < gs_thread_count; ++ t)
+            {
+                producers.emplace_back([t]
+                {
+                    for (unsigned i = 0; i < gs_message_count; ++ i)
+                        IDASCM_LOG_W("t%u i%u", t, i);
+                });
+            }
+            for (auto & producer : producers)
+                producer.join();
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    // every produced message must arrive
+    auto & log = logger::instance();
+    log.set_rate_limit(0);
+
+    // blocking: nothing is lost, each producer's messages arrive in order
+    {
+        recording_handler handler;
+        log.add_handler(&handler);
+        auto const started = log.start_async(64, logger::overflow::block);
+        auto const restarted = log.start_async();
+        assert(started && ! restarted);
+        produce();
+        log.flush();
+        assert(handler.count == gs_thread_count * gs_message_count);
+        assert(handler.ordered);
+        assert(0 == log.dropped_count());
+        log.stop_async();
+        log.remove_handler(&handler);
+    }
+
+    // dropping: a slow handler loses messages, but every one is either delivered or counted
+    {
+        recording_handler handler;
+        handler.slow = true;
+        log.add_handler(&handler);
+        auto const started = log.start_async(16, logger::overflow::drop);
+        assert(started);
+        produce();
+        log.flush();
+        auto const dropped = log.dropped_count();
+        assert(dropped > 0);
+        assert(handler.count + dropped == gs_thread_count * gs_message_count);
+        assert(handler.ordered);
+        log.remove_handler(&handler);
+        log.stop_async();
+    }
+
+    // starting and stopping while producers log: nothing hangs or gets lost on the way
+    {
+        recording_handler handler;
+        log.add_handler(&handler);
+        std::atomic<bool> producing(true);
+        std::thread control([&]
+        {
+            while (producing.load())
+            {
+                log.start_async(16, logger::overflow::block);
+                std::this_thread::yield();
+                log.stop_async();
+            }
+        });
+        produce();
+        producing.store(false);
+        control.join();
+        assert(handler.count == gs_thread_count * gs_message_count);
+        log.remove_handler(&handler);
+    }
+
+    // synchronous again
+    {
+        recording_handler handler;
+        log.add_handler(&handler);
+        IDASCM_LOG_W("t%u i%u", 0u, 0u);
+        assert(1 == handler.count);
+        log.remove_handler(&handler);
+    }
+
+    // per-subsystem levels, debug builds start at level::debug
+    {
+        log.set_level(logger::level::info);
+        recording_handler handler;
+        log.add_handler(&handler);
+        log.set_level(logger::subsystem::general, logger::level::error);
+        IDASCM_LOG_W("t%u i%u", 0u, 1u);
+        assert(0 == handler.count);
+        assert(logger::level::error == log.current_level(logger::subsystem::general));
+        assert(logger::level::info == log.current_level(logger::subsystem::decoder));
+        log.set_level(logger::level::info);
+        IDASCM_LOG_W("t%u i%u", 0u, 2u);
+        assert(1 == handler.count);
+        log.remove_handler(&handler);
+    }
+
+    // rate limiting per call site, the rest is summarized
+    {
+        recording_handler handler;
+        log.add_handler(&handler);
+        log.set_rate_limit(5, 60000, 60000);
+        for (unsigned i = 0; i < 100; ++ i)
+            IDASCM_LOG_W("t%u i%u", 0u, i);
+        IDASCM_LOG_W("t%u i%u", 1u, 0u);
+        assert(6 == handler.count);
+        log.flush_suppressed();
+        assert(handler.last == "95 similar messages suppressed\n");
+        handler.last.clear();
+        log.flush_suppressed();
+        assert(handler.last.empty());
+        log.set_rate_limit(0);
+
+        // a long multi-line text (the profiler summary) is one message, whole
+        std::string table;
+        for (int i = 0; i < 100; ++ i)
+            table += "zone                                     1234     12.345\n";
+        IDASCM_LOG_W("%s", table.c_str());
+        assert(handler.last == table);
+        log.remove_handler(&handler);
+    }
+
+    // binary trace renders to the same text printf would have produced
+    {
+        char const * const path = "test_logger.trace";
+        recording_handler handler;
+        log.add_handler(&handler);
+        auto const started = log.start_trace(path);
+        assert(started);
+        char const unterminated[] = { 'a', 'b', 'c', 'd' };
+        for (int i = 0; i < 3; ++ i)
+        {
+            IDASCM_LOG_W("int %d uint %u hex 0x%04x real %g str '%s' chars '%.*s' char %c %%", -i, 7u * i, 0xbeef, 1.5 * i, "text", 3, unterminated, 'x');
+            IDASCM_LOG_E("%-6s|%8.3f|%*d|%lld", "ab", 3.14159, 5, 42, -1234567890123ll);
+        }
+        log.stop_trace();
+        assert(0 == handler.count);
+        log.remove_handler(&handler);
+
+        log_trace_file trace;
+        auto const loaded = trace.load(path);
+        assert(loaded);
+        assert(2 == trace.sites().size());
+        assert(6 == trace.messages().size());
+        for (std::size_t i = 0; i < trace.messages().size(); ++ i)
+        {
+            auto const & message = trace.messages()[i];
+            auto const site = trace.find_site(message.site);
+            assert(site);
+            char expected[256];
+            if (0 == i % 2)
+                std::snprintf(expected, sizeof(expected), "int %d uint %u hex 0x%04x real %g str '%s' chars '%.*s' char %c %%", -int(i / 2), 7u * unsigned(i / 2), 0xbeef, 1.5 * int(i / 2), "text", 3, unterminated, 'x');
+            else
+                std::snprintf(expected, sizeof(expected), "%-6s|%8.3f|%*d|%lld", "ab", 3.14159, 5, 42, -1234567890123ll);
+            std::string text;
+            auto const rendered = log_format_render(site->format.c_str(), message.arguments.data(), message.arguments.size(), text);
+            assert(rendered && text == expected);
+            text.clear();
+            auto const line = trace.render(message, text);
+            assert(line && text.find(expected) != std::string::npos && text.back() == '\n');
+        }
+        std::remove(path);
+    }
+
+    // threads trace into their own stages: every record arrives, in time order and
+    // in order per thread
+    {
+        char const * const path = "test_logger_threads.trace";
+        auto const started = log.start_trace(path);
+        assert(started);
+        produce();
+        log.stop_trace();
+
+        log_trace_file trace;
+        auto const loaded = trace.load(path);
+        assert(loaded && 1 == trace.sites().size());
+        assert(gs_thread_count * gs_message_count == trace.messages().size());
+        std::uint64_t time = 0;
+        std::vector<std::uint64_t> next;
+        for (auto const & message : trace.messages())
+        {
+            assert(message.time >= time && 2 == message.arguments.size());
+            time = message.time;
+            auto const thread = message.arguments[0].u;
+            auto const index  = message.arguments[1].u;
+            if (thread >= next.size())
+                next.resize(thread + 1);
+            assert(index == next[thread]);
+            next[thread] = index + 1;
+        }
+        std::remove(path);
+    }
+
+    // stopping a trace while other threads write to it
+    {
+        char const * const path = "test_logger_stop.trace";
+        recording_handler handler;
+        log.add_handler(&handler);
+        std::atomic<bool> producing(true);
+        std::thread control([&]
+        {
+            while (producing.load())
+            {
+                log.start_trace(path);
+                std::this_thread::yield();
+                log.stop_trace();
+            }
+        });
+        produce();
+        producing.store(false);
+        control.join();
+        log.remove_handler(&handler);
+        std::remove(path);
+    }
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+# include <core/profiler.hpp>
+# include <core/json.hpp>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <cstring>
+# include <set>
+# include <string>
+# include <thread>
+# include <vector>
+
+namespace idascm
+{
+    namespace
+    {
+        void leaf(void)
+        {
+            IDASCM_PROFILE_ZONE("leaf");
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        void outer(void)
+        {
+            IDASCM_PROFILE_ZONE("outer");
+            leaf();
+            leaf();
+        }
+
+        auto find(std::vector<profiler::statistics> const & stats, char const * name) -> profiler::statistics const *
+        {
+            for (auto const & zone : stats)
+                if (0 == std::strcmp(zone.name, name))
+                    return &zone;
+            return nullptr;
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+    auto & profiler = profiler::instance();
+
+    // nothing is recorded while stopped
+    {
+        profiler.reset();
+        outer();
+        assert(profiler.events().empty());
+    }
+
+    // nesting: children start inside their parent and are one level deeper
+    {
+        profiler.reset();
+        profiler.start();
+        outer();
+        profiler.stop();
+        auto const events = profiler.events();
+        assert(3 == events.size());
+        assert(0 == std::strcmp("outer", events[0].zone->name));
+        assert(0 == events[0].depth);
+        for (std::size_t i = 1; i < 3; ++ i)
+        {
+            assert(0 == std::strcmp("leaf", events[i].zone->name));
+            assert(1 == events[i].depth);
+            assert(events[i].thread == events[0].thread);
+            assert(events[i].start >= events[0].start);
+            assert(events[i].start + events[i].duration <= events[0].start + events[0].duration);
+        }
+        assert(events[1].start + events[1].duration <= events[2].start);
+    }
+
+    // statistics
+    {
+        profiler.reset();
+        profiler.start();
+        for (int i = 0; i < 10; ++ i)
+            outer();
+        profiler.stop();
+        auto const stats = profiler.summarize();
+        assert(2 == stats.size());
+        // outer contains both leaves, so it comes first
+        assert(0 == std::strcmp("outer", stats[0].name));
+        auto const leaves = find(stats, "leaf");
+        assert(leaves && 20 == leaves->count);
+        assert(leaves->min >= 50000);
+        assert(leaves->min <= leaves->p50 && leaves->p50 <= leaves->p90);
+        assert(leaves->p90 <= leaves->p99 && leaves->p99 <= leaves->max);
+        assert(leaves->total >= leaves->max + leaves->min);
+        std::string summary;
+        profiler.write_summary(summary);
+        assert(std::string::npos != summary.find("outer"));
+        assert(std::string::npos != summary.find("leaf"));
+    }
+
+    // every thread gets its own id, threads stay registered after they exit
+    {
+        profiler.reset();
+        profiler.start();
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++ i)
+        {
+            threads.emplace_back([]
+            {
+                for (int j = 0; j < 5000; ++ j)
+                {
+                    IDASCM_PROFILE_ZONE("worker");
+                }
+            });
+        }
+        for (auto & thread : threads)
+            thread.join();
+        profiler.stop();
+        auto const events = profiler.events();
+        assert(20000 == events.size());
+        std::set<std::uint32_t> ids;
+        for (auto const & event : events)
+            ids.insert(event.thread);
+        assert(4 == ids.size());
+    }
+
+    // chrome trace
+    {
+        profiler.reset();
+        profiler.start();
+        outer();
+        profiler.stop();
+        std::string trace;
+        profiler.write_chrome_trace(trace);
+        auto const root = json_value::from_string(trace.c_str(), trace.size()).to_object();
+        assert(root.is_valid());
+        auto const events = root["traceEvents"].to_array();
+        assert(events.is_valid());
+        std::size_t complete = 0;
+        std::size_t metadata = 0;
+        for (std::size_t i = 0; i < events.size(); ++ i)
+        {
+            auto const event = events[i].to_object();
+            auto const ph = event["ph"].to_primitive();
+            if (0 == std::strcmp("X", ph.c_str()))
+            {
+                ++ complete;
+                assert(event.contains("ts") && event.contains("dur") && event.contains("tid"));
+            }
+            else if (0 == std::strcmp("M", ph.c_str()))
+            {
+                ++ metadata;
+            }
+        }
+        assert(3 == complete);
+        assert(1 == metadata);
+        profiler.reset();
+        assert(profiler.events().empty());
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+# include <core/string_table.hpp>
+# include <core/memory_report.hpp>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <cstdio>
+# include <string>
+# include <thread>
+# include <vector>
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    // identity, ids and lookups
+    {
+        string_table table;
+        auto const empty = table.intern("");
+        assert(empty.empty() && 0 == empty.id() && empty == interned_string());
+        assert(0 == std::string(empty.c_str()).size());
+
+        std::string const text = "START_NEW_SCRIPT";
+        auto const first = table.intern(text);
+        auto const second = table.intern(std::string(text));
+        assert(first == second && first.c_str() == second.c_str());
+        assert(1 == first.id() && first.view() == text && first == "START_NEW_SCRIPT");
+        assert('\0' == first.c_str()[first.size()]);
+
+        auto const other = table.intern("WAIT");
+        assert(other != first && 2 == other.id());
+        assert(table.get(2) == other && table.get(0).empty() && table.get(3).empty());
+        assert(table.find("WAIT") == other && table.find("NOPE").empty());
+        assert(2 == table.size());
+    }
+
+    // chunk boundaries
+    {
+        string_table table;
+        std::vector<interned_string> strings;
+        char buffer[32];
+        for (int i = 0; i < 10000; ++ i)
+        {
+            std::snprintf(buffer, sizeof(buffer), "S%d", i);
+            strings.push_back(table.intern(buffer));
+        }
+        for (int i = 0; i < 10000; ++ i)
+        {
+            std::snprintf(buffer, sizeof(buffer), "S%d", i);
+            assert(table.get(strings[i].id()) == strings[i]);
+            auto const again = table.intern(buffer);
+            assert(again == strings[i]);
+        }
+        assert(10000 == table.size());
+    }
+
+    // concurrent interning of overlapping sets
+    {
+        string_table table;
+        std::size_t const thread_count = 8;
+        std::vector<std::vector<interned_string>> results(thread_count);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < thread_count; ++ t)
+        {
+            threads.emplace_back([&table, &results, t]
+            {
+                char buffer[32];
+                for (int i = 0; i < 2000; ++ i)
+                {
+                    std::snprintf(buffer, sizeof(buffer), "COMMAND_%d", (i * 7 + int(t)) % 2000);
+                    results[t].push_back(table.intern(buffer));
+                    assert(table.get(results[t].back().id()) == results[t].back());
+                }
+            });
+        }
+        for (auto & thread : threads)
+            thread.join();
+        assert(2000 == table.size());
+        for (std::size_t t = 0; t < thread_count; ++ t)
+            for (auto const & string : results[t])
+                assert(table.find(string.view()) == string);
+        auto const report = table.memory_usage();
+        assert(report.get("arena") >= 2000 * sizeof("COMMAND_0") && report.get("index") >= 2000 * sizeof(void *));
+    }
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+# include <core/thread_pool.hpp>
+// checks stay on in Release builds
+# undef NDEBUG
+# include <cassert>
+# include <cmath>
+# include <cstdlib>
+# include <stdexcept>
+# include <string>
+# include <vector>
+
+namespace idascm
+{
+    namespace
+    {
+        // every index visited exactly once, chunks never exceed the grain
+        void check_coverage(thread_pool & pool, std::size_t count, std::size_t grain)
+        {
+            std::vector<std::atomic<int>> visits(count);
+            std::atomic<bool> bounded(true);
+            parallel_for(pool, 0, count, grain, [&](std::size_t begin, std::size_t end)
+            {
+                if (end <= begin || end - begin > std::max<std::size_t>(grain, 1))
+                    bounded = false;
+                for (auto i = begin; i < end; ++ i)
+                    visits[i].fetch_add(1, std::memory_order_relaxed);
+            });
+            assert(bounded);
+            for (auto const & visit : visits)
+                assert(1 == visit.load());
+        }
+
+        // terms of very different magnitude, so the sum depends on the addition order
+        auto sum(thread_pool & pool, std::size_t count, std::size_t grain) -> double
+        {
+            return parallel_reduce(pool, 0, count, grain, 0.0,
+                [](std::size_t begin, std::size_t end)
+                {
+                    double value = 0.0;
+                    for (auto i = begin; i < end; ++ i)
+                        value += (i % 2 ? 1e16 : 1.0) / double(i + 1);
+                    return value;
+                },
+                [](double lhs, double rhs)
+                {
+                    return lhs + rhs;
+                }
+            );
+        }
+
+        // recursive split through nested groups
+        auto fibonacci(thread_pool & pool, unsigned n) -> unsigned
+        {
+            if (n < 2)
+                return n;
+            unsigned a = 0;
+            unsigned b = 0;
+            task_group group(pool);
+            group.run([&] { a = fibonacci(pool, n - 1); });
+            b = fibonacci(pool, n - 2);
+            group.wait();
+            return a + b;
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    assert(thread_pool::default_thread_count() >= 1);
+
+    thread_pool single(1);
+    thread_pool multiple(4);
+    assert(1 == single.thread_count());
+    assert(4 == multiple.thread_count());
+
+    for (auto pool : { &single, &multiple })
+    {
+        check_coverage(*pool, 0, 16);
+        check_coverage(*pool, 1, 16);
+        check_coverage(*pool, 1000, 0);
+        check_coverage(*pool, 1000, 1);
+        check_coverage(*pool, 1000, 7);
+        check_coverage(*pool, 100000, 1024);
+        check_coverage(*pool, 100, 1000);
+        auto const fib = fibonacci(*pool, 20);
+        assert(6765 == fib);
+    }
+
+    // same grain, same bits, whatever the thread count
+    {
+        auto const expected = sum(single, 1000000, 4096);
+        for (int i = 0; i < 10; ++ i)
+        {
+            auto const parallel = sum(multiple, 1000000, 4096);
+            assert(expected == parallel);
+        }
+        auto const tiny = sum(multiple, 10, 0) - sum(single, 10, 0);
+        assert(0.0 == tiny);
+        auto const empty = parallel_reduce(multiple, 5, 5, 1, 5.0, [](std::size_t, std::size_t) { return 0.0; }, [](double a, double b) { return a + b; });
+        assert(5.0 == empty);
+    }
+
+    // ordered reduction of non commutative values
+    {
+        auto const text = parallel_reduce(multiple, 0, 26, 3, std::string(),
+            [](std::size_t begin, std::size_t end)
+            {
+                std::string part;
+                for (auto i = begin; i < end; ++ i)
+                    part += char('a' + i);
+                return part;
+            },
+            [](std::string lhs, std::string rhs)
+            {
+                return lhs + rhs;
+            }
+        );
+        assert("abcdefghijklmnopqrstuvwxyz" == text);
+    }
+
+    // first exception reaches wait(), the other tasks still run
+    {
+        std::atomic<int> done(0);
+        task_group group(multiple);
+        for (int i = 0; i < 64; ++ i)
+        {
+            group.run([&done, i]
+            {
+                done.fetch_add(1);
+                if (7 == i)
+                    throw std::runtime_error("task");
+            });
+        }
+        bool thrown = false;
+        try
+        {
+            group.wait();
+        }
+        catch (std::runtime_error const &)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(64 == done.load());
+        group.wait();
+    }
+
+    // short-lived groups, a group must not be touched by its last task once a waiter can see it done
+    {
+        std::atomic<int> done(0);
+        for (int i = 0; i < 20000; ++ i)
+        {
+            task_group group(multiple);
+            group.run([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            if (i % 2)
+                group.wait();
+        }
+        assert(20000 == done.load());
+        parallel_for(multiple, 0, 2000, 1, [&](std::size_t, std::size_t)
+        {
+            task_group group(multiple);
+            for (int i = 0; i < 4; ++ i)
+                group.run([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+        });
+        assert(28000 == done.load());
+    }
+
+    // queued work finishes before the pool goes away
+    {
+        std::atomic<int> done(0);
+        {
+            thread_pool pool(2);
+            for (int i = 0; i < 1000; ++ i)
+                pool.submit([&done] { done.fetch_add(1); });
+        }
+        assert(1000 == done.load());
+    }
+
+    return 0;
+}
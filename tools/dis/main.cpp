@@ -0,0 +1,115 @@
+// disassembles a compiled script (SCM) into a text listing, no IDA involved
+# include <core/mapped_file.hpp>
+# include <core/thread_pool.hpp>
+# include <engine/command_manager.hpp>
+# include <engine/command_set.hpp>
+# include <engine/decoder.hpp>
+# include <engine/listing.hpp>
+# include <engine/version.hpp>
+# include <engine/gta3/decoder_gta3.hpp>
+# include <engine/gtalcs/decoder_gtalcs.hpp>
+# include <engine/gtavc/decoder_gtavc.hpp>
+# include <cstdio>
+# include <cstring>
+# include <memory>
+
+namespace idascm
+{
+    namespace
+    {
+        auto make_decoder(game game) -> std::unique_ptr<decoder>
+        {
+            switch (game)
+            {
+                case game::gta3:
+                    return std::unique_ptr<decoder>(new decoder_gta3);
+                case game::gtavc:
+                    return std::unique_ptr<decoder>(new decoder_gtavc);
+                case game::gtalcs:
+                    return std::unique_ptr<decoder>(new decoder_gtalcs);
+                default:
+                    return nullptr;
+            }
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    char const * output = nullptr;
+    char const * arguments[3] = {};
+    int count = 0;
+    for (int i = 1; i < argc; ++ i)
+    {
+        if (0 == std::strcmp(argv[i], "-o") && i + 1 < argc)
+            output = argv[++ i];
+        else if (count < 3)
+            arguments[count ++] = argv[i];
+        else
+            count = 4;
+    }
+    if (3 != count)
+    {
+        std::fprintf(stderr, "usage: idascm-dis [-o <listing>] <scm file> <version> <isa directory>\n");
+        std::fprintf(stderr, "  -o  write the listing to a file instead of stdout\n");
+        std::fprintf(stderr, "  IDASCM_THREADS sets the number of threads\n");
+        return 1;
+    }
+    auto const path = arguments[0];
+
+    auto const ver = to_version(arguments[1]);
+    auto const dec = make_decoder(version_game(ver));
+    if (! dec)
+    {
+        std::fprintf(stderr, "unsupported version '%s'\n", arguments[1]);
+        return 1;
+    }
+
+    command_manager manager(arguments[2]);
+    auto const isa = manager.get_set(ver);
+    if (! isa)
+    {
+        std::fprintf(stderr, "unable to load the commands of '%s' from '%s'\n", arguments[1], arguments[2]);
+        return 1;
+    }
+
+    mapped_file file;
+    if (! file.open(path))
+    {
+        std::fprintf(stderr, "unable to map '%s'\n", path);
+        return 1;
+    }
+    if (file.size() > 0xffffffff)
+    {
+        std::fprintf(stderr, "'%s' is larger than 4 GB\n", path);
+        return 1;
+    }
+
+    // decoders keep no state between calls, one is shared by every thread
+    memory_api_buffer memory(file.data(), file.size());
+    dec->set_command_set(isa);
+    dec->set_memory_api(&memory);
+
+    auto stream = stdout;
+    if (output && ! (stream = std::fopen(output, "wb")))
+    {
+        std::fprintf(stderr, "unable to create '%s'\n", output);
+        return 1;
+    }
+
+    auto & pool = thread_pool::instance();
+    listing text(*dec, *isa, file.data(), static_cast<std::uint32_t>(file.size()));
+    text.analyze(pool);
+    auto complete = text.write(pool, stream);
+    complete &= 0 == std::fflush(stream);
+    if (output)
+        complete &= 0 == std::fclose(stream);
+    if (! complete)
+    {
+        std::fprintf(stderr, "unable to write the listing\n");
+        return 1;
+    }
+    return 0;
+}
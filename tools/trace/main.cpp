@@ -0,0 +1,53 @@
+// renders binary log traces (logger::start_trace) as text
+# include <core/logger_trace.hpp>
+# include <cstdio>
+# include <cstring>
+# include <string>
+
+int main(int argc, char * argv[])
+{
+    using namespace idascm;
+
+    char const * path = nullptr;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++ i)
+    {
+        if (0 == std::strcmp(argv[i], "-v"))
+            verbose = true;
+        else
+            path = argv[i];
+    }
+    if (! path)
+    {
+        std::fprintf(stderr, "usage: idascm-trace [-v] <trace file>\n");
+        std::fprintf(stderr, "  -v  prefix lines with time (us), thread and subsystem\n");
+        return 1;
+    }
+
+    log_trace_file trace;
+    if (! trace.load(path))
+    {
+        std::fprintf(stderr, "unable to read trace '%s'\n", path);
+        return 1;
+    }
+
+    std::string text;
+    for (auto const & message : trace.messages())
+    {
+        text.clear();
+        if (verbose)
+        {
+            auto const site = trace.find_site(message.site);
+            char prefix[64];
+            std::snprintf(prefix, sizeof(prefix), "%12.3f %4u %-8s ", message.time / 1000., message.thread, site ? to_string(site->subsystem) : "?");
+            text += prefix;
+        }
+        if (! trace.render(message, text))
+        {
+            std::fprintf(stderr, "malformed message (site %u)\n", message.site);
+            continue;
+        }
+        std::fwrite(text.data(), 1, text.size(), stdout);
+    }
+    return 0;
+}